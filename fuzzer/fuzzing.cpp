@@ -24,6 +24,7 @@
 #include "doc/docundostack.hpp"
 #include "fakeit_standalone.hpp"
 #include "logger.hpp"
+#include <QElapsedTimer>
 #include <mlt++/MltFactory.h>
 #include <mlt++/MltProducer.h>
 #include <mlt++/MltProfile.h>
@@ -123,7 +124,7 @@ bool isIthParamARef(const rttr::method &method, size_t i)
 } // namespace
 } // namespace
 
-void fuzz(const std::string &input)
+void replay(const std::string &input, bool verbose, bool checkConsistency, ReplayTimings *timings)
 {
     Logger::init();
     Logger::clear();
@@ -257,21 +258,40 @@ void fuzz(const std::string &input)
         id = modulo(id, (int)all_tracks[timeline].size());
         return all_tracks[timeline][id];
     };
+    QElapsedTimer timer;
+    auto record = [&](const std::string &operation) {
+        if (timings) {
+            (*timings)[operation].push_back(timer.nsecsElapsed());
+        }
+    };
     std::string c;
 
     while (ss >> c) {
         if (c == "u") {
-            std::cout << "UNDOING" << std::endl;
+            if (verbose) {
+                std::cout << "UNDOING" << std::endl;
+            }
+            timer.start();
             undoStack->undo();
+            record("undo");
         } else if (c == "r") {
-            std::cout << "REDOING" << std::endl;
+            if (verbose) {
+                std::cout << "REDOING" << std::endl;
+            }
+            timer.start();
             undoStack->redo();
-        } else if (Logger::back_translation_table.count(c) > 0) {
+            record("redo");
+        } else if (Logger::back_translation_table.count(c) > 0 || Logger::translation_table.count(c) > 0) {
+            // Traces use either the short fuzzer tokens or the full operation names. Full names do not depend on the RTTR registration order
             // std::cout << "found=" << c;
-            c = Logger::back_translation_table[c];
+            if (Logger::translation_table.count(c) == 0) {
+                c = Logger::back_translation_table[c];
+            }
             // std::cout << " translated=" << c << std::endl;
             if (c == "constr_TimelineModel") {
+                timer.start();
                 all_timelines.emplace_back(TimelineItemModel::construct(&profile, guideModel, undoStack));
+                record(c);
             } else if (c == "constr_ClipModel") {
                 auto timeline = get_timeline();
                 int id = 0, state_id;
@@ -290,7 +310,9 @@ void fuzz(const std::string &input)
                 }
                 state = static_cast<PlaylistState::ClipState>(state_id);
                 if (timeline && valid) {
+                    timer.start();
                     ClipModel::construct(timeline, binClip, -1, state, speed);
+                    record(c);
                 }
             } else if (c == "constr_TrackModel") {
                 auto timeline = get_timeline();
@@ -304,7 +326,9 @@ void fuzz(const std::string &input)
                 if (pos < -1) pos = 0;
                 pos = std::min((int)all_tracks[timeline].size(), pos);
                 if (timeline) {
+                    timer.start();
                     TrackModel::construct(timeline, -1, pos, QString::fromStdString(name), audio);
+                    record(c);
                 }
             } else if (c == "constr_test_producer") {
                 std::string color;
@@ -466,7 +490,9 @@ void fuzz(const std::string &input)
                         }
                     }
                     if (valid) {
-                        std::cout << "VALID!!! " << target_method.get_name().to_string() << std::endl;
+                        if (verbose) {
+                            std::cout << "VALID!!! " << target_method.get_name().to_string() << std::endl;
+                        }
                         std::vector<rttr::argument> args;
                         args.reserve(arguments.size());
                         for (auto &a : arguments) {
@@ -476,19 +502,21 @@ void fuzz(const std::string &input)
                         for (const auto &p : target_method.get_parameter_infos()) {
                             // std::cout << "expected=" << p.get_type().get_name().to_string() << std::endl;
                         }
+                        timer.start();
                         rttr::variant res = target_method.invoke_variadic(ptr, args);
-                        if (res.is_valid()) {
-                            std::cout << "SUCCESS!!!" << std::endl;
-                        } else {
-                            std::cout << "!!!FAILLLLLL!!!" << std::endl;
+                        record(c);
+                        if (verbose) {
+                            std::cout << (res.is_valid() ? "SUCCESS!!!" : "!!!FAILLLLLL!!!") << std::endl;
                         }
                     }
                 }
             }
         }
         update_elems();
-        for (const auto &t : all_timelines) {
-            assert(t->checkConsistency());
+        if (checkConsistency) {
+            for (const auto &t : all_timelines) {
+                assert(t->checkConsistency());
+            }
         }
     }
     undoStack->clear();
@@ -501,6 +529,11 @@ void fuzz(const std::string &input)
     }
 
     pCore->m_projectManager = nullptr;
+}
+
+void fuzz(const std::string &input)
+{
+    replay(input, true, true, nullptr);
     Core::m_self.reset();
     MltConnection::m_self.reset();
     std::cout << "---------------------------------------------------------------------------------------------------------------------------------------------"
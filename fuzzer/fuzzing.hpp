@@ -21,6 +21,20 @@
 
 #pragma once
 
+#include <QtGlobal>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+/** @brief Duration of each replayed call in nanoseconds, by operation name */
+using ReplayTimings = std::unordered_map<std::string, std::vector<qint64>>;
 
 void fuzz(const std::string &input);
+
+/** @brief Replays a textual trace against fresh timeline models. Core must have been built before.
+    Operations can be given by their fuzzer token or by their full name (requestClipMove, constr_TrackModel, ...).
+    @param verbose print each executed operation
+    @param checkConsistency check the consistency of the timelines after each operation
+    @param timings if not null, receives the duration of each executed operation
+*/
+void replay(const std::string &input, bool verbose, bool checkConsistency, ReplayTimings *timings = nullptr);
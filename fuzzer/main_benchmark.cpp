@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/* Replays timeline operation traces headless and reports the latency of each operation.
+ * Traces are the textual traces used by the fuzzer, they can be recorded with a CRASH_AUTO_TEST build (Logger::print_trace) or generated.
+ * Examples:
+ *   timeline_benchmark fuzzer/traces/big_moves.trace fuzzer/traces/ripple_trims.trace
+ *   timeline_benchmark --generate 20000 --kind groups --iterations 3
+ */
+
+#include "core.h"
+#include "fuzzing.hpp"
+#include "tracegenerator.hpp"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace {
+/** @brief Upper bounds (in microseconds) of the latency histogram buckets */
+const std::vector<qint64> histogramBuckets = {10, 100, 1000, 10000, 100000};
+
+void printReport(const QString &name, const ReplayTimings &timings, qint64 totalTime, int iterations)
+{
+    std::cout << std::endl << "=== " << name.toStdString() << " (" << iterations << (iterations > 1 ? " runs" : " run") << ", " << totalTime << "ms)" << std::endl;
+    std::cout << std::left << std::setw(26) << "operation" << std::right << std::setw(8) << "count" << std::setw(11) << "total ms" << std::setw(10) << "mean us"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p90 us" << std::setw(10) << "p99 us" << std::setw(10) << "max us"
+              << "   <10us <100us <1ms <10ms <100ms >100ms" << std::endl;
+    // Sort operations by name to get stable reports
+    std::map<std::string, std::vector<qint64>> sorted(timings.begin(), timings.end());
+    for (auto &operation : sorted) {
+        std::vector<qint64> &durations = operation.second;
+        std::sort(durations.begin(), durations.end());
+        qint64 total = 0;
+        std::vector<int> histogram(histogramBuckets.size() + 1, 0);
+        for (qint64 duration : durations) {
+            total += duration;
+            qint64 micro = duration / 1000;
+            size_t bucket = 0;
+            while (bucket < histogramBuckets.size() && micro >= histogramBuckets[bucket]) {
+                ++bucket;
+            }
+            histogram[bucket]++;
+        }
+        auto percentile = [&durations](double p) { return durations[std::min(durations.size() - 1, size_t(p * double(durations.size())))] / 1000; };
+        std::cout << std::left << std::setw(26) << operation.first << std::right << std::setw(8) << durations.size() << std::setw(11) << std::fixed
+                  << std::setprecision(1) << double(total) / 1000000. << std::setw(10) << total / qint64(durations.size()) / 1000 << std::setw(10)
+                  << percentile(0.5) << std::setw(10) << percentile(0.9) << std::setw(10) << percentile(0.99) << std::setw(10) << durations.back() / 1000
+                  << "  ";
+        for (int count : histogram) {
+            std::cout << " " << std::setw(6) << count;
+        }
+        std::cout << std::endl;
+    }
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Replays timeline operation traces and reports the latency of each operation"));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("traces"), QStringLiteral("Trace files to replay"), QStringLiteral("[traces...]"));
+    QCommandLineOption generateOption(QStringLiteral("generate"), QStringLiteral("Replay a generated trace of about <operations> operations"),
+                                      QStringLiteral("operations"));
+    QCommandLineOption kindOption(QStringLiteral("kind"), QStringLiteral("Kind of generated trace: moves, trims or groups"), QStringLiteral("kind"),
+                                  QStringLiteral("moves"));
+    QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed of the generated trace"), QStringLiteral("seed"), QStringLiteral("1"));
+    QCommandLineOption saveOption(QStringLiteral("save"), QStringLiteral("Save the generated trace to <file>"), QStringLiteral("file"));
+    QCommandLineOption iterationsOption(QStringLiteral("iterations"), QStringLiteral("Replay each trace <count> times"), QStringLiteral("count"),
+                                        QStringLiteral("1"));
+    QCommandLineOption checkOption(QStringLiteral("check"), QStringLiteral("Check the timeline consistency after each operation (slow)"));
+    parser.addOptions({generateOption, kindOption, seedOption, saveOption, iterationsOption, checkOption});
+    parser.process(app);
+
+    std::vector<std::pair<QString, std::string>> traces;
+    if (parser.isSet(generateOption)) {
+        const QString kindName = parser.value(kindOption);
+        TraceKind kind = TraceKind::BigMoves;
+        if (kindName == QLatin1String("trims")) {
+            kind = TraceKind::RippleTrims;
+        } else if (kindName == QLatin1String("groups")) {
+            kind = TraceKind::GroupOperations;
+        } else if (kindName != QLatin1String("moves")) {
+            std::cerr << "Unknown trace kind " << kindName.toStdString() << std::endl;
+            return 1;
+        }
+        std::string trace = generateTrace(kind, parser.value(generateOption).toInt(), parser.value(seedOption).toUInt());
+        if (parser.isSet(saveOption)) {
+            QFile file(parser.value(saveOption));
+            if (!file.open(QIODevice::WriteOnly)) {
+                std::cerr << "Cannot write " << file.fileName().toStdString() << std::endl;
+                return 1;
+            }
+            file.write(trace.c_str(), qint64(trace.size()));
+        }
+        traces.emplace_back(QStringLiteral("generated %1 (%2 operations)").arg(kindName, parser.value(generateOption)), trace);
+    }
+    for (const QString &path : parser.positionalArguments()) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            std::cerr << "Cannot read " << path.toStdString() << std::endl;
+            return 1;
+        }
+        traces.emplace_back(path, file.readAll().toStdString());
+    }
+    if (traces.empty()) {
+        parser.showHelp(1);
+    }
+
+    qputenv("MLT_TESTS", QByteArray("1"));
+    Core::build(false);
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    QElapsedTimer timer;
+    for (const auto &trace : traces) {
+        ReplayTimings timings;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            replay(trace.second, false, parser.isSet(checkOption), &timings);
+        }
+        printReport(trace.first, timings, timer.elapsed(), iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,201 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "tracegenerator.hpp"
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace {
+/* Clips and tracks are only created at the beginning of a trace, and never deleted. Their index in creation order is then stable, and the replay resolves
+ * a negative index i to the element (i + count) of the ordered list. Negative numbers can never be mistaken for a valid item id. */
+int ref(int index, int count)
+{
+    return index - count;
+}
+
+void createTimeline(std::stringstream &ss, int tracks, const std::string &color, int length, int clips)
+{
+    ss << "constr_TimelineModel" << std::endl;
+    ss << "constr_test_producer " << color << " " << length << " 0" << std::endl;
+    for (int i = 0; i < tracks; ++i) {
+        ss << "constr_TrackModel 0 -1 -1 $$ 0" << std::endl;
+    }
+    for (int i = 0; i < clips; ++i) {
+        // An unknown bin id selects the first bin clip
+        ss << "constr_ClipModel 0 x -1 1 1" << std::endl;
+    }
+}
+
+void moveClip(std::stringstream &ss, int clip, int clips, int track, int tracks, int position)
+{
+    // timeline, clipId, trackId, position, moveMirrorTracks, updateView, logUndo, invalidateTimeline, revertMove
+    ss << "requestClipMove 0 " << ref(clip, clips) << " " << ref(track, tracks) << " " << position << " 0 0 1 0 0" << std::endl;
+}
+
+void undoRedo(std::stringstream &ss)
+{
+    ss << "u" << std::endl << "r" << std::endl;
+}
+
+std::string bigMoves(int operations, std::mt19937 &gen)
+{
+    const int tracks = 4;
+    const int length = 100;
+    const int clips = operations / 10 + 10;
+    std::stringstream ss;
+    createTimeline(ss, tracks, "red", length, clips);
+    std::vector<int> trackEnd(tracks, 0);
+    for (int i = 0; i < clips; ++i) {
+        int track = i % tracks;
+        moveClip(ss, i, clips, track, tracks, trackEnd[size_t(track)]);
+        trackEnd[size_t(track)] += length;
+    }
+    std::uniform_int_distribution<int> clipDist(0, clips - 1);
+    std::uniform_int_distribution<int> trackDist(0, tracks - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (int done = 0; done < operations;) {
+        if (percent(gen) < 10) {
+            undoRedo(ss);
+            done += 2;
+            continue;
+        }
+        // Moving a clip after the end of a track is always possible, and leaves a gap behind
+        int track = trackDist(gen);
+        moveClip(ss, clipDist(gen), clips, track, tracks, trackEnd[size_t(track)]);
+        trackEnd[size_t(track)] += length;
+        done++;
+    }
+    return ss.str();
+}
+
+std::string rippleTrims(int operations, std::mt19937 &gen)
+{
+    const int tracks = 2;
+    const int length = 200;
+    const int minLength = 20;
+    const int clips = operations / 4 + 10;
+    std::stringstream ss;
+    createTimeline(ss, tracks, "green", length, clips);
+    // Clips are placed back to back, we keep the ordered clip indexes of each track and the clip lengths
+    std::vector<std::vector<int>> trackClips(tracks);
+    std::vector<int> lengths(size_t(clips), length);
+    for (int i = 0; i < clips; ++i) {
+        int track = i % tracks;
+        moveClip(ss, i, clips, track, tracks, int(trackClips[size_t(track)].size()) * length);
+        trackClips[size_t(track)].push_back(i);
+    }
+    std::uniform_int_distribution<int> clipDist(0, clips - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (int done = 0; done < operations;) {
+        int clip = clipDist(gen);
+        if (percent(gen) < 10 || lengths[size_t(clip)] < minLength + 2) {
+            undoRedo(ss);
+            done += 2;
+            continue;
+        }
+        int track = clip % tracks;
+        int position = 0;
+        for (int c : trackClips[size_t(track)]) {
+            if (c == clip) {
+                break;
+            }
+            position += lengths[size_t(c)];
+        }
+        std::uniform_int_distribution<int> trimDist(2, std::min(lengths[size_t(clip)] - minLength, 40));
+        int trim = trimDist(gen);
+        int newLength = lengths[size_t(clip)] - trim;
+        bool right = percent(gen) < 50;
+        // timeline, itemId, size, right, logUndo, snapDistance, allowSingleResize
+        ss << "requestItemResize 0 " << ref(clip, clips) << " " << newLength << " " << (right ? 1 : 0) << " 1 -1 1" << std::endl;
+        // The blank must be deleted from a position inside it
+        int blankStart = right ? position + newLength : position;
+        ss << "requestDeleteBlankAt 0 " << ref(track, tracks) << " " << blankStart + 1 << " 0" << std::endl;
+        lengths[size_t(clip)] = newLength;
+        done += 2;
+    }
+    return ss.str();
+}
+
+std::string groupOperations(int operations, std::mt19937 &gen)
+{
+    const int tracks = 3;
+    const int length = 100;
+    const int spacing = 200;
+    const int delta = 50;
+    const int clips = operations / 10 + 30;
+    std::stringstream ss;
+    createTimeline(ss, tracks, "blue", length, clips);
+    // Clips are separated by blanks longer than the group moves, so that groups can always be moved back and forth
+    for (int i = 0; i < clips; ++i) {
+        moveClip(ss, i, clips, i % tracks, tracks, (i / tracks) * spacing);
+    }
+    std::vector<int> all;
+    all.reserve(size_t(clips));
+    for (int i = 0; i < clips; ++i) {
+        all.push_back(i);
+    }
+    std::uniform_int_distribution<int> sizeDist(2, 20);
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (int done = 0; done < operations;) {
+        std::vector<int> items = all;
+        std::shuffle(items.begin(), items.end(), gen);
+        // Sometimes group the whole timeline
+        if (percent(gen) >= 5) {
+            items.resize(size_t(sizeDist(gen)));
+        }
+        // timeline, itemIds (count, then ids), logUndo, type
+        ss << "requestClipsGroup 0 " << items.size();
+        for (int item : items) {
+            ss << " " << ref(item, clips);
+        }
+        ss << " 1 0" << std::endl;
+        // The newest group is the last one
+        // timeline, itemId, groupId, delta_track, delta_pos, moveMirrorTracks, updateView, logUndo, revertMove
+        int item = ref(items.front(), clips);
+        ss << "requestGroupMove 0 " << item << " -1 0 " << delta << " 0 0 1 0" << std::endl;
+        if (percent(gen) < 30) {
+            undoRedo(ss);
+            done += 2;
+        }
+        ss << "requestGroupMove 0 " << item << " -1 0 " << -delta << " 0 0 1 0" << std::endl;
+        // timeline, itemId, logUndo
+        ss << "requestClipUngroup 0 " << item << " 1" << std::endl;
+        done += 4;
+    }
+    return ss.str();
+}
+} // namespace
+
+std::string generateTrace(TraceKind kind, int operations, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    switch (kind) {
+    case TraceKind::RippleTrims:
+        return rippleTrims(operations, gen);
+    case TraceKind::GroupOperations:
+        return groupOperations(operations, gen);
+    case TraceKind::BigMoves:
+    default:
+        return bigMoves(operations, gen);
+    }
+}
@@ -0,0 +1,34 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include <string>
+
+/** @brief Kind of timeline activity simulated by a generated trace */
+enum class TraceKind { BigMoves, RippleTrims, GroupOperations };
+
+/** @brief Generates a replayable trace (see replay() in fuzzing.hpp) of about @param operations timeline operations.
+    The generator keeps track of the timeline layout so that the operations are valid and the replay exercises the real code paths.
+    Items and tracks are referenced by negative indices, which the replay maps to the n-th clip / track by creation order.
+    The same seed always produces the same trace.
+*/
+std::string generateTrace(TraceKind kind, int operations, unsigned seed);
@@ -23,6 +23,7 @@
 #include <QApplication>
 #include <QDir>
 #include <QDomDocument>
+#include <QTextStream>
 
 int main(int argc, char **argv)
 {
@@ -55,11 +56,31 @@ int main(int argc, char **argv)
             out = args.at(0).toInt();
             args.removeFirst();
         }
+        // First frame of each video segment after the first one, for a segmented render
+        QList<int> segmentStarts;
+        if (args.count() > 0 && args.at(0).startsWith(QLatin1String("-segments:"))) {
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+            const QStringList starts = args.at(0).section(QLatin1Char(':'), 1).split(QLatin1Char(','), QString::SkipEmptyParts);
+#else
+            const QStringList starts = args.at(0).section(QLatin1Char(':'), 1).split(QLatin1Char(','), Qt::SkipEmptyParts);
+#endif
+            for (const QString &frame : starts) {
+                segmentStarts << frame.toInt();
+            }
+            args.removeFirst();
+        }
+        // FFmpeg path, used to join the segments
+        QString ffmpegPath;
+        if (args.count() > 0 && args.at(0).startsWith(QLatin1String("-ffmpeg:"))) {
+            ffmpegPath = args.at(0).section(QLatin1Char(':'), 1);
+            args.removeFirst();
+        }
 
         // Do we want a split render
         if (args.count() > 0 && args.at(0) == QLatin1String("-split")) {
             args.removeFirst();
-            // chunks to render
+            // chunks to render, "-" to read them from stdin until it is closed, one per line optionally followed by the output file base name
+            bool readChunks = args.at(0) == QLatin1String("-");
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
             QStringList chunks = args.at(0).split(QLatin1Char(','), QString::SkipEmptyParts);
 #else
@@ -98,9 +119,27 @@ int main(int argc, char **argv)
             }
             const char *localename = prod.get_lcnumeric();
             QLocale::setDefault(QLocale(localename));
-            for (const QString &frame : qAsConst(chunks)) {
+            QTextStream input(stdin);
+            while (true) {
+                QString frame;
+                QString baseName;
+                if (readChunks) {
+                    const QString line = input.readLine().simplified();
+                    if (line.isEmpty()) {
+                        break;
+                    }
+                    frame = line.section(QLatin1Char(' '), 0, 0);
+                    baseName = line.section(QLatin1Char(' '), 1, 1);
+                } else if (chunks.isEmpty()) {
+                    break;
+                } else {
+                    frame = chunks.takeFirst();
+                }
+                if (baseName.isEmpty()) {
+                    baseName = frame;
+                }
                 fprintf(stderr, "START:%d \n", frame.toInt());
-                QString fileName = QStringLiteral("%1.%2").arg(frame,extension);
+                QString fileName = QStringLiteral("%1.%2").arg(baseName, extension);
                 if (baseFolder.exists(fileName)) {
                     // Don't overwrite an existing file
                     fprintf(stderr, "DONE:%d \n", frame.toInt());
@@ -147,6 +186,9 @@ int main(int argc, char **argv)
             }
         }
         auto *rJob = new RenderJob(render, playlist, target, pid, in, out, qApp);
+        if (!segmentStarts.isEmpty() && !ffmpegPath.isEmpty()) {
+            rJob->setSegments(segmentStarts, ffmpegPath);
+        }
         rJob->start();
         QObject::connect(rJob, &RenderJob::renderingFinished, rJob, [&, rJob]() {
             rJob->deleteLater();
@@ -19,6 +19,7 @@
 
 #include "renderjob.h"
 
+#include <QDomDocument>
 #include <QFile>
 #include <QStringList>
 #include <QThread>
@@ -51,6 +52,8 @@ RenderJob::RenderJob(const QString &render, const QString &scenelist, const QStr
     , m_frameout(out)
     , m_pid(pid)
     , m_dualpass(false)
+    , m_runningSegments(0)
+    , m_segmentTotal(0)
 {
     m_renderProcess = new QProcess;
     m_renderProcess->setReadChannel(QProcess::StandardError);
@@ -92,7 +95,9 @@ void RenderJob::slotAbort(const QString &url)
 void RenderJob::slotAbort()
 {
     qWarning() << "Job aborted by user...";
+    stopSegments();
     m_renderProcess->kill();
+    cleanupSegments();
 
     if (m_kdenliveinterface) {
         m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), {m_dest, -3, QString()});
@@ -122,40 +127,45 @@ void RenderJob::receivedStderr()
         if (progress <= m_progress || progress <= 0 || progress > 100) {
             return;
         }
-        m_progress = progress;
-        if (m_args.contains(QStringLiteral("pass=1"))) {
-            m_progress /= 2;
-        } else if (m_args.contains(QStringLiteral("pass=2"))) {
-            m_progress = 50 + m_progress / 2;
-        }
-        if ((m_kdenliveinterface != nullptr) && m_kdenliveinterface->isValid()) {
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), {m_dest, m_progress, frame});
-        }
-        qint64 elapsedTime = m_startTime.secsTo(QDateTime::currentDateTime());
-        if (elapsedTime == m_seconds) {
-            return;
-        }
-        int speed = (frame - m_frame) / (elapsedTime - m_seconds);
-        if (m_jobUiserver) {
-            qint64 remaining = elapsedTime * (100 - progress) / progress;
-            int days = int(remaining / 86400);
-            int remainingSecs = int(remaining % 86400);
-            QTime when = QTime(0, 0, 0, 0).addSecs(remainingSecs);
-            QString est = tr("Remaining time ");
-            if (days > 0) {
-                est.append(tr("%n day(s) ", "", days));
-            }
-            est.append(when.toString(QStringLiteral("hh:mm:ss")));
+        updateProgress(progress, frame);
+    }
+}
 
-            m_jobUiserver->call(QStringLiteral("setPercent"), uint(m_progress));
-            m_jobUiserver->call(QStringLiteral("setDescriptionField"), 0, QString(), est);
-            m_jobUiserver->call(QStringLiteral("setProcessedAmount"), qulonglong(frame - m_framein), tr("frames"));
-            m_jobUiserver->call(QStringLiteral("setSpeed"), qulonglong(speed));
+void RenderJob::updateProgress(int progress, int frame)
+{
+    m_progress = progress;
+    if (m_args.contains(QStringLiteral("pass=1"))) {
+        m_progress /= 2;
+    } else if (m_args.contains(QStringLiteral("pass=2"))) {
+        m_progress = 50 + m_progress / 2;
+    }
+    if ((m_kdenliveinterface != nullptr) && m_kdenliveinterface->isValid()) {
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), {m_dest, m_progress, frame});
+    }
+    qint64 elapsedTime = m_startTime.secsTo(QDateTime::currentDateTime());
+    if (elapsedTime == m_seconds) {
+        return;
+    }
+    int speed = (frame - m_frame) / (elapsedTime - m_seconds);
+    if (m_jobUiserver) {
+        qint64 remaining = elapsedTime * (100 - progress) / progress;
+        int days = int(remaining / 86400);
+        int remainingSecs = int(remaining % 86400);
+        QTime when = QTime(0, 0, 0, 0).addSecs(remainingSecs);
+        QString est = tr("Remaining time ");
+        if (days > 0) {
+            est.append(tr("%n day(s) ", "", days));
         }
-        m_seconds = int(elapsedTime);
-        m_frame = frame;
-        m_logstream << QStringLiteral("%1\t%2\t%3\t%4\n").arg(m_seconds).arg(m_frame).arg(m_progress).arg(speed);
+        est.append(when.toString(QStringLiteral("hh:mm:ss")));
+
+        m_jobUiserver->call(QStringLiteral("setPercent"), uint(m_progress));
+        m_jobUiserver->call(QStringLiteral("setDescriptionField"), 0, QString(), est);
+        m_jobUiserver->call(QStringLiteral("setProcessedAmount"), qulonglong(frame - m_framein), tr("frames"));
+        m_jobUiserver->call(QStringLiteral("setSpeed"), qulonglong(speed));
     }
+    m_seconds = int(elapsedTime);
+    m_frame = frame;
+    m_logstream << QStringLiteral("%1\t%2\t%3\t%4\n").arg(m_seconds).arg(m_frame).arg(m_progress).arg(speed);
 }
 
 void RenderJob::start()
@@ -210,11 +220,216 @@ void RenderJob::start()
 
     // Because of the logging, we connect to stderr in all cases.
     connect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
+    if (!m_segmentStarts.isEmpty() && startSegments()) {
+        return;
+    }
     m_renderProcess->start(m_prog, m_args);
     m_logstream << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' ')) << "\n";
     m_logstream.flush();
 }
 
+void RenderJob::setSegments(const QList<int> &starts, const QString &ffmpegPath)
+{
+    m_segmentStarts = starts;
+    m_ffmpegPath = ffmpegPath;
+}
+
+bool RenderJob::startSegments()
+{
+    // The playlist may be wrapped for the multi consumer, keep the wrapping for the segment playlists
+    QString playlist = m_scenelist;
+    QString prefix;
+    QString suffix;
+    if (playlist.startsWith(QLatin1String("xml:"))) {
+        prefix = QStringLiteral("xml:");
+        playlist.remove(0, prefix.length());
+    }
+    if (playlist.endsWith(QLatin1String("?multi=1"))) {
+        suffix = QStringLiteral("?multi=1");
+        playlist.chop(suffix.length());
+    }
+    QFile file(playlist);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file, false)) {
+        return false;
+    }
+    file.close();
+    QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    if (consumer.isNull()) {
+        return false;
+    }
+    const int in = consumer.attribute(QStringLiteral("in")).toInt();
+    const int out = m_frameout > -1 ? m_frameout : consumer.attribute(QStringLiteral("out")).toInt();
+    QList<int> starts = {in};
+    for (int frame : qAsConst(m_segmentStarts)) {
+        if (frame > starts.last() && frame <= out) {
+            starts << frame;
+        }
+    }
+    if (starts.size() < 2) {
+        return false;
+    }
+    QFileInfo playlistInfo(playlist);
+    QFileInfo destInfo(m_dest);
+    const QString playlistTemplate = QStringLiteral("%1/%2-part%3.mlt").arg(playlistInfo.absolutePath(), playlistInfo.completeBaseName());
+    const QString partTemplate = QStringLiteral("%1/%2-part%3.%4").arg(destInfo.absolutePath(), destInfo.completeBaseName());
+    const bool hasAudio = consumer.attribute(QStringLiteral("an")) != QLatin1String("1");
+
+    auto startProcess = [&](const QString &name, int start, int end, int segment) {
+        // Write the playlist for this part
+        const QString partPlaylist = playlistTemplate.arg(name);
+        QFile partFile(partPlaylist);
+        if (!partFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            return false;
+        }
+        partFile.write(doc.toString().toUtf8());
+        partFile.close();
+        m_segmentFiles << partPlaylist;
+
+        auto *process = new QProcess(this);
+        process->setReadChannel(QProcess::StandardError);
+        connect(process, &QProcess::readyReadStandardError, this, [this, process, start, end, segment]() {
+            const QString result = QString::fromLocal8Bit(process->readAllStandardError()).simplified();
+            if (!result.startsWith(QLatin1String("Current Frame"))) {
+                m_errorMessage.append(result + QStringLiteral("<br>"));
+                m_logstream << result;
+                return;
+            }
+            if (segment < 0) {
+                // The audio pass is much faster than the video segments, only follow these
+                return;
+            }
+            const int frame = result.section(QLatin1String("Current Frame:"), -1).section(QLatin1Char(','), 0, 0).simplified().toInt();
+            m_segmentFrames[segment] = qBound(0, frame - start, end - start + 1);
+            int done = 0;
+            for (int frames : qAsConst(m_segmentFrames)) {
+                done += frames;
+            }
+            // Keep the last percent for the final join
+            const int progress = qMin(99, int(100 * qint64(done) / m_segmentTotal));
+            if (progress > m_progress) {
+                updateProgress(progress, m_framein + done);
+            }
+        });
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this](int exitCode, QProcess::ExitStatus status) {
+            if (status != QProcess::NormalExit || exitCode != 0) {
+                // One part failed, the joined file would be unusable
+                stopSegments();
+                slotIsOver(QProcess::CrashExit);
+                return;
+            }
+            if (--m_runningSegments == 0) {
+                joinSegments();
+            }
+        });
+        m_segmentProcesses << process;
+        const QStringList args = {QStringLiteral("-progress"), prefix + partPlaylist + suffix, QStringLiteral("in=") + QString::number(start),
+                                  QStringLiteral("out=") + QString::number(end)};
+        process->start(m_prog, args);
+        if (!process->waitForStarted()) {
+            return false;
+        }
+        m_runningSegments++;
+        m_logstream << "Started render process: " << m_prog << ' ' << args.join(QLatin1Char(' ')) << "\n";
+        return true;
+    };
+
+    m_framein = in;
+    m_frame = in;
+    m_segmentFrames = QVector<int>(starts.size(), 0);
+    m_segmentTotal = out - in + 1;
+    bool success = true;
+    // Video segments, each one is encoded from its own keyframe
+    consumer.setAttribute(QStringLiteral("an"), 1);
+    for (int i = 0; i < starts.size() && success; ++i) {
+        const int start = starts.at(i);
+        const int end = i + 1 < starts.size() ? starts.at(i + 1) - 1 : out;
+        const QString part = partTemplate.arg(i).arg(destInfo.suffix());
+        consumer.setAttribute(QStringLiteral("in"), start);
+        consumer.setAttribute(QStringLiteral("out"), end);
+        consumer.setAttribute(QStringLiteral("target"), part);
+        m_videoParts << part;
+        m_segmentFiles << part;
+        success = startProcess(QString::number(i), start, end, i);
+    }
+    // Audio is rendered in one continuous pass to avoid seams between segments
+    if (hasAudio && success) {
+        m_audioPart = partTemplate.arg(QStringLiteral("audio")).arg(destInfo.suffix());
+        consumer.removeAttribute(QStringLiteral("an"));
+        consumer.setAttribute(QStringLiteral("vn"), 1);
+        consumer.setAttribute(QStringLiteral("in"), in);
+        consumer.setAttribute(QStringLiteral("out"), out);
+        consumer.setAttribute(QStringLiteral("target"), m_audioPart);
+        m_segmentFiles << m_audioPart;
+        success = startProcess(QStringLiteral("audio"), in, out, -1);
+    }
+    m_logstream.flush();
+    if (!success) {
+        qWarning() << "Cannot start segmented render, rendering in a single pass";
+        stopSegments();
+        cleanupSegments();
+        m_videoParts.clear();
+        m_audioPart.clear();
+        m_framein = m_frame = -1;
+        return false;
+    }
+    return true;
+}
+
+void RenderJob::joinSegments()
+{
+    // Losslessly join the video segments with the concat demuxer and add the audio pass
+    QFileInfo destInfo(m_dest);
+    const QString listFile = QStringLiteral("%1/%2-parts.txt").arg(destInfo.absolutePath(), destInfo.completeBaseName());
+    QFile list(listFile);
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        m_errorMessage.append(tr("Cannot write to %1, check permissions.").arg(listFile));
+        slotIsOver(QProcess::CrashExit);
+        return;
+    }
+    m_segmentFiles << listFile;
+    QTextStream out(&list);
+    for (QString part : qAsConst(m_videoParts)) {
+        out << QStringLiteral("file '%1'\n").arg(part.replace(QLatin1Char('\''), QStringLiteral("'\\''")));
+    }
+    out.flush();
+    list.close();
+    QStringList args = {QStringLiteral("-hide_banner"), QStringLiteral("-y"),  QStringLiteral("-v"),    QStringLiteral("error"),
+                        QStringLiteral("-f"),           QStringLiteral("concat"), QStringLiteral("-safe"), QStringLiteral("0"),
+                        QStringLiteral("-i"),           listFile};
+    if (!m_audioPart.isEmpty()) {
+        args << QStringLiteral("-i") << m_audioPart << QStringLiteral("-map") << QStringLiteral("0") << QStringLiteral("-map") << QStringLiteral("1");
+    }
+    args << QStringLiteral("-c") << QStringLiteral("copy") << m_dest;
+    // The join process reports through the usual render process signals
+    m_renderProcess->start(m_ffmpegPath, args);
+    m_logstream << "Started join process: " << m_ffmpegPath << ' ' << args.join(QLatin1Char(' ')) << "\n";
+    m_logstream.flush();
+}
+
+void RenderJob::stopSegments()
+{
+    for (QProcess *process : qAsConst(m_segmentProcesses)) {
+        disconnect(process, nullptr, this, nullptr);
+        if (process->state() != QProcess::NotRunning) {
+            process->kill();
+            process->waitForFinished();
+        }
+        // We may be called from one of the process signals
+        process->deleteLater();
+    }
+    m_segmentProcesses.clear();
+    m_runningSegments = 0;
+}
+
+void RenderJob::cleanupSegments()
+{
+    for (const QString &path : qAsConst(m_segmentFiles)) {
+        QFile::remove(path);
+    }
+    m_segmentFiles.clear();
+}
+
 void RenderJob::initKdenliveDbusInterface()
 {
     QString kdenliveId;
@@ -255,6 +470,7 @@ void RenderJob::slotCheckProcess(QProcess::ProcessState state)
 
 void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
 {
+    cleanupSegments();
     if (m_jobUiserver) {
         m_jobUiserver->call(QStringLiteral("setDescriptionField"), 1, tr("Rendered file"), m_dest);
         m_jobUiserver->call(QStringLiteral("terminate"), QString());
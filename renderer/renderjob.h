@@ -25,6 +25,7 @@
 #include <QProcess>
 #include <QDateTime>
 #include <QFile>
+#include <QVector>
 // Testing
 #include <QTextStream>
 
@@ -36,6 +37,10 @@ public:
     RenderJob(const QString &render, const QString &scenelist, const QString &target, int pid = -1, int in = -1, int out = -1, QObject *parent = nullptr);
     ~RenderJob() override;
 
+    /** @brief Render the video in parallel segments, each one starting at a frame of @param starts after the first segment.
+     *  Audio is rendered in a separate continuous pass and everything is joined with @param ffmpegPath without re-encoding. */
+    void setSegments(const QList<int> &starts, const QString &ffmpegPath);
+
 public slots:
     void start();
 
@@ -72,7 +77,26 @@ private:
     QStringList m_args;
     /** @brief Used to write to the log file. */
     QTextStream m_logstream;
+    /** @brief First frame of each video segment after the first one, empty for a single pass render. */
+    QList<int> m_segmentStarts;
+    QString m_ffmpegPath;
+    /** @brief The processes rendering the video segments and the audio pass. */
+    QList<QProcess *> m_segmentProcesses;
+    int m_runningSegments;
+    /** @brief Frames already rendered in each video segment, used to merge progress. */
+    QVector<int> m_segmentFrames;
+    int m_segmentTotal;
+    QStringList m_videoParts;
+    QString m_audioPart;
+    /** @brief Intermediate playlists and files removed once the render is over. */
+    QStringList m_segmentFiles;
     void initKdenliveDbusInterface();
+    void updateProgress(int progress, int frame);
+    /** @brief Start the segment and audio processes, returns false if the render has to be done in a single pass. */
+    bool startSegments();
+    void joinSegments();
+    void stopSegments();
+    void cleanupSegments();
 
 signals:
     void renderingFinished();
@@ -23,6 +23,8 @@
 #define ASSETSREPOSITORY_H
 
 #include "definitions.h"
+#include <QDomDocument>
+#include <QHash>
 #include <QSet>
 #include <memory>
 #include <mlt++/Mlt.h>
@@ -76,7 +78,19 @@ protected:
     // Reads the asset list from file and populates appropriate structure
     void parseAssetList(const QString &filePath, QSet<QString> &destination);
 
+    /** @brief Fill the asset list, from the catalog cache when MLT and the custom assets did not change since it was written */
     void init();
+
+    /** @brief Version of the catalog cache format, to be increased when Info or the parsing changes */
+    static const int catalogVersion = 1;
+    /** @brief Returns a key identifying the MLT version, services, language and custom asset files the catalog was built from */
+    QString catalogKey(Mlt::Properties *assets, const QSet<QString> &mltServices, const QStringList &assetDirs) const;
+    QString catalogPath() const;
+    /** @brief Replace the asset list with the cached catalog if it was built with @param key */
+    bool loadCatalog(const QString &key);
+    bool saveCatalog(const QString &key) const;
+    /** @brief Returns the content of a custom asset file, already parsed if it was read in parallel during init */
+    QDomDocument readAssetFile(const QString &path) const;
     virtual Mlt::Properties *retrieveListFromMlt() const = 0;
 
     /** @brief Parse some info from a mlt structure
@@ -111,11 +125,17 @@ protected:
     /** @brief Returns the path to the assets' preferred list*/
     virtual QString assetPreferredListPath() const = 0;
 
+    /** @brief Returns the name of the on-disk catalog cache for these assets*/
+    virtual QString assetCatalogName() const = 0;
+
     std::unordered_map<QString, Info> m_assets;
 
     QSet<QString> m_blacklist;
 
     QSet<QString> m_preferred_list;
+
+    /** @brief Custom asset files read in parallel during init, by path */
+    QHash<QString, QDomDocument> m_parsedFiles;
 };
 
 #include "abstractassetsrepository.ipp"
@@ -21,13 +21,21 @@
 
 #include "xml/xml.hpp"
 #include "kdenlivesettings.h"
+#include "kdenlive_load_debug.h"
 #include "core.h"
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
 #include <QStandardPaths>
 #include <QString>
 #include <QTextStream>
+#include <QtConcurrent>
 #include <KLocalizedString>
 
 #include <locale>
@@ -39,6 +47,8 @@ template <typename AssetType> AbstractAssetsRepository<AssetType>::AbstractAsset
 
 template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
 {
+    QElapsedTimer timer;
+    timer.start();
     // Parse blacklist
     parseAssetList(assetBlackListPath(), m_blacklist);
 
@@ -47,6 +57,26 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
 
     // Retrieve the list of MLT's available assets.
     QScopedPointer<Mlt::Properties> assets(retrieveListFromMlt());
+    // Names of all MLT filters and transitions, used to check the dependencies of custom assets
+    QSet<QString> mltServices;
+    QScopedPointer<Mlt::Properties> filters(pCore->getMltRepository()->filters());
+    QScopedPointer<Mlt::Properties> transitions(pCore->getMltRepository()->transitions());
+    for (int i = 0; i < filters->count(); ++i) {
+        mltServices.insert(filters->get_name(i));
+    }
+    for (int i = 0; i < transitions->count(); ++i) {
+        mltServices.insert(transitions->get_name(i));
+    }
+
+    // Set the directories to look into for effects.
+    QStringList asset_dirs = assetDirs();
+    const QString cacheKey = catalogKey(assets.data(), mltServices, asset_dirs);
+    qCDebug(KDENLIVE_LOAD_LOG) << "Assets" << assetCatalogName() << "service lists:" << timer.restart() << "ms";
+    if (loadCatalog(cacheKey)) {
+        qCDebug(KDENLIVE_LOAD_LOG) << "Assets" << assetCatalogName() << "catalog cache loaded:" << timer.restart() << "ms";
+        return;
+    }
+
     QStringList emptyMetaAssets;
     int max = assets->count();
     QString sox = QStringLiteral("sox.");
@@ -70,12 +100,10 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
             }
         }
     }
+    qCDebug(KDENLIVE_LOAD_LOG) << "Assets" << assetCatalogName() << "MLT metadata:" << timer.restart() << "ms";
 
     // We now parse custom effect xml
 
-    // Set the directories to look into for effects.
-    QStringList asset_dirs = assetDirs();
-
     /* Parsing of custom xml works as follows: we parse all custom files.
        Each of them contains a tag, which is the corresponding mlt asset, and an id that is the name of the asset. Note that several custom files can correspond
        to the same tag, and in that case they must have different ids. We do the parsing in a map from ids to parse info, and then we add them to the asset
@@ -83,16 +111,34 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
     */
     std::unordered_map<QString, Info> customAssets;
     // reverse order to prioritize local install
+    QStringList customFiles;
     QListIterator<QString> dirs_it(asset_dirs);
     for (dirs_it.toBack(); dirs_it.hasPrevious();) { auto dir=dirs_it.previous();
         QDir current_dir(dir);
         QStringList filter {QStringLiteral("*.xml")};
         QStringList fileList = current_dir.entryList(filter, QDir::Files);
         for (const auto &file : qAsConst(fileList)) {
-            QString path = current_dir.absoluteFilePath(file);
-            parseCustomAssetFile(path, customAssets);
+            customFiles << current_dir.absoluteFilePath(file);
         }
     }
+    // Files are read and parsed in parallel, their content is then interpreted in order since assets can refer to each other
+    std::vector<std::pair<QString, QDomDocument>> documents;
+    documents.reserve(size_t(customFiles.size()));
+    for (const QString &path : qAsConst(customFiles)) {
+        documents.emplace_back(path, QDomDocument());
+    }
+    QtConcurrent::blockingMap(documents, [](std::pair<QString, QDomDocument> &document) {
+        QFile file(document.first);
+        document.second.setContent(&file, false);
+    });
+    for (const auto &document : documents) {
+        m_parsedFiles.insert(document.first, document.second);
+    }
+    for (const QString &path : qAsConst(customFiles)) {
+        parseCustomAssetFile(path, customAssets);
+    }
+    m_parsedFiles.clear();
+    qCDebug(KDENLIVE_LOAD_LOG) << "Assets" << assetCatalogName() << customFiles.size() << "custom files:" << timer.restart() << "ms";
 
     // We add the custom assets
     QStringList missingDependency;
@@ -105,33 +151,11 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
         m_assets[custom.first] = custom.second;
 
         QString dependency = custom.second.xml.attribute(QStringLiteral("dependency"), QString());
-        if(!dependency.isEmpty()) {
-            bool found = false;
-            QScopedPointer<Mlt::Properties> effects(pCore->getMltRepository()->filters());
-            for(int i = 0; i < effects->count(); ++i) {
-                if(effects->get_name(i) == dependency) {
-                    found = true;
-                    break;
-                }
-            }
-
-            if(!found) {
-                QScopedPointer<Mlt::Properties> transitions(pCore->getMltRepository()->transitions());
-                for(int i = 0; i < transitions->count(); ++i) {
-                    if(transitions->get_name(i) == dependency) {
-                        found = true;
-                        break;
-                    }
-                }
-            }
-
-            if(!found) {
-                // asset depends on another asset that is invalid so remove this asset too
-                missingDependency << custom.first;
-                qDebug() << "Asset" << custom.first << "has invalid dependency" << dependency << "and is going to be removed";
-            }
+        if (!dependency.isEmpty() && !mltServices.contains(dependency)) {
+            // asset depends on another asset that is invalid so remove this asset too
+            missingDependency << custom.first;
+            qDebug() << "Asset" << custom.first << "has invalid dependency" << dependency << "and is going to be removed";
         }
-
     }
     // Remove really invalid assets
     emptyMetaAssets << missingDependency;
@@ -139,6 +163,118 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
     for (const auto &invalid : qAsConst(emptyMetaAssets)) {
         m_assets.erase(invalid);
     }
+    saveCatalog(cacheKey);
+    qCDebug(KDENLIVE_LOAD_LOG) << "Assets" << assetCatalogName() << "validation and catalog cache:" << timer.restart() << "ms";
+}
+
+template <typename AssetType>
+QString AbstractAssetsRepository<AssetType>::catalogKey(Mlt::Properties *assets, const QSet<QString> &mltServices, const QStringList &assetDirs) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(catalogVersion));
+    hash.addData(QByteArray(mlt_version_get_string()));
+    hash.addData(QCoreApplication::applicationVersion().toUtf8());
+    // Names and descriptions are translated
+    hash.addData(KLocalizedString::languages().join(QLatin1Char(',')).toUtf8());
+    for (int i = 0; i < assets->count(); ++i) {
+        hash.addData(QByteArray(assets->get_name(i)) + '\n');
+    }
+    QStringList services = mltServices.values();
+    services.sort();
+    hash.addData(services.join(QLatin1Char('\n')).toUtf8());
+    for (const QString &dir : assetDirs) {
+        const QFileInfoList files = QDir(dir).entryInfoList({QStringLiteral("*.xml")}, QDir::Files, QDir::Name);
+        for (const QFileInfo &file : files) {
+            hash.addData(QStringLiteral("%1:%2:%3\n").arg(file.absoluteFilePath()).arg(file.lastModified().toMSecsSinceEpoch()).arg(file.size()).toUtf8());
+        }
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+template <typename AssetType> QString AbstractAssetsRepository<AssetType>::catalogPath() const
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    return dir.absoluteFilePath(QStringLiteral("assets/%1.xml").arg(assetCatalogName()));
+}
+
+template <typename AssetType> bool AbstractAssetsRepository<AssetType>::loadCatalog(const QString &key)
+{
+    QFile file(catalogPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDomDocument doc;
+    if (!doc.setContent(&file, false)) {
+        return false;
+    }
+    file.close();
+    QDomElement catalog = doc.documentElement();
+    if (catalog.attribute(QStringLiteral("key")) != key) {
+        return false;
+    }
+    std::unordered_map<QString, Info> assets;
+    QDomElement asset = catalog.firstChildElement(QStringLiteral("asset"));
+    while (!asset.isNull()) {
+        Info info;
+        info.id = asset.attribute(QStringLiteral("id"));
+        info.mltId = asset.attribute(QStringLiteral("mltId"));
+        info.name = asset.attribute(QStringLiteral("name"));
+        info.description = asset.attribute(QStringLiteral("description"));
+        info.author = asset.attribute(QStringLiteral("author"));
+        info.version_str = asset.attribute(QStringLiteral("version_str"));
+        info.version = asset.attribute(QStringLiteral("version")).toInt();
+        info.type = AssetType(asset.attribute(QStringLiteral("type")).toInt());
+        info.xml = asset.firstChildElement();
+        assets[info.id] = info;
+        asset = asset.nextSiblingElement(QStringLiteral("asset"));
+    }
+    m_assets = std::move(assets);
+    return true;
+}
+
+template <typename AssetType> bool AbstractAssetsRepository<AssetType>::saveCatalog(const QString &key) const
+{
+    QDomDocument doc;
+    QDomElement catalog = doc.createElement(QStringLiteral("catalog"));
+    catalog.setAttribute(QStringLiteral("key"), key);
+    doc.appendChild(catalog);
+    for (const auto &asset : m_assets) {
+        const Info &info = asset.second;
+        QDomElement element = doc.createElement(QStringLiteral("asset"));
+        element.setAttribute(QStringLiteral("id"), asset.first);
+        element.setAttribute(QStringLiteral("mltId"), info.mltId);
+        element.setAttribute(QStringLiteral("name"), info.name);
+        element.setAttribute(QStringLiteral("description"), info.description);
+        element.setAttribute(QStringLiteral("author"), info.author);
+        element.setAttribute(QStringLiteral("version_str"), info.version_str);
+        element.setAttribute(QStringLiteral("version"), info.version);
+        element.setAttribute(QStringLiteral("type"), int(info.type));
+        if (!info.xml.isNull()) {
+            element.appendChild(doc.importNode(info.xml, true));
+        }
+        catalog.appendChild(element);
+    }
+    const QString path = catalogPath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write asset catalog" << path;
+        return false;
+    }
+    file.write(doc.toByteArray());
+    return file.commit();
+}
+
+template <typename AssetType> QDomDocument AbstractAssetsRepository<AssetType>::readAssetFile(const QString &path) const
+{
+    if (m_parsedFiles.contains(path)) {
+        return m_parsedFiles.value(path);
+    }
+    QFile file(path);
+    QDomDocument doc;
+    doc.setContent(&file, false);
+    file.close();
+    return doc;
 }
 
 template <typename AssetType> void AbstractAssetsRepository<AssetType>::parseAssetList(const QString &filePath, QSet<QString> &destination)
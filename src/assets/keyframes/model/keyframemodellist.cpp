@@ -87,12 +87,24 @@ bool KeyframeModelList::applyOperation(const std::function<bool(std::shared_ptr<
             return res;
         }
     }
+    updateLinkedAssets(undo, redo);
     if (res && !undoString.isEmpty()) {
         PUSH_UNDO(undo, redo, undoString);
     }
     return res;
 }
 
+void KeyframeModelList::updateLinkedAssets(Fun &undo, Fun &redo)
+{
+    if (auto ptr = m_model.lock()) {
+        QStringList names;
+        for (const auto &param : m_parameters) {
+            names << ptr->data(param.first, AssetParameterModel::NameRole).toString();
+        }
+        ptr->updateLinkedAssets(names, undo, redo);
+    }
+}
+
 bool KeyframeModelList::addKeyframe(GenTime pos, KeyframeType type)
 {
     QWriteLocker locker(&m_lock);
@@ -157,6 +169,9 @@ bool KeyframeModelList::removeKeyframeWithUndo(GenTime pos, Fun &undo, Fun &redo
     for (const auto &param : m_parameters) {
         result = result && param.second->removeKeyframe(pos, undo, redo);
     }
+    if (result) {
+        updateLinkedAssets(undo, redo);
+    }
     return result;
 }
 
@@ -166,6 +181,9 @@ bool KeyframeModelList::duplicateKeyframeWithUndo(GenTime srcPos, GenTime destPo
     for (const auto &param : m_parameters) {
         result = result && param.second->duplicateKeyframe(srcPos, destPos, undo, redo);
     }
+    if (result) {
+        updateLinkedAssets(undo, redo);
+    }
     return result;
 }
 
@@ -199,6 +217,9 @@ bool KeyframeModelList::moveKeyframeWithUndo(GenTime oldPos, GenTime pos, Fun &u
     for (const auto &param : m_parameters) {
         result = result && param.second->moveKeyframe(oldPos, pos, QVariant(), undo, redo);
     }
+    if (result) {
+        updateLinkedAssets(undo, redo);
+    }
     return result;
 }
 
@@ -275,6 +296,7 @@ bool KeyframeModelList::updateKeyframeType(GenTime pos, int type, const QPersist
         res = res && param.second->updateKeyframeType(pos, type, undo, redo);
     }
     if (res) {
+        updateLinkedAssets(undo, redo);
         PUSH_UNDO(undo, redo, i18n("Update keyframe"));
     }
     return res;
@@ -161,6 +161,8 @@ public:
 protected:
     /** @brief Helper function to apply a given operation on all parameters */
     bool applyOperation(const std::function<bool(std::shared_ptr<KeyframeModel>, Fun &, Fun &)> &op, const QString &undoString);
+    /** @brief Apply the keyframes of all parameters to the linked assets */
+    void updateLinkedAssets(Fun &undo, Fun &redo);
 
 signals:
     void modelChanged();
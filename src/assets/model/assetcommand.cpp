@@ -22,6 +22,7 @@
 #include "assetcommand.hpp"
 #include "assets/keyframes/model/keyframemodellist.hpp"
 #include "effects/effectsrepository.hpp"
+#include "macros.hpp"
 #include "transitions/transitionsrepository.hpp"
 #include <memory>
 #include <utility>
@@ -42,16 +43,41 @@ AssetCommand::AssetCommand(const std::shared_ptr<AssetParameterModel> &model, co
     }
     QVariant previousVal = m_model->data(index, AssetParameterModel::ValueRole);
     m_oldValue = previousVal.type() == previousVal.toString();
+    // Linked assets are edited in the same command, so that undo restores all of them
+    m_linkedUndo = []() { return true; };
+    m_linkedRedo = []() { return true; };
+    const QVector<std::shared_ptr<AssetParameterModel>> linked = m_model->linkedAssets();
+    for (const auto &asset : linked) {
+        std::weak_ptr<AssetParameterModel> ptr = asset;
+        const QString name = m_name;
+        const QString oldValue = asset->getParam(m_name);
+        Fun local_undo = [ptr, name, oldValue]() {
+            if (auto linkedAsset = ptr.lock()) {
+                linkedAsset->setParameter(name, oldValue);
+            }
+            return true;
+        };
+        // The value is read when redoing, it changes when commands are merged
+        Fun local_redo = [this, ptr]() {
+            if (auto linkedAsset = ptr.lock()) {
+                linkedAsset->setParameter(m_name, m_value);
+            }
+            return true;
+        };
+        UPDATE_UNDO_REDO_NOLOCK(local_redo, local_undo, m_linkedUndo, m_linkedRedo);
+    }
 }
 
 void AssetCommand::undo()
 {
     m_model->setParameter(m_name, m_oldValue, true, m_index);
+    m_linkedUndo();
 }
 
 void AssetCommand::redo()
 {
     m_model->setParameter(m_name, m_value, m_updateView, m_index);
+    m_linkedRedo();
     m_updateView = true;
 }
 
@@ -87,9 +113,40 @@ AssetMultiCommand::AssetMultiCommand(const std::shared_ptr<AssetParameterModel>
     } else if (TransitionsRepository::get()->exists(id)) {
         setText(i18n("Edit %1", TransitionsRepository::get()->getName(id)));
     }
+    QStringList names;
     for (QModelIndex ix : qAsConst(m_indexes)) {
         QVariant previousVal = m_model->data(ix, AssetParameterModel::ValueRole);
         m_oldValues << previousVal.toString();
+        names << m_model->data(ix, AssetParameterModel::NameRole).toString();
+    }
+    // Linked assets are edited in the same command, so that undo restores all of them
+    m_linkedUndo = []() { return true; };
+    m_linkedRedo = []() { return true; };
+    const QVector<std::shared_ptr<AssetParameterModel>> linked = m_model->linkedAssets();
+    for (const auto &asset : linked) {
+        std::weak_ptr<AssetParameterModel> ptr = asset;
+        QStringList oldValues;
+        for (const QString &name : qAsConst(names)) {
+            oldValues << asset->getParam(name);
+        }
+        Fun local_undo = [ptr, names, oldValues]() {
+            if (auto linkedAsset = ptr.lock()) {
+                for (int i = 0; i < names.size(); ++i) {
+                    linkedAsset->setParameter(names.at(i), oldValues.at(i), i == names.size() - 1);
+                }
+            }
+            return true;
+        };
+        // The values are read when redoing, they change when commands are merged
+        Fun local_redo = [this, ptr, names]() {
+            if (auto linkedAsset = ptr.lock()) {
+                for (int i = 0; i < names.size(); ++i) {
+                    linkedAsset->setParameter(names.at(i), m_values.at(i), i == names.size() - 1);
+                }
+            }
+            return true;
+        };
+        UPDATE_UNDO_REDO_NOLOCK(local_redo, local_undo, m_linkedUndo, m_linkedRedo);
     }
 }
 
@@ -101,6 +158,7 @@ void AssetMultiCommand::undo()
         m_model->setParameter(m_model->data(ix, AssetParameterModel::NameRole).toString(), m_oldValues.at(indx), indx == max, ix);
         indx++;
     }
+    m_linkedUndo();
 }
 // virtual
 void AssetMultiCommand::redo()
@@ -111,6 +169,7 @@ void AssetMultiCommand::redo()
         m_model->setParameter(m_model->data(ix, AssetParameterModel::NameRole).toString(), m_values.at(indx), m_updateView && indx == max, ix);
         indx++;
     }
+    m_linkedRedo();
     m_updateView = true;
 }
 
@@ -148,16 +207,41 @@ AssetKeyframeCommand::AssetKeyframeCommand(const std::shared_ptr<AssetParameterM
         setText(i18n("Edit %1 keyframe", TransitionsRepository::get()->getName(id)));
     }
     m_oldValue = m_model->getKeyframeModel()->getKeyModel(m_index)->getInterpolatedValue(m_pos);
+    // Linked assets receive the keyframes of the edited parameter in the same command
+    m_linkedUndo = []() { return true; };
+    m_linkedRedo = []() { return true; };
+    const QString name = m_model->data(index, AssetParameterModel::NameRole).toString();
+    const QVector<std::shared_ptr<AssetParameterModel>> linked = m_model->linkedAssets();
+    for (const auto &asset : linked) {
+        std::weak_ptr<AssetParameterModel> ptr = asset;
+        const QString oldValue = asset->getParam(name);
+        Fun local_undo = [ptr, name, oldValue]() {
+            if (auto linkedAsset = ptr.lock()) {
+                linkedAsset->setParameter(name, oldValue);
+            }
+            return true;
+        };
+        // The keyframes are read when redoing, they change when commands are merged
+        Fun local_redo = [this, ptr, name]() {
+            if (auto linkedAsset = ptr.lock()) {
+                linkedAsset->setParameter(name, m_model->getParam(name));
+            }
+            return true;
+        };
+        UPDATE_UNDO_REDO_NOLOCK(local_redo, local_undo, m_linkedUndo, m_linkedRedo);
+    }
 }
 
 void AssetKeyframeCommand::undo()
 {
     m_model->getKeyframeModel()->getKeyModel(m_index)->directUpdateKeyframe(m_pos, m_oldValue);
+    m_linkedUndo();
 }
 // virtual
 void AssetKeyframeCommand::redo()
 {
     m_model->getKeyframeModel()->getKeyModel(m_index)->directUpdateKeyframe(m_pos, m_value);
+    m_linkedRedo();
     m_updateView = true;
 }
 
@@ -23,6 +23,7 @@
 #define ASSETCOMMAND_H
 
 #include "assetparametermodel.hpp"
+#include "undohelper.hpp"
 #include <QPersistentModelIndex>
 #include <QTime>
 #include <QUndoCommand>
@@ -48,6 +49,9 @@ private:
     QString m_oldValue;
     bool m_updateView;
     QTime m_stamp;
+    /** @brief Apply and revert the change on the linked assets */
+    Fun m_linkedUndo;
+    Fun m_linkedRedo;
 };
 
 /** @class AssetMultiCommand
@@ -71,6 +75,9 @@ private:
     QStringList m_oldValues;
     bool m_updateView;
     QTime m_stamp;
+    /** @brief Apply and revert the changes on the linked assets */
+    Fun m_linkedUndo;
+    Fun m_linkedRedo;
 };
 
 /** @class AssetKeyframeCommand
@@ -95,6 +102,9 @@ private:
     GenTime m_pos;
     bool m_updateView;
     QTime m_stamp;
+    /** @brief Apply and revert the keyframe change on the linked assets */
+    Fun m_linkedUndo;
+    Fun m_linkedRedo;
 };
 
 /** @class AssetUpdateCommand
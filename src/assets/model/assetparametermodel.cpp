@@ -22,11 +22,14 @@
 #include "assetparametermodel.hpp"
 #include "assets/keyframes/model/keyframemodellist.hpp"
 #include "core.h"
+#include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "klocalizedstring.h"
+#include "macros.hpp"
 #include "profiles/profilemodel.hpp"
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QString>
@@ -34,6 +37,10 @@
 #include <effects/effectsrepository.hpp>
 #define DEBUG_LOCALE false
 
+int AssetParameterModel::s_parameterWrites = 0;
+int AssetParameterModel::s_itemRefreshes = 0;
+QElapsedTimer AssetParameterModel::s_statsTimer;
+
 AssetParameterModel::AssetParameterModel(std::unique_ptr<Mlt::Properties> asset, const QDomElement &assetXml, const QString &assetId, ObjectId ownerId,
                                          const QString& originalDecimalPoint, QObject *parent)
     : QAbstractListModel(parent)
@@ -46,6 +53,8 @@ AssetParameterModel::AssetParameterModel(std::unique_ptr<Mlt::Properties> asset,
     , m_filterProgress(0)
 {
     Q_ASSERT(m_asset->is_valid());
+    m_updateTimer.setSingleShot(true);
+    connect(&m_updateTimer, &QTimer::timeout, this, &AssetParameterModel::applyPendingUpdates);
     QDomNodeList parameterNodes = assetXml.elementsByTagName(QStringLiteral("parameter"));
     m_hideKeyframesByDefault = assetXml.hasAttribute(QStringLiteral("hideKeyframes"));
     m_isAudio = assetXml.attribute(QStringLiteral("type")) == QLatin1String("audio");
@@ -227,6 +236,7 @@ AssetParameterModel::AssetParameterModel(std::unique_ptr<Mlt::Properties> asset,
 
 void AssetParameterModel::prepareKeyframes()
 {
+    m_keyframesDeferred = false;
     if (m_keyframes) return;
     int ix = 0;
     for (const auto &name : qAsConst(m_rows)) {
@@ -266,11 +276,13 @@ void AssetParameterModel::setParameter(const QString &name, int value, bool upda
 {
     Q_ASSERT(m_asset->is_valid());
     m_asset->set(name.toLatin1().constData(), value);
+    s_parameterWrites++;
     if (m_fixedParams.count(name) == 0) {
         m_params[name].value = value;
     } else {
         m_fixedParams[name] = value;
     }
+    bool replug = false;
     if (m_assetId.startsWith(QStringLiteral("sox_"))) {
         // Warning, SOX effect, need unplug/replug
         qDebug() << "// Warning, SOX effect, need unplug/replug";
@@ -279,28 +291,24 @@ void AssetParameterModel::setParameter(const QString &name, int value, bool upda
             effectParam << m_asset->get(pName.toUtf8().constData());
         }
         m_asset->set("effect", effectParam.join(QLatin1Char(' ')).toUtf8().constData());
-        emit replugEffect(shared_from_this());
+        replug = true;
     } else if (m_assetId.startsWith(QStringLiteral("ladspa"))) {
         // these effects don't understand param change and need to be rebuild
-        emit replugEffect(shared_from_this());
+        replug = true;
     }
     if (update) {
         emit modelChanged();
         emit dataChanged(index(0, 0), index(m_rows.count() - 1, 0), {});
-        // Update fades in timeline
-        pCore->updateItemModel(m_ownerId, m_assetId);
-        if (!m_isAudio) {
-            // Trigger monitor refresh
-            pCore->refreshProjectItem(m_ownerId);
-            // Invalidate timeline preview
-            pCore->invalidateItem(m_ownerId);
-        }
+    }
+    if (replug || update) {
+        scheduleUpdate(replug, update);
     }
 }
 
 void AssetParameterModel::internalSetParameter(const QString &name, const QString &paramValue, const QModelIndex &paramIndex)
 {
     Q_ASSERT(m_asset->is_valid());
+    s_parameterWrites++;
     // TODO: this does not really belong here, but I don't see another way to do it so that undo works
     if (data(paramIndex, AssetParameterModel::TypeRole).value<ParamType>() == ParamType::Curve) {
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
@@ -341,7 +349,8 @@ void AssetParameterModel::internalSetParameter(const QString &name, const QStrin
         if (m_fixedParams.count(name) == 0) {
             m_params[name].value = paramValue;
             if (m_keyframes) {
-                KeyframeModel *km = m_keyframes->getKeyModel(paramIndex);
+                // Linked assets are updated by name
+                KeyframeModel *km = m_keyframes->getKeyModel(paramIndex.isValid() ? paramIndex : index(m_rows.indexOf(name), 0));
                 if (km) {
                     km->refresh();
                 } else {
@@ -368,11 +377,11 @@ void AssetParameterModel::setParameter(const QString &name, const QString &param
             effectParam << m_asset->get(pName.toUtf8().constData());
         }
         m_asset->set("effect", effectParam.join(QLatin1Char(' ')).toUtf8().constData());
-        emit replugEffect(shared_from_this());
+        scheduleUpdate(true, false);
         updateChildRequired = false;
     } else if (m_assetId.startsWith(QStringLiteral("ladspa"))) {
         // these effects don't understand param change and need to be rebuild
-        emit replugEffect(shared_from_this());
+        scheduleUpdate(true, false);
         updateChildRequired = false;
     } else if (update) {
         qDebug() << "// SENDING DATA CHANGE....";
@@ -392,6 +401,26 @@ void AssetParameterModel::setParameter(const QString &name, const QString &param
         // Used for generator clips
         if (!update) emit modelChanged();
     } else {
+        scheduleUpdate(false, true);
+    }
+}
+
+void AssetParameterModel::scheduleUpdate(bool replug, bool refresh)
+{
+    m_pendingReplug = m_pendingReplug || replug;
+    m_pendingRefresh = m_pendingRefresh || refresh;
+    if (!m_updateTimer.isActive()) {
+        m_updateTimer.start(qMax(1, int(1000. / pCore->getCurrentFps())));
+    }
+}
+
+void AssetParameterModel::applyPendingUpdates()
+{
+    if (m_pendingReplug) {
+        m_pendingReplug = false;
+        emit replugEffect(shared_from_this());
+    }
+    if (m_pendingRefresh && m_ownerId.first != ObjectType::NoItem) {
         // Update fades in timeline
         pCore->updateItemModel(m_ownerId, m_assetId);
         if (!m_isAudio) {
@@ -399,8 +428,18 @@ void AssetParameterModel::setParameter(const QString &name, const QString &param
             pCore->refreshProjectItem(m_ownerId);
             // Invalidate timeline preview
             pCore->invalidateItem(m_ownerId);
+            s_itemRefreshes++;
         }
     }
+    m_pendingRefresh = false;
+    if (!s_statsTimer.isValid()) {
+        s_statsTimer.start();
+    } else if (s_statsTimer.elapsed() >= 1000) {
+        qint64 elapsed = s_statsTimer.restart();
+        qCDebug(KDENLIVE_LOG) << "Asset parameters:" << s_parameterWrites * 1000 / elapsed << "writes/s," << s_itemRefreshes * 1000 / elapsed << "refreshes/s";
+        s_parameterWrites = 0;
+        s_itemRefreshes = 0;
+    }
 }
 
 AssetParameterModel::~AssetParameterModel() = default;
@@ -780,6 +819,48 @@ QVector<QPair<QString, QVariant>> AssetParameterModel::getAllParameters() const
     return res;
 }
 
+QVector<std::shared_ptr<AssetParameterModel>> AssetParameterModel::linkedAssets()
+{
+    return {};
+}
+
+void AssetParameterModel::updateLinkedAssets(const QStringList &names, Fun &undo, Fun &redo)
+{
+    const QVector<std::shared_ptr<AssetParameterModel>> linked = linkedAssets();
+    if (linked.isEmpty() || names.isEmpty()) {
+        return;
+    }
+    QStringList values;
+    for (const QString &name : names) {
+        values << getParam(name);
+    }
+    for (const auto &asset : linked) {
+        std::weak_ptr<AssetParameterModel> ptr = asset;
+        QStringList oldValues;
+        for (const QString &name : names) {
+            oldValues << asset->getParam(name);
+        }
+        Fun local_undo = [ptr, names, oldValues]() {
+            if (auto linkedAsset = ptr.lock()) {
+                for (int i = 0; i < names.size(); ++i) {
+                    linkedAsset->setParameter(names.at(i), oldValues.at(i), i == names.size() - 1);
+                }
+            }
+            return true;
+        };
+        Fun local_redo = [ptr, names, values]() {
+            if (auto linkedAsset = ptr.lock()) {
+                for (int i = 0; i < names.size(); ++i) {
+                    linkedAsset->setParameter(names.at(i), values.at(i), i == names.size() - 1);
+                }
+            }
+            return true;
+        };
+        local_redo();
+        UPDATE_UNDO_REDO_NOLOCK(local_redo, local_undo, undo, redo);
+    }
+}
+
 QJsonDocument AssetParameterModel::toJson(bool includeFixed) const
 {
     QJsonArray list;
@@ -1168,8 +1249,16 @@ void AssetParameterModel::addKeyframeParam(const QModelIndex &index)
     }
 }
 
+void AssetParameterModel::deferKeyframes()
+{
+    m_keyframesDeferred = m_keyframes == nullptr;
+}
+
 std::shared_ptr<KeyframeModelList> AssetParameterModel::getKeyframeModel()
 {
+    if (m_keyframesDeferred) {
+        prepareKeyframes();
+    }
     return m_keyframes;
 }
 
@@ -1178,9 +1267,9 @@ void AssetParameterModel::resetAsset(std::unique_ptr<Mlt::Properties> asset)
     m_asset = std::move(asset);
 }
 
-bool AssetParameterModel::hasMoreThanOneKeyframe() const
+bool AssetParameterModel::hasMoreThanOneKeyframe()
 {
-    if (m_keyframes) {
+    if (getKeyframeModel()) {
         return (!m_keyframes->isEmpty() && !m_keyframes->singleKeyframe());
     }
     return false;
@@ -24,9 +24,12 @@
 
 #include "definitions.h"
 #include "klocalizedstring.h"
+#include "undohelper.hpp"
 #include <QAbstractListModel>
 #include <QDomElement>
+#include <QElapsedTimer>
 #include <QJsonDocument>
+#include <QTimer>
 #include <unordered_map>
 
 #include <memory>
@@ -158,6 +161,11 @@ public:
 
     /** @brief Return all the parameters as pairs (parameter name, parameter value) */
     QVector<QPair<QString, QVariant>> getAllParameters() const;
+    /** @brief Returns the assets whose parameters are edited together with this one */
+    virtual QVector<std::shared_ptr<AssetParameterModel>> linkedAssets();
+    /** @brief Copy the current value of the given parameters to the linked assets, used after a keyframe edit so that it is applied to all of them
+       in the same undo operation */
+    void updateLinkedAssets(const QStringList &names, Fun &undo, Fun &redo);
     /** @brief Returns a json definition of the effect with all param values */
     QJsonDocument toJson(bool includeFixed = true) const;
     /** @brief Returns the interpolated value at the given position with all param values as json*/
@@ -178,16 +186,18 @@ public:
     /** @brief Returns the id of the actual object associated with this asset */
     ObjectId getOwnerId() const;
 
-    /** @brief Returns the keyframe model associated with this asset
+    /** @brief Returns the keyframe model associated with this asset, building it if it was deferred
        Return empty ptr if there is no keyframable parameter in the asset or if prepareKeyframes was not called
      */
     Q_INVOKABLE std::shared_ptr<KeyframeModelList> getKeyframeModel();
 
     /** @brief Must be called before using the keyframes of this model */
     void prepareKeyframes();
+    /** @brief Like prepareKeyframes, but the keyframes are only built on the first call to getKeyframeModel */
+    void deferKeyframes();
     void resetAsset(std::unique_ptr<Mlt::Properties> asset);
     /** @brief Returns true if the effect has more than one keyframe */
-    bool hasMoreThanOneKeyframe() const;
+    bool hasMoreThanOneKeyframe();
     int time_to_frames(const QString &time);
     void passProperties(Mlt::Properties &target);
     /** @brief Returns a list of the parameter names that are keyframable */
@@ -248,6 +258,8 @@ protected:
     std::unique_ptr<Mlt::Properties> m_asset;
 
     std::shared_ptr<KeyframeModelList> m_keyframes;
+    /** @brief true if the keyframes must be built on next access */
+    bool m_keyframesDeferred{false};
     /** @brief if true, keyframe tools will be hidden by default */
     bool m_hideKeyframesByDefault;
     /** @brief true if this is an audio effect, used to prevent unnecessary monitor refresh / timeline invalidate */
@@ -260,6 +272,18 @@ protected:
      */
     void internalSetParameter(const QString &name, const QString &paramValue, const QModelIndex &paramIndex = QModelIndex());
 
+    /** @brief Parameter changes received within one frame interval share a single replug and monitor refresh */
+    QTimer m_updateTimer;
+    bool m_pendingReplug{false};
+    bool m_pendingRefresh{false};
+    /** @brief Request a replug and/or a refresh of the owner item, applied when m_updateTimer fires */
+    void scheduleUpdate(bool replug, bool refresh);
+    void applyPendingUpdates();
+    /** @brief Parameter writes and item refreshes of all assets since the last report */
+    static int s_parameterWrites;
+    static int s_itemRefreshes;
+    static QElapsedTimer s_statsTimer;
+
 signals:
     void modelChanged();
     /** @brief inform child effects (in case of bin effect with timeline producers)
@@ -29,6 +29,7 @@
 #include "monitor/monitor.h"
 
 #include <QActionGroup>
+#include <QApplication>
 #include <QDebug>
 #include <QDir>
 #include <QFontDatabase>
@@ -48,6 +49,22 @@ AssetParameterView::AssetParameterView(QWidget *parent)
     setFont(QFontDatabase::systemFont(QFontDatabase::SmallestReadableFont));
     // Presets Combo
     m_presetMenu = new QMenu(this);
+    m_commitTimer.setSingleShot(true);
+    connect(&m_commitTimer, &QTimer::timeout, this, &AssetParameterView::applyPendingChanges);
+    // Don't wait for the timer when the user leaves the parameters, the undo stack must be up to date
+    connect(qApp, &QApplication::focusChanged, this, [this](QWidget *old, QWidget *now) {
+        if (old && isAncestorOf(old) && (now == nullptr || !isAncestorOf(now))) {
+            applyPendingChanges();
+        }
+    });
+}
+
+AssetParameterView::~AssetParameterView()
+{
+    // Views destroyed with their effect stack are flushed by the stack first. Apply what is still queued without undo entry,
+    // pushing undo commands while the view is destroyed is not safe
+    m_pendingUndo = false;
+    applyPendingChanges();
 }
 
 void AssetParameterView::setModel(const std::shared_ptr<AssetParameterModel> &model, QSize frameSize, bool addSpacer)
@@ -186,19 +203,53 @@ void AssetParameterView::disableCurrentFilter(bool disable)
 void AssetParameterView::commitChanges(const QModelIndex &index, const QString &value, bool storeUndo)
 {
     // Warning: please note that some widgets (for example keyframes) do NOT send the valueChanged signal and do modifications on their own
-    auto *command = new AssetCommand(m_model, index, value);
-    if (storeUndo && m_model->getOwnerId().second != -1) {
-        pCore->pushUndo(command);
-    } else {
-        command->redo();
-        delete command;
-    }
+    queueChange(index, value, storeUndo && m_model->getOwnerId().second != -1);
 }
 
 void AssetParameterView::commitMultipleChanges(const QList <QModelIndex> indexes, const QStringList &values, bool storeUndo)
 {
     // Warning: please note that some widgets (for example keyframes) do NOT send the valueChanged signal and do modifications on their own
-    auto *command = new AssetMultiCommand(m_model, indexes, values);
+    for (int i = 0; i < indexes.size() && i < values.size(); ++i) {
+        queueChange(indexes.at(i), values.at(i), storeUndo);
+    }
+}
+
+void AssetParameterView::queueChange(const QModelIndex &index, const QString &value, bool storeUndo)
+{
+    // Dragging a slider or color wheel sends many values per frame, only the last one of each parameter is applied
+    int ix = m_pendingIndexes.indexOf(index);
+    if (ix > -1) {
+        m_pendingValues[ix] = value;
+    } else {
+        m_pendingIndexes << index;
+        m_pendingValues << value;
+    }
+    m_pendingUndo = m_pendingUndo || storeUndo;
+    if (!m_commitTimer.isActive()) {
+        m_commitTimer.start(qMax(1, int(1000. / pCore->getCurrentFps())));
+    }
+}
+
+void AssetParameterView::applyPendingChanges()
+{
+    m_commitTimer.stop();
+    if (m_pendingIndexes.isEmpty() || !m_model) {
+        m_pendingIndexes.clear();
+        m_pendingValues.clear();
+        m_pendingUndo = false;
+        return;
+    }
+    // The commands are merged with the previous ones on the same parameters, so a drag creates a single undo entry
+    QUndoCommand *command;
+    if (m_pendingIndexes.size() == 1) {
+        command = new AssetCommand(m_model, m_pendingIndexes.first(), m_pendingValues.first());
+    } else {
+        command = new AssetMultiCommand(m_model, m_pendingIndexes, m_pendingValues);
+    }
+    bool storeUndo = m_pendingUndo;
+    m_pendingIndexes.clear();
+    m_pendingValues.clear();
+    m_pendingUndo = false;
     if (storeUndo) {
         pCore->pushUndo(command);
     } else {
@@ -209,6 +260,8 @@ void AssetParameterView::commitMultipleChanges(const QList <QModelIndex> indexes
 
 void AssetParameterView::unsetModel()
 {
+    // Don't lose the last changes
+    applyPendingChanges();
     QMutexLocker lock(&m_lock);
     if (m_model) {
         // if a model is already there, we have to disconnect signals first
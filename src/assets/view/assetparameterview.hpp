@@ -25,6 +25,7 @@
 #include "definitions.h"
 #include <QModelIndex>
 #include <QMutex>
+#include <QTimer>
 #include <QVector>
 #include <QWidget>
 #include <memory>
@@ -45,6 +46,7 @@ class AssetParameterView : public QWidget
 
 public:
     AssetParameterView(QWidget *parent = nullptr);
+    ~AssetParameterView() override;
 
     /** Sets the model to be displayed by current view */
     virtual void setModel(const std::shared_ptr<AssetParameterModel> &model, QSize frameSize, bool addSpacer = false);
@@ -52,6 +54,9 @@ public:
     /** Set the widget to display no model (this yield ownership on the smart-ptr)*/
     void unsetModel();
 
+    /** @brief Apply the queued parameter changes now instead of waiting for the end of the frame interval */
+    void applyPendingChanges();
+
     /** Returns the preferred widget height */
     int contentHeight() const;
 
@@ -95,6 +100,13 @@ protected:
 
 private:
     QVector<QPair<QString, QVariant>> getDefaultValues() const;
+    /** @brief Parameter changes waiting to be applied, collected during one frame interval */
+    QList<QModelIndex> m_pendingIndexes;
+    QStringList m_pendingValues;
+    bool m_pendingUndo{false};
+    QTimer m_commitTimer;
+    /** @brief Queue a parameter change, all changes of the frame interval are applied as one command */
+    void queueChange(const QModelIndex &index, const QString &value, bool storeUndo);
 
 private slots:
     /** @brief Apply a change of parameter sent by the view
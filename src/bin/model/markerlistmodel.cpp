@@ -72,27 +72,82 @@ void MarkerListModel::setup()
 
 bool MarkerListModel::hasMarker(GenTime pos) const
 {
-    std::map<int, CommentedTime>::const_iterator it = m_markerList.begin();
-    while (it != m_markerList.end()) {
-        if (it->second.time() == pos) {
-            return true;
+    return findMarker(pos) != -1;
+}
+
+
+CommentedTime MarkerListModel::marker(GenTime pos) const
+{
+    int mid = findMarker(pos);
+    if (mid == -1) {
+        return CommentedTime();
+    }
+    return m_markerList.at(mid);
+}
+
+int MarkerListModel::findMarker(const GenTime &pos) const
+{
+    std::pair<int, int> timebase = pCore->getCurrentTimebase();
+    if (timebase != m_positionsTimebase) {
+        // Frame rate changed since the index was built, look through all markers
+        std::map<int, CommentedTime>::const_iterator it = m_markerList.begin();
+        while (it != m_markerList.end()) {
+            if (it->second.time() == pos) {
+                return it->first;
+            }
+            it++;
+        }
+        return -1;
+    }
+    // GenTime equality allows a difference of almost one frame, so check the neighbour frames. The lowest id wins, like when iterating the list
+    FrameTime key = FrameTime::fromGenTime(pos, timebase.first, timebase.second);
+    int result = -1;
+    auto it = m_markerPositions.lower_bound(key - 1);
+    while (it != m_markerPositions.end() && it->first <= key + 1) {
+        if ((result == -1 || it->second < result) && m_markerList.at(it->second).time() == pos) {
+            result = it->second;
         }
-        it++;
+        ++it;
     }
-    return false;
+    return result;
 }
 
+void MarkerListModel::indexMarker(int mid)
+{
+    if (checkPositionIndex()) {
+        // Index was rebuilt and already contains the marker
+        return;
+    }
+    const auto &timebase = m_positionsTimebase;
+    m_markerPositions.emplace(FrameTime::fromGenTime(m_markerList.at(mid).time(), timebase.first, timebase.second), mid);
+}
 
-CommentedTime MarkerListModel::marker(GenTime pos) const
+void MarkerListModel::unindexMarker(int mid)
 {
-    std::map<int, CommentedTime>::const_iterator it = m_markerList.begin();
-    while (it != m_markerList.end()) {
-        if (it->second.time() == pos) {
-            return it->second;
+    checkPositionIndex();
+    const auto &timebase = m_positionsTimebase;
+    auto range = m_markerPositions.equal_range(FrameTime::fromGenTime(m_markerList.at(mid).time(), timebase.first, timebase.second));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == mid) {
+            m_markerPositions.erase(it);
+            return;
         }
-        it++;
     }
-    return CommentedTime();
+    Q_ASSERT(false);
+}
+
+bool MarkerListModel::checkPositionIndex()
+{
+    std::pair<int, int> timebase = pCore->getCurrentTimebase();
+    if (timebase == m_positionsTimebase) {
+        return false;
+    }
+    m_positionsTimebase = timebase;
+    m_markerPositions.clear();
+    for (const auto &marker : m_markerList) {
+        m_markerPositions.emplace(FrameTime::fromGenTime(marker.second.time(), timebase.first, timebase.second), marker.first);
+    }
+    return true;
 }
 
 bool MarkerListModel::addMarker(GenTime pos, const QString &comment, int type, Fun &undo, Fun &redo)
@@ -230,14 +285,7 @@ int MarkerListModel::getRowfromId(int mid) const
 int MarkerListModel::getIdFromPos(const GenTime &pos) const
 {
     READ_LOCK();
-    std::map<int, CommentedTime>::const_iterator it = m_markerList.begin();
-    while (it != m_markerList.end()) {
-        if (it->second.time() == pos) {
-            return it->first;
-        }
-        it++;
-    }
-    return -1;
+    return findMarker(pos);
 }
 
 bool MarkerListModel::moveMarker(int mid, GenTime pos)
@@ -249,7 +297,9 @@ bool MarkerListModel::moveMarker(int mid, GenTime pos)
         return false;
     }
     int row = getRowfromId(mid);
+    unindexMarker(mid);
     m_markerList[mid].setTime(pos);
+    indexMarker(mid);
     emit dataChanged(index(row), index(row), {FrameRole});
     return true;
 }
@@ -265,7 +315,9 @@ void MarkerListModel::moveMarkersWithoutUndo(QVector<int> markersId, int offset,
     for (int &mid : markersId) {
         Q_ASSERT(m_markerList.count(mid) > 0);
         GenTime t = m_markerList.at(mid).time() + GenTime(offset, pCore->getCurrentFps());
+        unindexMarker(mid);
         m_markerList[mid].setTime(t);
+        indexMarker(mid);
         if (!updateView) {
             continue;
         }
@@ -342,6 +394,7 @@ Fun MarkerListModel::addMarker_lambda(GenTime pos, const QString &comment, int t
         int insertionRow = static_cast<int>(model->m_markerList.size());
         model->beginInsertRows(QModelIndex(), insertionRow, insertionRow);
         model->m_markerList[mid] = CommentedTime(pos, comment, type);
+        model->indexMarker(mid);
         model->endInsertRows();
         model->addSnapPoint(pos);
         return true;
@@ -359,6 +412,7 @@ Fun MarkerListModel::deleteMarker_lambda(GenTime pos)
         int mid = model->getIdFromPos(pos);
         int row = model->getRowfromId(mid);
         model->beginRemoveRows(QModelIndex(), row, row);
+        model->unindexMarker(mid);
         model->m_markerList.erase(mid);
         model->endRemoveRows();
         model->removeSnapPoint(pos);
@@ -23,6 +23,7 @@
 #define MARKERLISTMODEL_H
 
 #include "definitions.h"
+#include "frametime.h"
 #include "gentime.h"
 #include "undohelper.hpp"
 
@@ -201,9 +202,19 @@ private:
     mutable QReadWriteLock m_lock;
 
     std::map<int, CommentedTime> m_markerList;
+    /** @brief Marker ids by position, expressed in frames of the timebase used to build the index */
+    std::multimap<FrameTime, int> m_markerPositions;
+    std::pair<int, int> m_positionsTimebase{0, 0};
     std::vector<std::weak_ptr<SnapInterface>> m_registeredSnaps;
     int getRowfromId(int mid) const;
     int getIdFromPos(const GenTime &pos) const;
+    /** @brief Returns the id of the marker at given position, -1 if there is none */
+    int findMarker(const GenTime &pos) const;
+    /** @brief Add or remove a marker from the position index, must be called while its position is set */
+    void indexMarker(int mid);
+    void unindexMarker(int mid);
+    /** @brief Rebuild the position index if the project frame rate changed, returns true if it was rebuilt */
+    bool checkPositionIndex();
 
 signals:
     void modelChanged();
@@ -40,6 +40,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QTextCodec>
+#include <algorithm>
 #include <utility>
 
 SubtitleModel::SubtitleModel(Mlt::Tractor *tractor, std::shared_ptr<TimelineItemModel> timeline, QObject *parent)
@@ -98,11 +99,10 @@ void SubtitleModel::importSubtitle(const QString filePath, int offset, bool exte
     if (filePath.isEmpty() || isLocked())
         return;
     Fun redo = []() { return true; };
-    Fun undo = [this]() {
-        emit modelChanged();
-        return true;
-    };
+    Fun undo = []() { return true; };
     GenTime subtitleOffset(offset, pCore->getCurrentFps());
+    // Entries are collected while streaming the file and inserted in one batch
+    QList<SubtitledTime> subtitles;
     if (filePath.endsWith(".srt")) {
         QFile srtFile(filePath);
         if (!srtFile.exists() || !srtFile.open(QIODevice::ReadOnly)) {
@@ -145,14 +145,19 @@ void SubtitleModel::importSubtitle(const QString filePath, int offset, bool exte
                 turn++;
             } else {
                 if (endPos > startPos) {
-                    addSubtitle(startPos + subtitleOffset, endPos + subtitleOffset, comment, undo, redo, false);
+                    subtitles << SubtitledTime(startPos + subtitleOffset, comment, endPos + subtitleOffset);
                 }
                 //reinitialize
                 comment.clear();
                 timeLine.clear();
+                startPos = endPos = GenTime();
                 turn = 0; r = 0;
             }            
-        }  
+        }
+        if (turn > 0 && endPos > startPos) {
+            // Last entry, not followed by an empty line
+            subtitles << SubtitledTime(startPos + subtitleOffset, comment, endPos + subtitleOffset);
+        }
         srtFile.close();
     } else if (filePath.endsWith(QLatin1String(".ass"))) {
         qDebug()<< "ass File";
@@ -253,7 +258,7 @@ void SubtitleModel::importSubtitle(const QString filePath, int offset, bool exte
                             // Text
                             comment = dialogue.at(9)+ remainingStr;
                             //qDebug()<<"Start: "<< start << "End: "<<end << comment;
-                            addSubtitle(startPos + subtitleOffset, endPos + subtitleOffset, comment, undo, redo, false);
+                            subtitles << SubtitledTime(startPos + subtitleOffset, comment, endPos + subtitleOffset);
                         }
                     }
                 }
@@ -265,13 +270,7 @@ void SubtitleModel::importSubtitle(const QString filePath, int offset, bool exte
         }
         assFile.close();
     }
-    Fun update_model= [this]() {
-        emit modelChanged();
-        return true;
-    };
-    PUSH_LAMBDA(update_model, redo);
-    update_model();
-    if (externalImport) {
+    if (addSubtitles(subtitles, undo, redo) > 0 && externalImport) {
         pCore->pushUndo(undo, redo, i18n("Edit subtitle"));
     }
 }
@@ -365,6 +364,7 @@ bool SubtitleModel::addSubtitle(int id, GenTime start, GenTime end, const QStrin
     int row = m_timeline->getSubtitleIndex(id);
     beginInsertRows(QModelIndex(), row, row);
     m_subtitleList[start] = {str, end};
+    indexDuration(start, end);
     endInsertRows();
     addSnapPoint(start);
     addSnapPoint(end);
@@ -378,6 +378,136 @@ bool SubtitleModel::addSubtitle(int id, GenTime start, GenTime end, const QStrin
     return true;
 }
 
+int SubtitleModel::addSubtitles(const QList<SubtitledTime> &subtitles, Fun &undo, Fun &redo)
+{
+    if (isLocked()) {
+        return 0;
+    }
+    std::vector<std::pair<int, SubtitledTime>> items;
+    items.reserve(size_t(subtitles.size()));
+    std::set<GenTime> usedStarts;
+    for (const auto &sub : subtitles) {
+        int startFrame = sub.start().frames(pCore->getCurrentFps());
+        if (startFrame < 0 || startFrame > sub.end().frames(pCore->getCurrentFps())) {
+            qWarning() << "Time error: invalid subtitle duration at" << startFrame;
+            continue;
+        }
+        // Don't allow 2 subtitles at same start pos
+        if (m_subtitleList.count(sub.start()) > 0 || !usedStarts.insert(sub.start()).second) {
+            continue;
+        }
+        items.emplace_back(TimelineModel::getNextId(), sub);
+    }
+    if (items.empty()) {
+        return 0;
+    }
+    std::vector<int> ids;
+    ids.reserve(items.size());
+    for (const auto &item : items) {
+        ids.push_back(item.first);
+    }
+    Fun local_redo = [this, items]() {
+        insertSubtitles(items);
+        return true;
+    };
+    Fun local_undo = [this, ids]() {
+        removeSubtitles(ids);
+        return true;
+    };
+    local_redo();
+    UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+    return int(items.size());
+}
+
+void SubtitleModel::insertSubtitles(const std::vector<std::pair<int, SubtitledTime>> &subtitles)
+{
+    GenTime rangeStart, rangeEnd;
+    bool first = true;
+    beginResetModel();
+    for (const auto &item : subtitles) {
+        const SubtitledTime &sub = item.second;
+        if (m_subtitleList.count(sub.start()) > 0) {
+            continue;
+        }
+        m_timeline->registerSubtitle(item.first, sub.start());
+        m_subtitleList[sub.start()] = {sub.subtitle(), sub.end()};
+        indexDuration(sub.start(), sub.end());
+        addSnapPoint(sub.start());
+        addSnapPoint(sub.end());
+        if (first || sub.start() < rangeStart) {
+            rangeStart = sub.start();
+        }
+        if (first || sub.end() > rangeEnd) {
+            rangeEnd = sub.end();
+        }
+        first = false;
+    }
+    // Resetting the model also triggers the subtitle filter update
+    endResetModel();
+    if (first) {
+        return;
+    }
+    if (rangeEnd.frames(pCore->getCurrentFps()) > m_timeline->duration()) {
+        m_timeline->updateDuration();
+    }
+    QPair<int, int> range = {rangeStart.frames(pCore->getCurrentFps()), rangeEnd.frames(pCore->getCurrentFps())};
+    pCore->invalidateRange(range);
+    pCore->refreshProjectRange(range);
+}
+
+void SubtitleModel::removeSubtitles(const std::vector<int> &ids)
+{
+    std::vector<int> removed;
+    for (int id : ids) {
+        if (m_timeline->m_allSubtitles.count(id) > 0) {
+            removed.push_back(id);
+        }
+    }
+    if (removed.empty()) {
+        return;
+    }
+    if (std::any_of(removed.begin(), removed.end(), [this](int id) { return isSelected(id); })) {
+        m_timeline->requestClearSelection(true);
+    }
+    GenTime rangeStart, rangeEnd;
+    bool first = true;
+    beginResetModel();
+    for (int id : removed) {
+        GenTime start = m_timeline->m_allSubtitles.at(id);
+        GenTime end = m_subtitleList.at(start).second;
+        m_timeline->deregisterSubtitle(id);
+        m_subtitleList.erase(start);
+        unindexDuration(start, end);
+        removeSnapPoint(start);
+        removeSnapPoint(end);
+        if (first || start < rangeStart) {
+            rangeStart = start;
+        }
+        if (first || end > rangeEnd) {
+            rangeEnd = end;
+        }
+        first = false;
+    }
+    endResetModel();
+    m_timeline->updateDuration();
+    QPair<int, int> range = {rangeStart.frames(pCore->getCurrentFps()), rangeEnd.frames(pCore->getCurrentFps())};
+    pCore->invalidateRange(range);
+    pCore->refreshProjectRange(range);
+}
+
+void SubtitleModel::indexDuration(GenTime start, GenTime end)
+{
+    m_durations.insert(end - start);
+}
+
+void SubtitleModel::unindexDuration(GenTime start, GenTime end)
+{
+    auto it = m_durations.find(end - start);
+    if (it != m_durations.end()) {
+        m_durations.erase(it);
+    }
+}
+
 QHash<int, QByteArray> SubtitleModel::roleNames() const 
 {
     QHash<int, QByteArray> roles;
@@ -440,10 +570,9 @@ QList<SubtitledTime> SubtitleModel::getAllSubtitles() const
 
 SubtitledTime SubtitleModel::getSubtitle(GenTime startFrame) const
 {
-    for (const auto &subtitles : m_subtitleList) {
-        if (subtitles.first == startFrame) {
-            return SubtitledTime(subtitles.first, subtitles.second.first, subtitles.second.second);
-        }
+    auto subtitle = m_subtitleList.find(startFrame);
+    if (subtitle != m_subtitleList.end()) {
+        return SubtitledTime(subtitle->first, subtitle->second.first, subtitle->second.second);
     }
     return SubtitledTime(GenTime(), QString(), GenTime());
 }
@@ -493,17 +622,20 @@ std::unordered_set<int> SubtitleModel::getItemsInRange(int startFrame, int endFr
     GenTime startTime(startFrame, pCore->getCurrentFps());
     GenTime endTime(endFrame, pCore->getCurrentFps());
     std::unordered_set<int> matching;
-    for (const auto &subtitles : m_subtitleList) {
-        if (endFrame > -1 && subtitles.first > endTime) {
-            // Outside range
-            continue;
-        }
-        if (subtitles.first >= startTime || subtitles.second.second >= startTime) {
-            int sid = getIdForStartPos(subtitles.first);
+    if (m_subtitleList.empty()) {
+        return matching;
+    }
+    // A subtitle overlapping the range cannot start before the range start minus the longest subtitle duration
+    GenTime maxDuration = *m_durations.rbegin();
+    auto it = m_subtitleList.lower_bound(startTime - maxDuration);
+    auto last = endFrame > -1 ? m_subtitleList.upper_bound(endTime) : m_subtitleList.end();
+    for (; it != last; ++it) {
+        if (it->first >= startTime || it->second.second >= startTime) {
+            int sid = getIdForStartPos(it->first);
             if (sid > -1) {
                 matching.emplace(sid);
             } else {
-                qDebug()<<"==== FOUND INVALID SUBTILE AT: "<<subtitles.first.frames(pCore->getCurrentFps());
+                qDebug()<<"==== FOUND INVALID SUBTILE AT: "<<it->first.frames(pCore->getCurrentFps());
             }
         }
     }
@@ -610,7 +742,9 @@ void SubtitleModel::editEndPos(GenTime startPos, GenTime newEndPos, bool refresh
         //is not present in model only
         return;
     }
+    unindexDuration(startPos, m_subtitleList[startPos].second);
     m_subtitleList[startPos].second = newEndPos;
+    indexDuration(startPos, newEndPos);
     // Trigger update of the qml view
     int id = getIdForStartPos(startPos);
     int row = m_timeline->getSubtitleIndex(id);
@@ -670,6 +804,8 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
         GenTime newEndPos = startPos + GenTime(size, pCore->getCurrentFps());
         operation = [this, id, startPos, endPos, newEndPos, logUndo]() {
             m_subtitleList[startPos].second = newEndPos;
+            unindexDuration(startPos, endPos);
+            indexDuration(startPos, newEndPos);
             removeSnapPoint(endPos);
             addSnapPoint(newEndPos);
             // Trigger update of the qml view
@@ -690,6 +826,8 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
         };
         reverse = [this, id, startPos, endPos, newEndPos, logUndo]() {
             m_subtitleList[startPos].second = endPos;
+            unindexDuration(startPos, newEndPos);
+            indexDuration(startPos, endPos);
             removeSnapPoint(newEndPos);
             addSnapPoint(endPos);
             // Trigger update of the qml view
@@ -716,9 +854,11 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
         }
         const QString text = m_subtitleList.at(startPos).first;
         operation = [this, id, startPos, newStartPos, endPos, text, logUndo]() {
-            m_timeline->m_allSubtitles[id] = newStartPos;
+            m_timeline->updateSubtitleStart(id, newStartPos);
             m_subtitleList.erase(startPos);
             m_subtitleList[newStartPos] = {text, endPos};
+            unindexDuration(startPos, endPos);
+            indexDuration(newStartPos, endPos);
             // Trigger update of the qml view
             removeSnapPoint(startPos);
             addSnapPoint(newStartPos);
@@ -738,9 +878,11 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
             return true;
         };
         reverse = [this, id, startPos, newStartPos, endPos, text, logUndo]() {
-            m_timeline->m_allSubtitles[id] = startPos;
+            m_timeline->updateSubtitleStart(id, startPos);
             m_subtitleList.erase(newStartPos);
             m_subtitleList[startPos] = {text, endPos};
+            unindexDuration(newStartPos, endPos);
+            indexDuration(startPos, endPos);
             removeSnapPoint(newStartPos);
             addSnapPoint(startPos);
             // Trigger update of the qml view
@@ -809,6 +951,7 @@ bool SubtitleModel::removeSubtitle(int id, bool temporary, bool updateFilter)
         lastSub = true;
     }
     m_subtitleList.erase(start);
+    unindexDuration(start, end);
     endRemoveRows();
     removeSnapPoint(start);
     removeSnapPoint(end);
@@ -866,7 +1009,7 @@ bool SubtitleModel::moveSubtitle(int subId, GenTime newPos, bool updateModel, bo
     GenTime duration = m_subtitleList[oldPos].second - oldPos;
     GenTime endPos = newPos + duration;
     int id = getIdForStartPos(oldPos);
-    m_timeline->m_allSubtitles[id] = newPos;
+    m_timeline->updateSubtitleStart(id, newPos);
     m_subtitleList.erase(oldPos);
     m_subtitleList[newPos] = {subtitleText, endPos};
     addSnapPoint(newPos);
@@ -895,11 +1038,9 @@ bool SubtitleModel::moveSubtitle(int subId, GenTime newPos, bool updateModel, bo
 
 int SubtitleModel::getIdForStartPos(GenTime startTime) const
 {
-    auto findResult = std::find_if(std::begin(m_timeline->m_allSubtitles), std::end(m_timeline->m_allSubtitles), [&](const std::pair<int, GenTime> &pair) {
-        return pair.second == startTime;
-    });
-    if (findResult != std::end(m_timeline->m_allSubtitles)) {
-        return findResult->first;
+    auto findResult = m_timeline->m_subtitlesByStart.find(startTime);
+    if (findResult != m_timeline->m_subtitlesByStart.end()) {
+        return findResult->second;
     }
     return -1;
 }
@@ -1172,6 +1313,12 @@ bool SubtitleModel::isDisabled() const
     return m_subtitleFilter->get_int("disable") == 1;
 }
 
+const QString SubtitleModel::styleDescription() const
+{
+    // The script info contains the resolution used to place the subtitles
+    return scriptInfoSection + styleSection + styleName;
+}
+
 bool SubtitleModel::isLocked() const
 {
     return m_subtitleFilter->get_int("kdenlive:locked") == 1;
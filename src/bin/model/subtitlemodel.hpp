@@ -33,6 +33,7 @@
 #include <array>
 #include <map>
 #include <memory>
+#include <set>
 #include <unordered_set>
 #include <mlt++/MltProperties.h>
 #include <mlt++/Mlt.h>
@@ -57,6 +58,9 @@ public:
     /** @brief Function that parses through a subtitle file */ 
     bool addSubtitle(int id, GenTime start,GenTime end, const QString str, bool temporary = false, bool updateFilter = true);
     bool addSubtitle(GenTime start, GenTime end, const QString str, Fun &undo, Fun &redo, bool updateFilter = true);
+    /** @brief Add a list of subtitles in one operation, with a single model reset and filter update.
+        Subtitles starting at an already used position are skipped. Returns the number of inserted subtitles */
+    int addSubtitles(const QList<SubtitledTime> &subtitles, Fun &undo, Fun &redo);
     /** @brief Converts string of time to GenTime */ 
     GenTime stringtoTime(QString &str);
     /** @brief Return model data item according to the role passed */ 
@@ -134,6 +138,8 @@ public:
     int trackDuration() const;
     void switchDisabled();
     bool isDisabled() const;
+    /** @brief Returns the style definitions used to render the subtitles */
+    const QString styleDescription() const;
     void switchLocked();
     bool isLocked() const;
     /** @brief Load some subtitle filter properties from file */
@@ -166,6 +172,9 @@ private:
     std::shared_ptr<TimelineItemModel> m_timeline;
     std::weak_ptr<DocUndoStack> m_undoStack;
     std::map<GenTime, std::pair<QString, GenTime>> m_subtitleList;
+    /** @brief Durations of all subtitles in m_subtitleList. The longest one bounds how far before a range
+        an overlapping subtitle can start, which allows range queries without a full scan */
+    std::multiset<GenTime> m_durations;
 
     QString scriptInfoSection, styleSection,eventSection;
     QString styleName;
@@ -192,6 +201,12 @@ protected:
     void removeSnapPoint(GenTime startpos);
     /** @brief Connect changes in model with signal */
     void setup();
+    /** @brief Add / remove a subtitle duration from the range query index */
+    void indexDuration(GenTime start, GenTime end);
+    void unindexDuration(GenTime start, GenTime end);
+    /** @brief Insert / remove a batch of subtitles, resetting the model once */
+    void insertSubtitles(const std::vector<std::pair<int, SubtitledTime>> &subtitles);
+    void removeSubtitles(const std::vector<int> &ids);
 
 };
 Q_DECLARE_METATYPE(SubtitleModel *)
@@ -43,6 +43,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QIcon>
 #include <QMimeData>
 #include <QProgressDialog>
+#include <QtConcurrent>
 #include <mlt++/Mlt.h>
 #include <queue>
 #include <qvarlengtharray.h>
@@ -63,6 +64,19 @@ ProjectItemModel::ProjectItemModel(QObject *parent)
     connect(m_fileWatcher.get(), &FileWatcher::binClipModified, this, &ProjectItemModel::reloadClip);
     connect(m_fileWatcher.get(), &FileWatcher::binClipWaiting, this, &ProjectItemModel::setClipWaiting);
     connect(m_fileWatcher.get(), &FileWatcher::binClipMissing, this, &ProjectItemModel::setClipInvalid);
+    // Keep the search index in sync with every data change, whoever emits it
+    connect(this, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles) {
+        if (roles.size() == 1 && roles.first() == AbstractProjectItem::JobProgress) {
+            return;
+        }
+        QWriteLocker locker(&m_lock);
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+            const QModelIndex ix = index(row, 0, topLeft.parent());
+            if (ix.isValid() && m_searchIndex.count(int(ix.internalId())) > 0) {
+                updateSearchEntry(getBinItemByIndex(ix));
+            }
+        }
+    });
 }
 
 std::shared_ptr<ProjectItemModel> ProjectItemModel::construct(QObject *parent)
@@ -634,6 +648,7 @@ void ProjectItemModel::registerItem(const std::shared_ptr<TreeItem> &item)
     auto clip = std::static_pointer_cast<AbstractProjectItem>(item);
     m_binPlaylist->manageBinItemInsertion(clip);
     AbstractTreeModel::registerItem(item);
+    updateSearchEntry(clip);
     if (clip->itemType() == AbstractProjectItem::ClipItem) {
         auto clipItem = std::static_pointer_cast<ProjectClip>(clip);
         updateWatcher(clipItem);
@@ -646,12 +661,59 @@ void ProjectItemModel::deregisterItem(int id, TreeItem *item)
     m_binPlaylist->manageBinItemDeletion(clip);
     // TODO : here, we should suspend jobs belonging to the item we delete. They can be restarted if the item is reinserted by undo
     AbstractTreeModel::deregisterItem(id, item);
+    m_searchIndex.erase(id);
     if (clip->itemType() == AbstractProjectItem::ClipItem) {
         auto clipItem = static_cast<ProjectClip *>(clip);
         m_fileWatcher->removeFile(clipItem->clipId());
     }
 }
 
+void ProjectItemModel::updateSearchEntry(const std::shared_ptr<AbstractProjectItem> &item)
+{
+    SearchEntry &entry = m_searchIndex[item->getId()];
+    entry.name = item->getData(AbstractProjectItem::DataName).toString().toLower();
+    entry.date = item->getData(AbstractProjectItem::DataDate).toString().toLower();
+    entry.description = item->getData(AbstractProjectItem::DataDescription).toString().toLower();
+    entry.tags = item->getData(AbstractProjectItem::DataTag).toString().toLower();
+    entry.type = item->getData(AbstractProjectItem::ClipType).toInt();
+    entry.rating = item->getData(AbstractProjectItem::DataRating).toInt();
+    entry.usage = item->getData(AbstractProjectItem::UsageCount).toInt();
+}
+
+std::unordered_set<int> ProjectItemModel::searchItems(const QString &text, const QStringList &tags, int rating, int type, bool unused) const
+{
+    READ_LOCK();
+    std::unordered_set<int> accepted;
+    const int rootId = rootItem->getId();
+    for (const auto &entry : m_searchIndex) {
+        const SearchEntry &data = entry.second;
+        if ((unused && data.usage > 0) || (rating > 0 && data.rating != rating) || (type > 0 && data.type != type)) {
+            continue;
+        }
+        bool match = true;
+        for (const QString &tag : tags) {
+            if (!data.tags.contains(tag)) {
+                match = false;
+                break;
+            }
+        }
+        if (!match || (!text.isEmpty() && !data.name.contains(text) && !data.date.contains(text) && !data.description.contains(text))) {
+            continue;
+        }
+        // Parent folders are displayed when one of their children matches
+        int id = entry.first;
+        while (id != rootId && accepted.insert(id).second) {
+            auto item = m_allItems.count(id) > 0 ? m_allItems.at(id).lock() : nullptr;
+            auto parent = item ? item->parentItem().lock() : nullptr;
+            if (!parent) {
+                break;
+            }
+            id = parent->getId();
+        }
+    }
+    return accepted;
+}
+
 int ProjectItemModel::getFreeFolderId()
 {
     while (!isIdFree(QString::number(++m_nextId))) {
@@ -1059,6 +1121,7 @@ void ProjectItemModel::loadBinPlaylist(Mlt::Tractor *documentTractor, Mlt::Tract
                 if (!id) id = getFreeClipId();
                 binProducers.insert(id, producer);
             }
+            prefetchFileHashes(binProducers.values());
             // Do the real insertion
             QMapIterator<int, std::shared_ptr<Mlt::Producer> > i(binProducers);
             while (i.hasNext()) {
@@ -1078,6 +1141,47 @@ void ProjectItemModel::loadBinPlaylist(Mlt::Tractor *documentTractor, Mlt::Tract
     m_binPlaylist->setRetainIn(modelTractor);
 }
 
+void ProjectItemModel::prefetchFileHashes(const QList<std::shared_ptr<Mlt::Producer>> &producers)
+{
+    struct HashEntry
+    {
+        std::shared_ptr<Mlt::Producer> producer;
+        QString path;
+        QPair<QByteArray, qint64> hash;
+    };
+    QVector<HashEntry> entries;
+    for (const auto &producer : producers) {
+        if (producer->property_exists("kdenlive:file_hash")) {
+            continue;
+        }
+        const QString service = producer->get("mlt_service");
+        if (!service.startsWith(QLatin1String("avformat")) && service != QLatin1String("qimage") && service != QLatin1String("pixbuf") &&
+            service != QLatin1String("xml")) {
+            continue;
+        }
+        QString path = producer->get("kdenlive:originalurl");
+        if (path.isEmpty()) {
+            path = producer->get("resource");
+        }
+        // Relative and sequence paths are resolved by the clip itself
+        if (path.isEmpty() || QFileInfo(path).isRelative() || path.contains(QLatin1Char('%'))) {
+            continue;
+        }
+        entries.append({producer, path, {}});
+    }
+    if (entries.isEmpty()) {
+        return;
+    }
+    // Hashing reads up to 2MB per file, slow on network mounts, so do it concurrently before creating the clips
+    QtConcurrent::blockingMap(entries, [](HashEntry &entry) { entry.hash = ProjectClip::calculateHash(entry.path); });
+    for (const HashEntry &entry : qAsConst(entries)) {
+        if (!entry.hash.first.isEmpty()) {
+            entry.producer->set("kdenlive:file_hash", entry.hash.first.toHex().constData());
+            entry.producer->set("kdenlive:file_size", QString::number(entry.hash.second).toUtf8().constData());
+        }
+    }
+}
+
 /** @brief Save document properties in MLT's bin playlist */
 void ProjectItemModel::saveDocumentProperties(const QMap<QString, QString> &props, const QMap<QString, QString> &metadata,
                                               std::shared_ptr<MarkerListModel> guideModel)
@@ -32,6 +32,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QIcon>
 #include <QReadWriteLock>
 #include <QSize>
+#include <unordered_map>
+#include <unordered_set>
 
 class AbstractProjectItem;
 class BinPlaylist;
@@ -221,6 +223,11 @@ public:
     /** @brief Check if  a file is already in Bin */
     bool urlExists(const QString &path) const;
 
+    /** @brief Returns the ids of the items matching the bin filters and of their parent folders, in one pass over the search index.
+     *  @param text lowercase text to find in the item name, date or description
+     *  @param tags lowercase tags the item must all have */
+    std::unordered_set<int> searchItems(const QString &text, const QStringList &tags, int rating, int type, bool unused) const;
+
 protected:
     /** @brief Register the existence of a new element
      */
@@ -261,6 +268,23 @@ private:
     int m_nextId;
     QIcon m_blankThumb;
     PlaylistState::ClipState m_dragType;
+
+    /** @brief Lowercase searchable data of a bin item */
+    struct SearchEntry
+    {
+        QString name;
+        QString date;
+        QString description;
+        QString tags;
+        int type{0};
+        int rating{0};
+        int usage{0};
+    };
+    /** @brief Search data of the bin items by item id, kept in sync with the items */
+    std::unordered_map<int, SearchEntry> m_searchIndex;
+    void updateSearchEntry(const std::shared_ptr<AbstractProjectItem> &item);
+    /** @brief Compute the missing file hashes of the bin producers in parallel before the clips are created */
+    void prefetchFileHashes(const QList<std::shared_ptr<Mlt::Producer>> &producers);
 signals:
     /** @brief thumbs of the given clip were modified, request update of the monitor if need be */
     void refreshAudioThumbs(const QString &id);
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "projectsortproxymodel.h"
 #include "abstractprojectitem.h"
+#include "projectitemmodel.h"
 
 #include <QItemSelectionModel>
 
@@ -33,88 +34,44 @@ ProjectSortProxyModel::ProjectSortProxyModel(QObject *parent)
     m_selection = new QItemSelectionModel(this);
     connect(m_selection, &QItemSelectionModel::selectionChanged, this, &ProjectSortProxyModel::onCurrentRowChanged);
     setDynamicSortFilter(true);
+    m_searchTimer.setSingleShot(true);
+    m_searchTimer.setInterval(150);
+    connect(&m_searchTimer, &QTimer::timeout, this, &ProjectSortProxyModel::slotRefilter);
+    // Matches change when bin items are edited, added or removed
+    connect(this, &QAbstractProxyModel::sourceModelChanged, this, [this]() {
+        auto refresh = [this]() {
+            if (m_filterActive) {
+                m_searchTimer.start();
+            }
+        };
+        connect(sourceModel(), &QAbstractItemModel::dataChanged, this, refresh);
+        connect(sourceModel(), &QAbstractItemModel::rowsInserted, this, refresh);
+        connect(sourceModel(), &QAbstractItemModel::rowsRemoved, this, refresh);
+        slotRefilter();
+    });
 }
 
 // Responsible for item sorting!
 bool ProjectSortProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
-    if (filterAcceptsRowItself(sourceRow, sourceParent)) {
+    if (!m_filterActive) {
         return true;
     }
-    // accept if any of the children is accepted on it's own merits
-    return hasAcceptedChildren(sourceRow, sourceParent);
+    // Matching items and the folders containing them were collected by slotRefilter
+    QModelIndex item = sourceModel()->index(sourceRow, 0, sourceParent);
+    return item.isValid() && m_acceptedIds.count(int(item.internalId())) > 0;
 }
 
-bool ProjectSortProxyModel::filterAcceptsRowItself(int sourceRow, const QModelIndex &sourceParent) const
+void ProjectSortProxyModel::slotRefilter()
 {
-    if (m_unusedFilter) {
-        // Column 8 contains the usage
-        QModelIndex indexTag = sourceModel()->index(sourceRow, 8, sourceParent);
-        if (sourceModel()->data(indexTag).toInt() > 0) {
-            return false;
-        }
-    }
-    if (m_searchRating > 0) {
-        // Column 7 contains the rating
-        QModelIndex indexTag = sourceModel()->index(sourceRow, 7, sourceParent);
-        if (sourceModel()->data(indexTag).toInt() != m_searchRating) {
-            return false;
-        }
+    m_searchTimer.stop();
+    m_filterActive = !m_searchString.isEmpty() || !m_searchTag.isEmpty() || m_searchRating > 0 || m_searchType > 0 || m_unusedFilter;
+    m_acceptedIds.clear();
+    auto *model = qobject_cast<ProjectItemModel *>(sourceModel());
+    if (m_filterActive && model) {
+        m_acceptedIds = model->searchItems(m_searchString, m_searchTag, m_searchRating, m_searchType, m_unusedFilter);
     }
-    if (m_searchType > 0) {
-        // Column 3 contains the item type (video, image, title, etc)
-        QModelIndex indexTag = sourceModel()->index(sourceRow, 3, sourceParent);
-        if (sourceModel()->data(indexTag).toInt() != m_searchType) {
-            return false;
-        }
-    }
-    if (!m_searchTag.isEmpty()) {
-        // Column 4 contains the item tag data
-        QModelIndex indexTag = sourceModel()->index(sourceRow, 4, sourceParent);
-        auto tagData = sourceModel()->data(indexTag);
-        for (const QString &tag : m_searchTag) {
-            if (!tagData.toString().contains(tag, Qt::CaseInsensitive)) {
-                return false;
-            }
-        }
-    }
-
-    for (int i = 0; i < 3; i++) {
-        QModelIndex index0 = sourceModel()->index(sourceRow, i, sourceParent);
-        if (!index0.isValid()) {
-            return false;
-        }
-        auto data = sourceModel()->data(index0);
-        if (data.toString().contains(m_searchString, Qt::CaseInsensitive)) {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool ProjectSortProxyModel::hasAcceptedChildren(int sourceRow, const QModelIndex &source_parent) const
-{
-    QModelIndex item = sourceModel()->index(sourceRow, 0, source_parent);
-    if (!item.isValid()) {
-        return false;
-    }
-
-    // check if there are children
-    int childCount = item.model()->rowCount(item);
-    if (childCount == 0) {
-        return false;
-    }
-
-    for (int i = 0; i < childCount; ++i) {
-        if (filterAcceptsRowItself(i, item)) {
-            return true;
-        }
-        // recursive call -> NOTICE that this is depth-first searching, you're probably better off with breadth first search...
-        if (hasAcceptedChildren(i, item)) {
-            return true;
-        }
-    }
-    return false;
+    invalidateFilter();
 }
 
 bool ProjectSortProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
@@ -147,17 +104,21 @@ QItemSelectionModel *ProjectSortProxyModel::selectionModel()
 
 void ProjectSortProxyModel::slotSetSearchString(const QString &str)
 {
-    m_searchString = str;
-    invalidateFilter();
+    // Wait for the user to stop typing before searching
+    m_searchString = str.toLower();
+    m_searchTimer.start();
 }
 
 void ProjectSortProxyModel::slotSetFilters(const QStringList tagFilters, const int rateFilters, const int typeFilters, bool unusedFilter)
 {
     m_searchType = typeFilters;
     m_searchRating = rateFilters;
-    m_searchTag = tagFilters;
+    m_searchTag.clear();
+    for (const QString &tag : tagFilters) {
+        m_searchTag << tag.toLower();
+    }
     m_unusedFilter = unusedFilter;
-    invalidateFilter();
+    slotRefilter();
 }
 
 void ProjectSortProxyModel::slotClearSearchFilters()
@@ -166,7 +127,7 @@ void ProjectSortProxyModel::slotClearSearchFilters()
     m_searchRating = 0;
     m_searchType = 0;
     m_unusedFilter = false;
-    invalidateFilter();
+    slotRefilter();
 }
 
 void ProjectSortProxyModel::onCurrentRowChanged(const QItemSelection &current, const QItemSelection &previous)
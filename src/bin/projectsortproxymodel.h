@@ -24,6 +24,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QCollator>
 #include <QSortFilterProxyModel>
+#include <QTimer>
+#include <unordered_set>
 
 class QItemSelectionModel;
 
@@ -54,6 +56,8 @@ public slots:
 private slots:
     /** @brief Called when a row change is detected by selection model */
     void onCurrentRowChanged(const QItemSelection &current, const QItemSelection &previous);
+    /** @brief Query the bin search index for the current filters and update the view */
+    void slotRefilter();
 
 protected:
     /** @brief Decide which items should be displayed depending on the search string  */
@@ -61,8 +65,6 @@ protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
     /** @brief Reimplemented to show folders first  */
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
-    bool filterAcceptsRowItself(int source_row, const QModelIndex &source_parent) const;
-    bool hasAcceptedChildren(int source_row, const QModelIndex &source_parent) const;
 
 private:
     QItemSelectionModel *m_selection;
@@ -72,6 +74,12 @@ private:
     int m_searchRating{0};
     bool m_unusedFilter{false};
     QCollator m_collator;
+    /** @brief True if any search filter is set */
+    bool m_filterActive{false};
+    /** @brief Ids of the matching items and their parent folders */
+    std::unordered_set<int> m_acceptedIds;
+    /** @brief Delays the search while the user is typing */
+    QTimer m_searchTimer;
 
 signals:
     /** @brief Emitted when the row changes, used to prepare action for selected item  */
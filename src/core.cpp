@@ -120,6 +120,7 @@ void Core::initGUI(bool isAppImage, const QString &MltPath, const QUrl &Url, con
 {
     m_profile = KdenliveSettings::default_profile();
     m_currentProfile = m_profile;
+    m_currentTimebase = 0;
     m_mainWindow = new MainWindow();
     m_guiConstructed = true;
     QStringList styles = QQuickStyle::availableStyles();
@@ -387,11 +388,13 @@ bool Core::setCurrentProfile(const QString &profilePath)
 {
     if (m_currentProfile == profilePath) {
         // no change required, ensure timecode has correct fps
+        m_currentTimebase = 0;
         m_timecode.setFormat(getCurrentProfile()->fps());
         return true;
     }
     if (ProfileRepository::get()->profileExists(profilePath)) {
         m_currentProfile = profilePath;
+        m_currentTimebase = 0;
         m_thumbProfile.reset();
         if (m_projectProfile) {
             m_projectProfile->set_colorspace(getCurrentProfile()->colorspace());
@@ -443,7 +446,27 @@ double Core::getCurrentDar() const
 
 double Core::getCurrentFps() const
 {
-    return getCurrentProfile()->fps();
+    std::pair<int, int> timebase = getCurrentTimebase();
+    return double(timebase.first) / timebase.second;
+}
+
+std::pair<int, int> Core::getCurrentTimebase() const
+{
+    quint64 packed = m_currentTimebase.load();
+    int revision = ProfileRepository::revision();
+    if (packed == 0 || m_timebaseRevision.load() != revision) {
+        // Avoid the profile lookup in the repository on each call. The cache is reset when the current profile changes,
+        // and recomputed when the profiles are reloaded, since the current profile may have been edited
+        int num = getCurrentProfile()->frame_rate_num();
+        int den = getCurrentProfile()->frame_rate_den();
+        if (num <= 0 || den <= 0) {
+            return {25, 1};
+        }
+        packed = (quint64(quint32(num)) << 32) | quint32(den);
+        m_currentTimebase.store(packed);
+        m_timebaseRevision.store(revision);
+    }
+    return {int(packed >> 32), int(packed & 0xffffffff)};
 }
 
 
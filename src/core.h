@@ -19,6 +19,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include <QObject>
 #include <QColor>
 #include <QUrl>
+#include <atomic>
 #include <memory>
 #include <QPoint>
 #include <QThreadPool>
@@ -148,6 +149,8 @@ public:
 
     /** @brief Returns frame rate of current profile */
     double getCurrentFps() const;
+    /** @brief Returns frame rate of current profile as numerator and denominator. The value is cached, so it is cheap to call in loops */
+    std::pair<int, int> getCurrentTimebase() const;
 
     /** @brief Returns the frame size (width x height) of current profile */
     QSize getCurrentFrameSize() const;
@@ -289,6 +292,10 @@ private:
 
     /** @brief Current project's profile path */
     QString m_currentProfile;
+    /** @brief Frame rate numerator and denominator of the current profile packed in one value, 0 if not computed yet */
+    mutable std::atomic<quint64> m_currentTimebase{0};
+    /** @brief Revision of the profile repository when m_currentTimebase was computed */
+    mutable std::atomic<int> m_timebaseRevision{-1};
 
     QString m_profile;
     Timecode m_timecode;
@@ -211,6 +211,9 @@ KdenliveSettingsDialog::KdenliveSettingsDialog(QMap<QString, QString> mappable_a
     connect(m_configEnv.kcfg_librarytodefaultfolder, &QAbstractButton::clicked, this, &KdenliveSettingsDialog::slotEnableLibraryFolder);
 
     m_configEnv.kcfg_proxythreads->setMaximum(qMax(1, QThread::idealThreadCount() - 1));
+    m_configEnv.kcfg_previewworkers->setMaximum(qMax(1, QThread::idealThreadCount()));
+    m_configEnv.kcfg_renderjobs->setMaximum(qMax(1, QThread::idealThreadCount()));
+    m_configEnv.kcfg_renderthreads->setMaximum(qMax(1, QThread::idealThreadCount()));
 
     // Script rendering folder
     m_configEnv.videofolderurl->setMode(KFile::Directory);
@@ -66,7 +66,9 @@
 #include <PurposeWidgets/Menu>
 #endif
 
+#include <algorithm>
 #include <locale>
+#include <numeric>
 #ifdef Q_OS_MAC
 #include <xlocale.h>
 #endif
@@ -96,7 +98,11 @@ enum {
     ProgressRole,
     ExtraInfoRole = ProgressRole + 2, // vpinon: don't understand why, else spurious message displayed
     LastTimeRole,
-    LastFrameRole
+    LastFrameRole,
+    FramesRole,
+    ThreadsRole,
+    MemoryRole,
+    SkippedRole
 };
 
 // Running job status
@@ -365,6 +371,14 @@ RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
         // Disable parallel rendering for movit
         m_view.parallel_process->setEnabled(false);
     }
+    m_view.render_segments->setChecked(KdenliveSettings::rendersegmented());
+    m_view.render_segment_count->setValue(KdenliveSettings::rendersegments());
+    m_view.render_segment_count->setEnabled(KdenliveSettings::rendersegmented());
+    connect(m_view.render_segments, &QCheckBox::toggled, this, [this](bool checked) {
+        KdenliveSettings::setRendersegmented(checked);
+        m_view.render_segment_count->setEnabled(checked);
+    });
+    connect(m_view.render_segment_count, QOverload<int>::of(&QSpinBox::valueChanged), [](int value) { KdenliveSettings::setRendersegments(value); });
     m_view.field_order->setEnabled(false);
     connect(m_view.scanning_list, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) { m_view.field_order->setEnabled(index == 2); });
     loadConfig();
@@ -1622,6 +1636,46 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, const QString &playlist
         file.close();
     }
 
+    // Segmented rendering, the renderer encodes each segment in its own process and joins them without re-encoding
+    QStringList segmentArgs;
+    int segmentCount = 1;
+    if (passes == 1 && m_view.render_segments->isChecked() && canRenderSegments(consumer, renderedFile)) {
+        QList<int> guides;
+        const QList<CommentedTime> guidesList = project->getGuideModel()->getAllMarkers();
+        for (const CommentedTime &guide : guidesList) {
+            guides << guide.time().frames(profile->fps());
+        }
+        // Each segment is encoded by its own process, don't start more of them than the render threads allow
+        const int segmentThreads = qMax(threadCount, KdenliveSettings::encodethreads());
+        const int maxSegments = maxRenderThreads() / qMax(1, segmentThreads) - (exportAudio ? 1 : 0);
+        const QList<int> boundaries = segmentBoundaries(in, out, qMin(m_view.render_segment_count->value(), maxSegments),
+                                                        consumer.attribute(QStringLiteral("g")).toInt(), guides, int(profile->fps()));
+        if (!boundaries.isEmpty()) {
+            QStringList starts;
+            for (int frame : boundaries) {
+                starts << QString::number(frame);
+            }
+            segmentArgs << QStringLiteral("-segments:%1").arg(starts.join(QLatin1Char(','))) << QStringLiteral("-ffmpeg:%1").arg(KdenliveSettings::ffmpegpath());
+            segmentCount = boundaries.size() + 1;
+        }
+    }
+
+    // Estimate the resources used by the job so that the queue knows how many jobs can run together
+    const int jobProcesses = segmentCount > 1 && exportAudio ? segmentCount + 1 : segmentCount;
+    QSize frameSize(profile->width(), profile->height());
+    if (!subsize.isEmpty()) {
+        frameSize = QSize(subsize.section(QLatin1Char('x'), 0, 0).toInt(), subsize.section(QLatin1Char('x'), 1, 1).toInt());
+    }
+    // Each process buffers about 25 frames plus the ones being processed by its threads, on top of its decoders
+    const qint64 frameBytes = qint64(frameSize.width()) * frameSize.height() * 4;
+    const int jobMemory = int(jobProcesses * (256 + frameBytes * (25 + 2 * threadCount) / 1048576));
+    const int jobThreads = jobProcesses * qMax(threadCount, KdenliveSettings::encodethreads());
+    auto setJobResources = [&](RenderJobItem *item) {
+        item->setData(1, FramesRole, out - in + 1);
+        item->setData(1, ThreadsRole, jobThreads);
+        item->setData(1, MemoryRole, jobMemory);
+    };
+
     // Create job
     RenderJobItem *renderItem = nullptr;
     QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(renderedFile, Qt::MatchExactly, 1);
@@ -1643,7 +1697,9 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, const QString &playlist
             renderItem->setData(1, Qt::UserRole, i18n("Waiting..."));
             QStringList argsJob = {KdenliveSettings::rendererpath(), playlistPath, renderedFile,
                                    QStringLiteral("-pid:%1").arg(QCoreApplication::applicationPid()),QStringLiteral("-out"),QString::number(out)};
+            argsJob << segmentArgs;
             renderItem->setData(1, ParametersRole, argsJob);
+            setJobResources(renderItem);
             QDateTime t = QDateTime::currentDateTime();
             renderItem->setData(1, StartTimeRole, t);
             renderItem->setData(1, LastTimeRole, t);
@@ -1671,7 +1727,9 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, const QString &playlist
         renderItem->setData(1, LastTimeRole, t);
         renderItem->setData(1, LastFrameRole, in);
         QStringList argsJob = {KdenliveSettings::rendererpath(), pl, renderedFile, QStringLiteral("-pid:%1").arg(QCoreApplication::applicationPid()),QStringLiteral("-out"),QString::number(out)};
+        argsJob << segmentArgs;
         renderItem->setData(1, ParametersRole, argsJob);
+        setJobResources(renderItem);
         qDebug() << "* CREATED JOB WITH ARGS: " << argsJob;
         if (!exportAudio) {
             renderItem->setData(1, ExtraInfoRole, i18n("Video without audio track"));
@@ -1729,52 +1787,156 @@ void RenderWidget::checkRenderStatus()
         return;
     }
 
+    // Resources used by the running jobs
+    int runningJobs = 0;
+    int usedThreads = 0;
+    int usedMemory = 0;
+    QStringList busyFiles;
     auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
-
-    // Make sure no other rendering is running
     while (item != nullptr) {
-        if (item->status() == RUNNINGJOB) {
-            return;
+        if (item->status() == RUNNINGJOB || item->status() == STARTINGJOB) {
+            runningJobs++;
+            usedThreads += qMax(1, item->data(1, ThreadsRole).toInt());
+            usedMemory += item->data(1, MemoryRole).toInt();
+            busyFiles << item->text(1);
         }
         item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
-    item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+    const int maxJobs = qMax(1, KdenliveSettings::renderjobs());
+    const int maxThreads = maxRenderThreads();
+    const int maxMemory = KdenliveSettings::rendermemory();
     bool waitingJob = false;
 
-    // Find first waiting job
-    while (item != nullptr) {
-        if (item->status() == WAITINGJOB) {
-            QDateTime t = QDateTime::currentDateTime();
-            item->setData(1, StartTimeRole, t);
-            item->setData(1, LastTimeRole, t);
-            waitingJob = true;
-            startRendering(item);
-            // Check for 2 pass encoding
-            QStringList jobData = item->data(1, ParametersRole).toStringList();
-            if (jobData.size() > 2 && jobData.at(1).endsWith(QStringLiteral("-pass2.mlt"))) {
-                // Find and remove 1st pass job
-                QTreeWidgetItem *above = m_view.running_jobs->itemAbove(item);
-                QString firstPassName = jobData.at(1).section(QLatin1Char('-'), 0, -2) + QStringLiteral(".mlt");
-                while (above) {
-                    QStringList aboveData = above->data(1, ParametersRole).toStringList();
-                    qDebug() << "// GOT  JOB: " << aboveData.at(1);
-                    if (aboveData.size() > 2 && aboveData.at(1) == firstPassName) {
-                        delete above;
-                        break;
+    // Number of shorter jobs that may start before a waiting job, after that the resources are reserved for it
+    const int maxSkips = 2;
+
+    while (runningJobs < maxJobs) {
+        // Start jobs in queue order. When the first waiting job does not fit in the remaining resources, let a shorter one run in between
+        RenderJobItem *firstWaiting = nullptr;
+        RenderJobItem *next = nullptr;
+        item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+        while (item != nullptr && next == nullptr) {
+            // Passes of a 2 pass render write the same file and have to run one after the other
+            if (item->status() == WAITINGJOB && !busyFiles.contains(item->text(1))) {
+                waitingJob = true;
+                const bool fits = runningJobs == 0 || (usedThreads + qMax(1, item->data(1, ThreadsRole).toInt()) <= maxThreads &&
+                                                       (maxMemory <= 0 || usedMemory + item->data(1, MemoryRole).toInt() <= maxMemory));
+                if (firstWaiting == nullptr) {
+                    firstWaiting = item;
+                    if (fits) {
+                        next = item;
                     }
-                    above = m_view.running_jobs->itemAbove(above);
+                } else if (fits && firstWaiting->data(1, SkippedRole).toInt() < maxSkips &&
+                           item->data(1, FramesRole).toInt() < firstWaiting->data(1, FramesRole).toInt()) {
+                    next = item;
                 }
             }
-            item->setStatus(STARTINGJOB);
+            item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
+        }
+        if (next == nullptr) {
             break;
         }
-        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
+        if (next != firstWaiting) {
+            firstWaiting->setData(1, SkippedRole, firstWaiting->data(1, SkippedRole).toInt() + 1);
+        }
+        item = next;
+        QDateTime t = QDateTime::currentDateTime();
+        item->setData(1, StartTimeRole, t);
+        item->setData(1, LastTimeRole, t);
+        startRendering(item);
+        // Check for 2 pass encoding
+        QStringList jobData = item->data(1, ParametersRole).toStringList();
+        if (jobData.size() > 2 && jobData.at(1).endsWith(QStringLiteral("-pass2.mlt"))) {
+            // Find and remove 1st pass job
+            QTreeWidgetItem *above = m_view.running_jobs->itemAbove(item);
+            QString firstPassName = jobData.at(1).section(QLatin1Char('-'), 0, -2) + QStringLiteral(".mlt");
+            while (above) {
+                QStringList aboveData = above->data(1, ParametersRole).toStringList();
+                qDebug() << "// GOT  JOB: " << aboveData.at(1);
+                if (aboveData.size() > 2 && aboveData.at(1) == firstPassName) {
+                    delete above;
+                    break;
+                }
+                above = m_view.running_jobs->itemAbove(above);
+            }
+        }
+        item->setStatus(STARTINGJOB);
+        runningJobs++;
+        usedThreads += qMax(1, item->data(1, ThreadsRole).toInt());
+        usedMemory += item->data(1, MemoryRole).toInt();
+        busyFiles << item->text(1);
     }
-    if (!waitingJob && m_view.shutdown->isChecked()) {
-        emit shutdown();
+    if (runningJobs == 0 && !waitingJob) {
+        if (m_queueReport.size() > 1) {
+            // Summary of the jobs rendered since the queue was last idle
+            qCDebug(KDENLIVE_LOG) << "Render queue finished:";
+            for (const QString &line : qAsConst(m_queueReport)) {
+                qCDebug(KDENLIVE_LOG) << line;
+            }
+            QString duration = i18np("1 second", "%1 seconds", m_queueStart.secsTo(QDateTime::currentDateTime()));
+            pCore->displayMessage(i18np("%1 render job finished in %2", "%1 render jobs finished in %2", m_queueReport.size(), duration), InformationMessage);
+        }
+        m_queueReport.clear();
+        if (m_view.shutdown->isChecked()) {
+            emit shutdown();
+        }
     }
 }
 
+bool RenderWidget::canRenderSegments(const QDomElement &consumer, const QString &renderedFile) const
+{
+    if (KdenliveSettings::ffmpegpath().isEmpty() || consumer.attribute(QStringLiteral("vn")) == QLatin1String("1") ||
+        !consumer.hasAttribute(QStringLiteral("vcodec")) || m_view.advanced_params->toPlainText().contains(QLatin1String("=stills/"))) {
+        return false;
+    }
+    // Containers where video streams can be joined with the concat demuxer without re-encoding
+    static const QStringList concatFormats = {QStringLiteral("mp4"), QStringLiteral("m4v"),  QStringLiteral("mov"), QStringLiteral("mkv"),
+                                              QStringLiteral("webm"), QStringLiteral("ts"), QStringLiteral("m2ts"), QStringLiteral("mts")};
+    return concatFormats.contains(QFileInfo(renderedFile).suffix().toLower());
+}
+
+int RenderWidget::maxRenderThreads()
+{
+    return KdenliveSettings::renderthreads() > 0 ? KdenliveSettings::renderthreads() : QThread::idealThreadCount();
+}
+
+QList<int> RenderWidget::segmentBoundaries(int in, int out, int count, int gop, const QList<int> &guides, int fps)
+{
+    QList<int> boundaries;
+    // Don't bother splitting renders where each segment would last less than 10 seconds
+    const int length = out - in + 1;
+    const int minLength = qMax(1, 10 * fps);
+    count = qMin(count, length / minLength);
+    if (count < 2) {
+        return boundaries;
+    }
+    const int segmentLength = length / count;
+    int previous = in;
+    for (int i = 1; i < count; ++i) {
+        const int ideal = in + int(qint64(length) * i / count);
+        // Prefer cutting on a guide close to the ideal position
+        int frame = -1;
+        for (int guide : guides) {
+            if (qAbs(guide - ideal) <= segmentLength / 4 && (frame < 0 || qAbs(guide - ideal) < qAbs(frame - ideal))) {
+                frame = guide;
+            }
+        }
+        if (frame < 0) {
+            frame = ideal;
+            if (gop > 1) {
+                // Keep the keyframe interval of a single pass render
+                frame = in + qRound(double(frame - in) / gop) * gop;
+            }
+        }
+        if (frame - previous < minLength / 2 || out - frame < minLength / 2) {
+            continue;
+        }
+        boundaries << frame;
+        previous = frame;
+    }
+    return boundaries;
+}
+
 void RenderWidget::startRendering(RenderJobItem *item)
 {
     auto rendererArgs = item->data(1, ParametersRole).toStringList();
@@ -2571,7 +2733,15 @@ void RenderWidget::setRenderStatus(const QString &dest, int status, const QStrin
         QString est = (days > 0) ? i18np("%1 day ", "%1 days ", days) : QString();
         est.append(when.toString(QStringLiteral("hh:mm:ss")));
         QString t = i18n("Rendering finished in %1", est);
+        int frames = item->data(1, FramesRole).toInt();
+        if (frames > 0 && elapsedTime > 0) {
+            t = i18n("Rendering finished in %1 (%2 fps)", est, QString::number(double(frames) / elapsedTime, 'f', 1));
+        }
         item->setData(1, Qt::UserRole, t);
+        if (m_queueReport.isEmpty() || startTime < m_queueStart) {
+            m_queueStart = startTime;
+        }
+        m_queueReport << QStringLiteral("%1: %2 frames in %3s, %4 fps").arg(dest).arg(frames).arg(elapsedTime).arg(elapsedTime > 0 ? double(frames) / elapsedTime : 0., 0, 'f', 1);
 
 #ifdef KF5_USE_PURPOSE
         m_shareMenu->model()->setInputData(QJsonObject{{QStringLiteral("mimeType"), QMimeDatabase().mimeTypeForFile(item->text(1)).name()},
@@ -2933,15 +3103,57 @@ bool RenderWidget::startWaitingRenderJobs()
 #ifndef Q_OS_WIN
     outStream << "#!/bin/sh\n\n";
 #endif
+    // Jobs writing the same file (2 pass renders) stay together and in order
+    QStringList jobFiles;
+    QVector<QStringList> jobCommands;
+    QVector<qint64> jobFrames;
     auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
     while (item != nullptr) {
         if (item->status() == WAITINGJOB) {
             // Add render process for item
             const QString params = item->data(1, ParametersRole).toStringList().join(QLatin1Char(' '));
-            outStream << '\"' << m_renderer << "\" " << params << '\n';
+            int ix = jobFiles.indexOf(item->text(1));
+            if (ix < 0) {
+                ix = jobFiles.size();
+                jobFiles << item->text(1);
+                jobCommands.append(QStringList());
+                jobFrames.append(0);
+            }
+            jobCommands[ix] << QStringLiteral("\"%1\" %2").arg(m_renderer, params);
+            jobFrames[ix] += qMax(1, item->data(1, FramesRole).toInt());
         }
         item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
+#ifndef Q_OS_WIN
+    const int laneCount = qMax(1, qMin(KdenliveSettings::renderjobs(), jobFiles.size()));
+#else
+    const int laneCount = 1;
+#endif
+    // Distribute the jobs on the lanes run in parallel, longest jobs first on the least loaded lane
+    QVector<int> order(jobFiles.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&jobFrames](int a, int b) { return jobFrames.at(a) > jobFrames.at(b); });
+    QVector<QStringList> lanes(laneCount);
+    QVector<qint64> laneFrames(laneCount, 0);
+    for (int ix : qAsConst(order)) {
+        const int lane = int(std::min_element(laneFrames.constBegin(), laneFrames.constEnd()) - laneFrames.constBegin());
+        lanes[lane] << jobCommands.at(ix);
+        laneFrames[lane] += jobFrames.at(ix);
+    }
+    if (laneCount == 1) {
+        for (const QString &command : qAsConst(lanes.first())) {
+            outStream << command << '\n';
+        }
+    } else {
+        for (const QStringList &lane : qAsConst(lanes)) {
+            outStream << "(\n";
+            for (const QString &command : lane) {
+                outStream << command << '\n';
+            }
+            outStream << ") &\n";
+        }
+        outStream << "wait\n";
+    }
 // erase itself when rendering is finished
 #ifndef Q_OS_WIN
     outStream << "rm \"" << autoscriptFile << "\"\n";
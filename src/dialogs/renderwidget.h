@@ -22,6 +22,7 @@
 
 #include <KMessageWidget>
 
+#include <QDateTime>
 #include <QPainter>
 #include <QPushButton>
 #include <QStyledItemDelegate>
@@ -216,6 +217,9 @@ private:
     RenderViewDelegate *m_jobsDelegate;
     bool m_blockProcessing;
     QString m_renderer;
+    /** @brief Throughput of the jobs finished since the render queue was last idle. */
+    QStringList m_queueReport;
+    QDateTime m_queueStart;
     KMessageWidget *m_infoMessage;
     KMessageWidget *m_jobInfoMessage;
     QMap<int, QString> m_errorMessages;
@@ -232,6 +236,13 @@ private:
     /** @brief Check if a job needs to be started. */
     void checkRenderStatus();
     void startRendering(RenderJobItem *item);
+    /** @brief Check if the rendered container allows joining separately encoded video segments without re-encoding. */
+    bool canRenderSegments(const QDomElement &consumer, const QString &renderedFile) const;
+    /** @brief Returns the first frame of each segment after the first one, snapped to a nearby guide or to the keyframe interval @param gop.
+     *  An empty list means the range is too short to be split. */
+    static QList<int> segmentBoundaries(int in, int out, int count, int gop, const QList<int> &guides, int fps);
+    /** @brief Returns the number of threads the running render jobs may use. */
+    static int maxRenderThreads();
     bool saveProfile(QDomElement newprofile);
     /** @brief Create a rendering profile from MLT preset. */
     QTreeWidgetItem *loadFromMltPreset(const QString &groupName, const QString &path, const QString &profileName);
@@ -24,6 +24,7 @@
 #include "kthumb.h"
 #include "titler/titlewidget.h"
 #include "bin/projectclip.h"
+#include "mediasearchindex.h"
 
 #include <KMessageBox>
 #include <KRecentDirs>
@@ -31,12 +32,14 @@
 #include <klocalizedstring.h>
 
 #include "kdenlive_debug.h"
-#include <QCryptographicHash>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileDialog>
 #include <QFontDatabase>
+#include <QFutureWatcher>
 #include <QStandardPaths>
 #include <QTreeWidgetItem>
+#include <QtConcurrent>
 #include <utility>
 #include <kurlrequester.h>
 
@@ -83,6 +86,88 @@ QMap<QString, QString> DocumentChecker::getLumaPairs() const
     return lumaSearchPairs;
 }
 
+void DocumentChecker::prefetchFileStatus(const QDomNodeList &producers, const QString &root)
+{
+    struct FileStatus
+    {
+        QString path;
+        bool needsHash;
+        bool exists;
+        QByteArray hash;
+    };
+    QVector<FileStatus> files;
+    QHash<QString, int> listed;
+    auto addFile = [&files, &listed, &root](QString path, bool needsHash) {
+        if (path.length() < 2) {
+            return;
+        }
+        if (QFileInfo(path).isRelative()) {
+            path.prepend(root);
+        }
+        auto it = listed.constFind(path);
+        if (it == listed.constEnd()) {
+            listed.insert(path, files.size());
+            files.append({path, needsHash, false, QByteArray()});
+        } else if (needsHash) {
+            files[it.value()].needsHash = true;
+        }
+    };
+    const int max = producers.count();
+    for (int i = 0; i < max; ++i) {
+        QDomElement e = producers.item(i).toElement();
+        const QString service = Xml::getXmlProperty(e, QStringLiteral("mlt_service"));
+        QString resource = Xml::getXmlProperty(e, QStringLiteral("resource"));
+        if (service == QLatin1String("timewarp")) {
+            resource = Xml::getXmlProperty(e, QStringLiteral("warp_resource"));
+        } else if (service == QLatin1String("framebuffer")) {
+            resource = resource.section(QLatin1Char('?'), 0, 0);
+        }
+        const QString proxy = Xml::getXmlProperty(e, QStringLiteral("kdenlive:proxy"));
+        // Only prefetch the hashes that hasErrorInClips compares: unproxied files that are not slideshows
+        const bool slideshow = (resource.contains(QStringLiteral("/.all.")) || resource.contains(QLatin1Char('?')) || resource.contains(QLatin1Char('%'))) &&
+                               Xml::hasXmlProperty(e, QStringLiteral("ttl"));
+        bool needsHash = service.startsWith(QLatin1String("avformat")) && proxy.length() < 2 && !slideshow &&
+                         Xml::hasXmlProperty(e, QStringLiteral("kdenlive:file_hash"));
+        addFile(resource, needsHash);
+        addFile(proxy, false);
+        addFile(Xml::getXmlProperty(e, QStringLiteral("kdenlive:originalurl")), false);
+    }
+    // File systems like network mounts are slow to query, so run the checks concurrently
+    QtConcurrent::blockingMap(files, [](FileStatus &file) {
+        file.exists = QFile::exists(file.path);
+        if (file.exists && file.needsHash) {
+            file.hash = ProjectClip::calculateHash(file.path).first;
+        }
+    });
+    m_fileExists.clear();
+    m_fileHashes.clear();
+    m_fileExists.reserve(files.size());
+    for (const FileStatus &file : qAsConst(files)) {
+        m_fileExists.insert(file.path, file.exists);
+        if (!file.hash.isEmpty()) {
+            m_fileHashes.insert(file.path, file.hash);
+        }
+    }
+}
+
+bool DocumentChecker::fileExists(const QString &path) const
+{
+    auto it = m_fileExists.constFind(path);
+    if (it != m_fileExists.constEnd()) {
+        return it.value();
+    }
+    return QFile::exists(path);
+}
+
+QByteArray DocumentChecker::fileHash(const QString &path) const
+{
+    auto it = m_fileHashes.constFind(path);
+    if (it != m_fileHashes.constEnd()) {
+        return it.value();
+    }
+    return ProjectClip::calculateHash(path).first;
+}
+
 bool DocumentChecker::hasErrorInClips()
 {
     int max;
@@ -147,11 +232,12 @@ bool DocumentChecker::hasErrorInClips()
     m_missingFonts.clear();
     m_changedClips.clear();
     max = documentProducers.count();
-    QStringList verifiedPaths;
-    QStringList missingPaths;
+    QSet<QString> verifiedPaths;
+    QSet<QString> missingPaths;
     QStringList serviceToCheck;
     serviceToCheck << QStringLiteral("kdenlivetitle") << QStringLiteral("qimage") << QStringLiteral("pixbuf") << QStringLiteral("timewarp")
                    << QStringLiteral("framebuffer") << QStringLiteral("xml") << QStringLiteral("qtext");
+    prefetchFileStatus(documentProducers, root);
     for (int i = 0; i < max; ++i) {
         QDomElement e = documentProducers.item(i).toElement();
         QString service = Xml::getXmlProperty(e, QStringLiteral("mlt_service"));
@@ -187,7 +273,7 @@ bool DocumentChecker::hasErrorInClips()
                 if (QFileInfo(resource).isRelative()) {
                     resource.prepend(root);
                 }
-                if (QFile::exists(resource)) {
+                if (fileExists(resource)) {
                     // Reset to original service
                     Xml::removeXmlProperty(e, QStringLiteral("text"));
                     QString original_service = Xml::getXmlProperty(e, QStringLiteral("kdenlive:orig_service"));
@@ -252,7 +338,7 @@ bool DocumentChecker::hasErrorInClips()
             if (QFileInfo(proxy).isRelative()) {
                 proxy.prepend(root);
             }
-            if (!QFile::exists(proxy)) {
+            if (!fileExists(proxy)) {
                 // Missing clip found
                 // Check if proxy exists in current storage folder
                 bool fixed = false;
@@ -278,7 +364,7 @@ bool DocumentChecker::hasErrorInClips()
             if (slideshow && Xml::hasXmlProperty(e, QStringLiteral("ttl"))) {
                 original = QFileInfo(original).absolutePath();
             }
-            if (!QFile::exists(original)) {
+            if (!fileExists(original)) {
                 if (!proxyFound) {
                     // Neither proxy nor original file found
                     m_missingClips.append(e);
@@ -286,11 +372,11 @@ bool DocumentChecker::hasErrorInClips()
                     // clip has proxy but original clip is missing
                     missingSources.append(e);
                 }
-                missingPaths.append(original);
+                missingPaths.insert(original);
             } else if (!proxyFound) {
                 missingProxies.append(e);
             }
-            verifiedPaths.append(resource);
+            verifiedPaths.insert(resource);
             continue;
         }
         // Check for slideshows
@@ -311,18 +397,18 @@ bool DocumentChecker::hasErrorInClips()
                 slideshow = false;
             }
         }
-        if (!QFile::exists(resource)) {
+        if (!fileExists(resource)) {
             if (service == QLatin1String("timewarp") && proxy == QLatin1String("-")) {
                 // In some corrupted cases, clips with speed effect kept a reference to proxy clip in warp_resource
                 QString original = Xml::getXmlProperty(e, QStringLiteral("kdenlive:originalurl"));
                 if (QFileInfo(original).isRelative()) {
                     original.prepend(root);
                 }
-                if (original != resource && QFile::exists(original)) {
+                if (original != resource && fileExists(original)) {
                     // Fix timewarp producer
                     Xml::setXmlProperty(e, QStringLiteral("warp_resource"), original);
                     Xml::setXmlProperty(e, QStringLiteral("resource"), Xml::getXmlProperty(e, QStringLiteral("warp_speed")) + QStringLiteral(":") + original);
-                    verifiedPaths.append(original);
+                    verifiedPaths.insert(original);
                     continue;
                 }
             }
@@ -331,13 +417,13 @@ bool DocumentChecker::hasErrorInClips()
                 // This is a timeline preview missing chunk, ignore
             } else {
                 m_missingClips.append(e);
-                missingPaths.append(resource);
+                missingPaths.insert(resource);
             }
         } else if (service.startsWith(QLatin1String("avformat")) || slideshow) {
             // Check if file changed
             const QByteArray hash = Xml::getXmlProperty(e, "kdenlive:file_hash").toLatin1();
             if (!hash.isEmpty()) {
-                const QByteArray fileData = slideshow ? ProjectClip::getFolderHash(QDir(resource), slidePattern).toHex() : ProjectClip::calculateHash(resource).first.toHex();
+                const QByteArray fileData = slideshow ? ProjectClip::getFolderHash(QDir(resource), slidePattern).toHex() : fileHash(resource).toHex();
                 if (hash != fileData) {
                     // For slideshow clips, silently upgrade hash
                     if (slideshow) {
@@ -351,7 +437,7 @@ bool DocumentChecker::hasErrorInClips()
             }
         }
         // Make sure we don't query same path twice
-        verifiedPaths.append(producerResource);
+        verifiedPaths.insert(producerResource);
     }
 
     // Get list of used Luma files
@@ -837,6 +923,9 @@ void DocumentChecker::slotCheckClips()
 {
     if (m_checkRunning) {
         m_abortSearch = true;
+        if (m_searchIndex) {
+            m_searchIndex->abort();
+        }
     } else {
         m_abortSearch = false;
         m_checkRunning = true;
@@ -857,6 +946,53 @@ void DocumentChecker::slotSearchClips(const QString &newpath)
     QTreeWidgetItem *child = m_ui.treeWidget->topLevelItem(ix);
     QDir searchDir(newpath);
     QDomNodeList producers = m_doc.elementsByTagName(QStringLiteral("producer"));
+    // Scan the folder once, keeping the UI responsive while the index is built
+    m_searchIndex = MediaSearchIndex::cached(newpath);
+    if (!m_searchIndex) {
+        emit showScanning(i18n("Scanning %1", searchDir.absolutePath()));
+        auto index = std::make_shared<MediaSearchIndex>(newpath);
+        m_searchIndex = index;
+        QFutureWatcher<bool> watcher;
+        QEventLoop loop;
+        connect(&watcher, &QFutureWatcher<bool>::finished, &loop, &QEventLoop::quit);
+        watcher.setFuture(QtConcurrent::run([index]() { return index->build(); }));
+        if (!watcher.isFinished()) {
+            loop.exec();
+        }
+        if (watcher.result()) {
+            MediaSearchIndex::store(index);
+        }
+    }
+    // Collect all size / hash queries so that candidate files are hashed in one parallel pass
+    QVector<QPair<qint64, QString>> queries;
+    QList<QTreeWidgetItem *> queryItems;
+    while (child != nullptr && !m_abortSearch) {
+        if (child->data(0, statusRole).toInt() == SOURCEMISSING) {
+            for (int j = 0; j < child->childCount(); ++j) {
+                QTreeWidgetItem *subchild = child->child(j);
+                if (!subchild->data(0, sizeRole).toString().isEmpty()) {
+                    queries.append({subchild->data(0, sizeRole).toLongLong(), subchild->data(0, hashRole).toString()});
+                    queryItems << subchild;
+                }
+            }
+        } else if (child->data(0, statusRole).toInt() == CLIPMISSING && child->data(0, clipTypeRole).toInt() != ClipType::SlideShow &&
+                   !child->data(0, sizeRole).toString().isEmpty()) {
+            queries.append({child->data(0, sizeRole).toLongLong(), child->data(0, hashRole).toString()});
+            queryItems << child;
+        }
+        ix++;
+        child = m_ui.treeWidget->topLevelItem(ix);
+    }
+    QHash<QTreeWidgetItem *, QString> hashMatches;
+    if (!queries.isEmpty() && !m_abortSearch) {
+        emit showScanning(i18n("Comparing files in %1", searchDir.absolutePath()));
+        const QStringList results = m_searchIndex->findByHash(queries);
+        for (int i = 0; i < results.size(); ++i) {
+            hashMatches.insert(queryItems.at(i), results.at(i));
+        }
+    }
+    ix = 0;
+    child = m_ui.treeWidget->topLevelItem(ix);
     while (child != nullptr) {
         if (m_abortSearch) {
             break;
@@ -865,8 +1001,8 @@ void DocumentChecker::slotSearchClips(const QString &newpath)
         if (child->data(0, statusRole).toInt() == SOURCEMISSING) {
             for (int j = 0; j < child->childCount(); ++j) {
                 QTreeWidgetItem *subchild = child->child(j);
-                QString clipPath =
-                    searchFileRecursively(searchDir, subchild->data(0, sizeRole).toString(), subchild->data(0, hashRole).toString(), subchild->text(1));
+                QString clipPath = subchild->data(0, sizeRole).toString().isEmpty() ? m_searchIndex->findByName(QUrl::fromLocalFile(subchild->text(1)).fileName())
+                                                                                    : hashMatches.value(subchild);
                 if (!clipPath.isEmpty()) {
                     fixed = true;
                     subchild->setText(1, clipPath);
@@ -884,12 +1020,12 @@ void DocumentChecker::slotSearchClips(const QString &newpath)
             QString clipPath;
             if (type != ClipType::SlideShow) {
                 // Slideshows cannot be found with hash / size
-                clipPath = searchFileRecursively(searchDir, child->data(0, sizeRole).toString(), child->data(0, hashRole).toString(), child->text(1));
+                clipPath = hashMatches.value(child);
             } else {
                 clipPath = searchDirRecursively(searchDir, child->data(0, hashRole).toString(), child->text(1));
             }
             if (clipPath.isEmpty() && type != ClipType::SlideShow) {
-                clipPath = searchPathRecursively(searchDir, QUrl::fromLocalFile(child->text(1)).fileName(), type);
+                clipPath = m_searchIndex->findByName(QUrl::fromLocalFile(child->text(1)).fileName());
                 perfectMatch = false;
             }
             if (!clipPath.isEmpty()) {
@@ -911,7 +1047,7 @@ void DocumentChecker::slotSearchClips(const QString &newpath)
         } else if (child->data(0, typeRole).toInt() == TITLE_IMAGE_ELEMENT && child->data(0, statusRole).toInt() == CLIPPLACEHOLDER) {
             // Search missing title images
             QString missingFileName = QUrl::fromLocalFile(child->text(1)).fileName();
-            QString newPath = searchPathRecursively(searchDir, missingFileName);
+            QString newPath = m_searchIndex->findByName(missingFileName);
             if (!newPath.isEmpty()) {
                 // File found
                 fixed = true;
@@ -938,6 +1074,7 @@ void DocumentChecker::slotSearchClips(const QString &newpath)
     checkStatus();
     slotCheckButtons();
     m_checkRunning = false;
+    m_searchIndex.reset();
 }
 
 QString DocumentChecker::searchLuma(const QDir &dir, const QString &file)
@@ -1065,54 +1202,6 @@ QString DocumentChecker::searchDirRecursively(const QDir &dir, const QString &ma
 }
 
 
-QString DocumentChecker::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName)
-{
-    if (matchSize.isEmpty() && matchHash.isEmpty()) {
-        return searchPathRecursively(dir, QUrl::fromLocalFile(fileName).fileName());
-    }
-    QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
-    QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        qApp->processEvents();
-        if (m_abortSearch) {
-            return QString();
-        }
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (QString::number(file.size()) == matchSize) {
-            if (file.open(QIODevice::ReadOnly)) {
-                /*
-                 * 1 MB = 1 second per 450 files (or faster)
-                 * 10 MB = 9 seconds per 450 files (or faster)
-                 */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
-            }
-        }
-        ////qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << file.size() << fileHash.toHex();
-    }
-    filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchFileRecursively(dir.absoluteFilePath(filesAndDirs.at(i)), matchSize, matchHash, fileName);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
-}
-
 void DocumentChecker::slotEditItem(QTreeWidgetItem *item, int)
 {
     if (!item) {
@@ -26,6 +26,9 @@
 #include <QDir>
 #include <QDomElement>
 #include <QUrl>
+#include <memory>
+
+class MediaSearchIndex;
 
 class DocumentChecker : public QObject
 {
@@ -65,9 +68,16 @@ private:
     QDialog *m_dialog;
     QPair<QString, QString> m_rootReplacement;
     QString searchPathRecursively(const QDir &dir, const QString &fileName, ClipType::ProducerType type = ClipType::Unknown);
-    QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName);
     QString searchDirRecursively(const QDir &dir, const QString &matchHash, const QString &fullName);
     void checkStatus();
+    /** @brief Check the existence (and hash when requested) of the producer files in parallel before the clips are verified. */
+    void prefetchFileStatus(const QDomNodeList &producers, const QString &root);
+    /** @brief Returns true if the file exists, using the prefetched status when available. */
+    bool fileExists(const QString &path) const;
+    /** @brief Returns the file hash computed during prefetch, or compute it. */
+    QByteArray fileHash(const QString &path) const;
+    QHash<QString, bool> m_fileExists;
+    QHash<QString, QByteArray> m_fileHashes;
     QMap<QString, QString> m_missingTitleImages;
     QMap<QString, QString> m_missingTitleFonts;
     QList<QDomElement> m_missingClips;
@@ -79,6 +89,8 @@ private:
     QStringList m_changedClips;
     bool m_abortSearch;
     bool m_checkRunning;
+    /** @brief Index of the folder being searched for missing clips */
+    std::shared_ptr<MediaSearchIndex> m_searchIndex;
 
     void fixClipItem(QTreeWidgetItem *child, const QDomNodeList &producers, const QDomNodeList &trans);
     void fixSourceClipItem(QTreeWidgetItem *child, const QDomNodeList &producers);
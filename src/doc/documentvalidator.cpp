@@ -2133,8 +2133,19 @@ bool DocumentValidator::isModified() const
 
 bool DocumentValidator::checkMovit()
 {
-    QString playlist = m_doc.toString();
-    if (!playlist.contains(QStringLiteral("movit."))) {
+    // Look for Movit GLSL services without serializing the whole document
+    bool usesMovit = false;
+    QDomNodeList services = m_doc.elementsByTagName(QStringLiteral("filter"));
+    for (int i = 0; i < services.count() && !usesMovit; ++i) {
+        QDomElement filt = services.at(i).toElement();
+        usesMovit = filt.attribute(QStringLiteral("id")).startsWith(QLatin1String("movit.")) ||
+                    Xml::getXmlProperty(filt, QStringLiteral("mlt_service")).startsWith(QLatin1String("movit."));
+    }
+    services = m_doc.elementsByTagName(QStringLiteral("transition"));
+    for (int i = 0; i < services.count() && !usesMovit; ++i) {
+        usesMovit = Xml::getXmlProperty(services.at(i).toElement(), QStringLiteral("mlt_service")).startsWith(QLatin1String("movit."));
+    }
+    if (!usesMovit) {
         // Project does not use Movit GLSL effects, we can load it
         return true;
     }
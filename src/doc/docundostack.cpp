@@ -20,11 +20,14 @@
  ***************************************************************************/
 
 #include "docundostack.hpp"
+#include "kdenlivesettings.h"
+#include "undohelper.hpp"
 #include <QUndoCommand>
 #include <QUndoGroup>
 
 DocUndoStack::DocUndoStack(QUndoGroup *parent)
     : QUndoStack(parent)
+    , m_memoryBudget(qint64(KdenliveSettings::undomemorybudget()) * 1024 * 1024)
 {
 }
 
@@ -35,4 +38,74 @@ void DocUndoStack::push(QUndoCommand *cmd)
         emit invalidate(index());
     }
     QUndoStack::push(cmd);
+    trimHistory();
+}
+
+void DocUndoStack::setMemoryBudget(qint64 bytes)
+{
+    m_memoryBudget = bytes;
+    trimHistory();
+}
+
+qint64 DocUndoStack::commandCost(const QUndoCommand *cmd)
+{
+    auto *functional = dynamic_cast<const FunctionalUndoCommand *>(cmd);
+    qint64 cost = functional ? qint64(functional->memoryCost()) : qint64(sizeof(QUndoCommand));
+    // Macros and commands with children hold their state in the children
+    for (int i = 0; i < cmd->childCount(); ++i) {
+        cost += commandCost(cmd->child(i));
+    }
+    return cost;
+}
+
+qint64 DocUndoStack::memoryUsage() const
+{
+    qint64 usage = 0;
+    for (int i = firstAvailableIndex(); i < count(); ++i) {
+        usage += commandCost(command(i));
+    }
+    return usage;
+}
+
+void DocUndoStack::releaseCommand(QUndoCommand *cmd)
+{
+    auto *functional = dynamic_cast<FunctionalUndoCommand *>(cmd);
+    if (functional) {
+        functional->release();
+    }
+    for (int i = 0; i < cmd->childCount(); ++i) {
+        releaseCommand(const_cast<QUndoCommand *>(cmd->child(i)));
+    }
+}
+
+int DocUndoStack::firstAvailableIndex() const
+{
+    int ix = 0;
+    while (ix < count() && command(ix)->isObsolete()) {
+        ix++;
+    }
+    return ix;
+}
+
+bool DocUndoStack::canUndoCommand() const
+{
+    return canUndo() && index() > firstAvailableIndex();
+}
+
+void DocUndoStack::trimHistory()
+{
+    if (m_memoryBudget <= 0) {
+        return;
+    }
+    qint64 usage = memoryUsage();
+    int first = firstAvailableIndex();
+    // Always keep the last command undoable
+    while (usage > m_memoryBudget && first < index() - 1) {
+        // QUndoStack does not allow to remove its oldest commands, so we only drop their operations
+        auto *cmd = const_cast<QUndoCommand *>(command(first));
+        usage -= commandCost(cmd);
+        releaseCommand(cmd);
+        cmd->setObsolete(true);
+        first++;
+    }
 }
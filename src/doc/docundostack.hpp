@@ -32,6 +32,26 @@ class DocUndoStack : public QUndoStack
 public:
     explicit DocUndoStack(QUndoGroup *parent = Q_NULLPTR);
     void push(QUndoCommand *cmd);
+    /** @brief Set the maximum memory (in bytes) used by the undo history, 0 means no limit.
+        When it is exceeded, the operations of the oldest commands are dropped and these commands are marked obsolete:
+        they cannot be undone anymore and Qt deletes them if they are undone anyway */
+    void setMemoryBudget(qint64 bytes);
+    /** @brief Returns the estimated memory used by the commands that can still be undone or redone */
+    qint64 memoryUsage() const;
+    /** @brief Returns the estimated memory used by a command, including its child commands */
+    static qint64 commandCost(const QUndoCommand *cmd);
+    /** @brief Returns the index of the oldest state that can be restored */
+    int firstAvailableIndex() const;
+    /** @brief Returns true if the current command can be undone, unlike canUndo() this is false for commands dropped from the history */
+    bool canUndoCommand() const;
+
+private:
+    qint64 m_memoryBudget;
+    /** @brief Drop the oldest commands until the history fits in the memory budget */
+    void trimHistory();
+    /** @brief Drop the operations of a command and of its child commands */
+    static void releaseCommand(QUndoCommand *cmd);
+
 signals:
     void invalidate(int ix);
 };
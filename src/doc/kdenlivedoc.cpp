@@ -31,6 +31,7 @@
 #include "documentchecker.h"
 #include "documentvalidator.h"
 #include "docundostack.hpp"
+#include "scenelistwriter.h"
 #include "effects/effectsrepository.hpp"
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
@@ -52,10 +53,11 @@
 #include <klocalizedstring.h>
 
 #include "kdenlive_debug.h"
-#include <QCryptographicHash>
+#include "kdenlive_load_debug.h"
 #include <QDomImplementation>
 #include <QFile>
 #include <QFileDialog>
+#include <QElapsedTimer>
 #include <QUndoGroup>
 #include <QUndoStack>
 
@@ -146,8 +148,11 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
             int line;
             int col;
             QDomImplementation::setInvalidDataPolicy(QDomImplementation::DropInvalidChars);
+            QElapsedTimer loadTimer;
+            loadTimer.start();
             success = m_document.setContent(&file, false, &errorMsg, &line, &col);
             file.close();
+            qCDebug(KDENLIVE_LOAD_LOG) << "Project load, xml parsing:" << loadTimer.restart() << "ms";
 
             if (!success) {
                 // It is corrupted
@@ -210,6 +215,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
                     // TODO: backup the document or alert the user?
                     auto validationResult = validator.validate(DOCUMENTVERSION);
                     success = validationResult.first;
+                    qCDebug(KDENLIVE_LOAD_LOG) << "Project load, validation:" << loadTimer.restart() << "ms";
 
                     if (!validationResult.second.isEmpty()) {
                         qDebug() << "DECIMAL POINT has changed to ., was " << validationResult.second;
@@ -218,6 +224,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
 
                     if (success && !KdenliveSettings::gpu_accel()) {
                         success = validator.checkMovit();
+                        qCDebug(KDENLIVE_LOAD_LOG) << "Project load, GPU effects check:" << loadTimer.restart() << "ms";
                     }
                     if (success) { // Let the validator handle error messages
                         qCDebug(KDENLIVE_LOG) << " // / processing file validate ok";
@@ -225,8 +232,10 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
                         qApp->processEvents();
                         DocumentChecker d(m_url, m_document);
                         success = !d.hasErrorInClips();
+                        qCDebug(KDENLIVE_LOAD_LOG) << "Project load, missing clips check:" << loadTimer.restart() << "ms";
                         if (success) {
                             loadDocumentProperties();
+                            qCDebug(KDENLIVE_LOAD_LOG) << "Project load, document properties:" << loadTimer.restart() << "ms";
                             if (m_document.documentElement().hasAttribute(QStringLiteral("upgraded"))) {
                                 m_documentOpenStatus = UpgradedProject;
                                 pCore->displayMessage(i18n("Your project was upgraded, a backup will be created on next save"), ErrorMessage);
@@ -438,26 +447,29 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
            width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt();
 }
 
-void KdenliveDoc::slotAutoSave(const QString &scene)
+bool KdenliveDoc::slotAutoSave(const QByteArray &scene)
 {
-    if (m_autosave != nullptr) {
-        if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
-            // show error: could not open the autosave file
-            qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
-            pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
-            return;
-        }
-        if (scene.isEmpty()) {
-            // Make sure we don't save if scenelist is corrupted
-            KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
-            return;
-        }
-        m_autosave->resize(0);
-        if (m_autosave->write(scene.toUtf8()) < 0) {
-            pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
-        };
-        m_autosave->flush();
+    if (m_autosave == nullptr) {
+        return false;
+    }
+    if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
+        // show error: could not open the autosave file
+        qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
+        pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
+        return false;
     }
+    if (scene.isEmpty()) {
+        // Make sure we don't save if scenelist is corrupted
+        pCore->displayMessage(i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()), ErrorMessage);
+        return false;
+    }
+    m_autosave->resize(0);
+    if (m_autosave->write(scene) < 0) {
+        pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
+        return false;
+    }
+    m_autosave->flush();
+    return true;
 }
 
 void KdenliveDoc::setZoom(int horizontal, int vertical)
@@ -489,90 +501,10 @@ QPair<int, int> KdenliveDoc::targetTracks() const
     return {m_documentProperties.value(QStringLiteral("videoTarget")).toInt(), m_documentProperties.value(QStringLiteral("audioTarget")).toInt()};
 }
 
-QDomDocument KdenliveDoc::xmlSceneList(const QString &scene)
-{
-    QDomDocument sceneList;
-    sceneList.setContent(scene, true);
-    QDomElement mlt = sceneList.firstChildElement(QStringLiteral("mlt"));
-    if (mlt.isNull() || !mlt.hasChildNodes()) {
-        // scenelist is corrupted
-        return QDomDocument();
-    }
-
-    // Set playlist audio volume to 100%
-    QDomNodeList tractors = mlt.elementsByTagName(QStringLiteral("tractor"));
-    for (int i = 0; i < tractors.count(); ++i) {
-        if (tractors.at(i).toElement().hasAttribute(QStringLiteral("global_feed"))) {
-            // This is our main tractor
-            QDomElement tractor = tractors.at(i).toElement();
-            if (Xml::hasXmlProperty(tractor, QLatin1String("meta.volume"))) {
-                Xml::setXmlProperty(tractor, QStringLiteral("meta.volume"), QStringLiteral("1"));
-            }
-            break;
-        }
-    }
-    QDomNodeList tracks = mlt.elementsByTagName(QStringLiteral("track"));
-    if (tracks.isEmpty()) {
-        // Something is very wrong, inform user.
-        qDebug()<<" = = = =  = =  CORRUPTED DOC\n"<<scene;
-        return QDomDocument();
-    }
-
-    QDomNodeList pls = mlt.elementsByTagName(QStringLiteral("playlist"));
-    QDomElement mainPlaylist;
-    for (int i = 0; i < pls.count(); ++i) {
-        if (pls.at(i).toElement().attribute(QStringLiteral("id")) == BinPlaylist::binPlaylistId) {
-            mainPlaylist = pls.at(i).toElement();
-            break;
-        }
-    }
-
-    // check if project contains custom effects to embed them in project file
-    QDomNodeList effects = mlt.elementsByTagName(QStringLiteral("filter"));
-    int maxEffects = effects.count();
-    // qCDebug(KDENLIVE_LOG) << "// FOUD " << maxEffects << " EFFECTS+++++++++++++++++++++";
-    QMap<QString, QString> effectIds;
-    for (int i = 0; i < maxEffects; ++i) {
-        QDomNode m = effects.at(i);
-        QDomNodeList params = m.childNodes();
-        QString id;
-        QString tag;
-        for (int j = 0; j < params.count(); ++j) {
-            QDomElement e = params.item(j).toElement();
-            if (e.attribute(QStringLiteral("name")) == QLatin1String("kdenlive_id")) {
-                id = e.firstChild().nodeValue();
-            }
-            if (e.attribute(QStringLiteral("name")) == QLatin1String("tag")) {
-                tag = e.firstChild().nodeValue();
-            }
-            if (!id.isEmpty() && !tag.isEmpty()) {
-                effectIds.insert(id, tag);
-            }
-        }
-    }
-    // TODO: find a way to process this before rendering MLT scenelist to xml
-    /*QDomDocument customeffects = initEffects::getUsedCustomEffects(effectIds);
-    if (!customeffects.documentElement().childNodes().isEmpty()) {
-        Xml::setXmlProperty(mainPlaylist, QStringLiteral("kdenlive:customeffects"), customeffects.toString());
-    }*/
-    // addedXml.appendChild(sceneList.importNode(customeffects.documentElement(), true));
-
-    // TODO: move metadata to previous step in saving process
-    QDomElement docmetadata = sceneList.createElement(QStringLiteral("documentmetadata"));
-    QMapIterator<QString, QString> j(m_documentMetadata);
-    while (j.hasNext()) {
-        j.next();
-        docmetadata.setAttribute(j.key(), j.value());
-    }
-    // addedXml.appendChild(docmetadata);
-
-    return sceneList;
-}
-
 bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene)
 {
-    QDomDocument sceneList = xmlSceneList(scene);
-    if (sceneList.isNull()) {
+    QByteArray sceneData;
+    if (!SceneListWriter::write(scene, sceneData)) {
         // Make sure we don't save if scenelist is corrupted
         KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", path));
         return false;
@@ -617,8 +549,6 @@ bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene)
         return false;
     }
 
-    const QByteArray sceneData = sceneList.toString().toUtf8();
-
     file.write(sceneData);
     if (!file.commit()) {
         KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1", path));
@@ -802,49 +732,6 @@ const QString KdenliveDoc::description() const
     return m_url.fileName() + QStringLiteral(" [*]/ ") + pCore->getCurrentProfile()->description();
 }
 
-QString KdenliveDoc::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const
-{
-    QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
-    QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (file.open(QIODevice::ReadOnly)) {
-            if (QString::number(file.size()) == matchSize) {
-                /*
-                 * 1 MB = 1 second per 450 files (or faster)
-                 * 10 MB = 9 seconds per 450 files (or faster)
-                 */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
-                qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << "size match but not hash";
-            }
-        }
-        ////qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << file.size() << fileHash.toHex();
-    }
-    filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchFileRecursively(dir.absoluteFilePath(filesAndDirs.at(i)), matchSize, matchHash);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
-}
-
-
 QStringList KdenliveDoc::getBinFolderClipIds(const QString &folderId) const
 {
     return pCore->bin()->getBinFolderClipIds(folderId);
@@ -96,8 +96,6 @@ public:
     void setZoom(int horizontal, int vertical = -1);
     QPoint zoom() const;
     double dar() const;
-    /** @brief Returns the project file xml. */
-    QDomDocument xmlSceneList(const QString &scene);
     /** @brief Saves the project file xml to a file. */
     bool saveSceneList(const QString &path, const QString &scene);
     /** @brief Saves only the MLT xml to a file for preview rendering. */
@@ -214,8 +212,6 @@ private:
 
     QString m_modifiedDecimalPoint;
 
-    QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const;
-
     /** @brief Creates a new project. */
     QDomDocument createEmptyDocument(int videotracks, int audiotracks);
     QDomDocument createEmptyDocument(const QList<TrackInfo> &tracks);
@@ -245,8 +241,10 @@ public slots:
                               QUndoCommand *masterCommand = nullptr);
     /** @brief Saves the current project at the autosave location.
      * 
-     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/ */
-    void slotAutoSave(const QString &scene);
+     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/
+     * This may be called from a non GUI thread.
+     * @returns true if the scene was written */
+    bool slotAutoSave(const QByteArray &scene);
     /** @brief Groups were changed, save to MLT. */
     void groupsChanged(const QString &groups);
     void switchProfile(ProfileParam* pf);
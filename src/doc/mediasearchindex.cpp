@@ -0,0 +1,203 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "mediasearchindex.h"
+#include "bin/projectclip.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QtConcurrent>
+#include <utility>
+
+namespace {
+QMutex cacheMutex;
+QHash<QString, std::shared_ptr<MediaSearchIndex>> sessionCache;
+
+struct IndexedFile
+{
+    qint64 size;
+    QString path;
+};
+
+struct SubFolder
+{
+    QString path;
+    QVector<IndexedFile> files;
+    QVector<QPair<QString, QDateTime>> folders;
+};
+
+struct HashCandidate
+{
+    QString path;
+    QString hash;
+};
+} // namespace
+
+MediaSearchIndex::MediaSearchIndex(QString root)
+    : m_root(QDir::cleanPath(std::move(root)))
+    , m_abort(false)
+{
+}
+
+std::shared_ptr<MediaSearchIndex> MediaSearchIndex::cached(const QString &root)
+{
+    QMutexLocker lock(&cacheMutex);
+    const QString path = QDir::cleanPath(root);
+    std::shared_ptr<MediaSearchIndex> index = sessionCache.value(path);
+    if (index && !index->isUpToDate()) {
+        // Files were added or moved since the scan
+        sessionCache.remove(path);
+        return nullptr;
+    }
+    return index;
+}
+
+void MediaSearchIndex::store(const std::shared_ptr<MediaSearchIndex> &index)
+{
+    QMutexLocker lock(&cacheMutex);
+    sessionCache.insert(index->root(), index);
+}
+
+const QString &MediaSearchIndex::root() const
+{
+    return m_root;
+}
+
+bool MediaSearchIndex::isUpToDate() const
+{
+    for (auto it = m_folderTimes.constBegin(); it != m_folderTimes.constEnd(); ++it) {
+        if (QFileInfo(it.key()).lastModified() != it.value()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MediaSearchIndex::abort()
+{
+    m_abort = true;
+}
+
+bool MediaSearchIndex::build()
+{
+    m_abort = false;
+    m_filesBySize.clear();
+    m_filesByName.clear();
+    m_hashes.clear();
+    m_folderTimes.clear();
+    QDir rootDir(m_root);
+    QVector<SubFolder> folders;
+    const QStringList subDirs = rootDir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
+    folders.reserve(subDirs.size() + 1);
+    for (const QString &sub : subDirs) {
+        folders.append({rootDir.absoluteFilePath(sub), {}, {}});
+    }
+    // Walk each top level folder in its own thread
+    QtConcurrent::blockingMap(folders, [this](SubFolder &folder) {
+        folder.folders.append({folder.path, QFileInfo(folder.path).lastModified()});
+        QDirIterator it(folder.path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable, QDirIterator::Subdirectories);
+        while (it.hasNext() && !m_abort) {
+            it.next();
+            const QFileInfo info = it.fileInfo();
+            if (info.isDir()) {
+                folder.folders.append({it.filePath(), info.lastModified()});
+            } else {
+                folder.files.append({info.size(), it.filePath()});
+            }
+        }
+    });
+    if (m_abort) {
+        return false;
+    }
+    m_folderTimes.insert(m_root, QFileInfo(m_root).lastModified());
+    const QFileInfoList rootFiles = rootDir.entryInfoList(QDir::Files | QDir::Readable);
+    for (const QFileInfo &info : rootFiles) {
+        m_filesBySize.insert(info.size(), info.absoluteFilePath());
+        m_filesByName.insert(info.fileName(), info.absoluteFilePath());
+    }
+    for (const SubFolder &folder : qAsConst(folders)) {
+        for (const auto &subFolder : folder.folders) {
+            m_folderTimes.insert(subFolder.first, subFolder.second);
+        }
+        for (const IndexedFile &file : folder.files) {
+            m_filesBySize.insert(file.size, file.path);
+            m_filesByName.insert(file.path.section(QLatin1Char('/'), -1), file.path);
+        }
+    }
+    return true;
+}
+
+QStringList MediaSearchIndex::findByHash(const QVector<QPair<qint64, QString>> &queries)
+{
+    // Only hash files whose size matches one of the queries, and each of them once
+    QVector<HashCandidate> candidates;
+    QSet<QString> listed;
+    for (const auto &query : queries) {
+        const QStringList matches = m_filesBySize.values(query.first);
+        for (const QString &path : matches) {
+            if (!m_hashes.contains(path) && !listed.contains(path)) {
+                listed.insert(path);
+                candidates.append({path, QString()});
+            }
+        }
+    }
+    QtConcurrent::blockingMap(candidates, [](HashCandidate &candidate) {
+        candidate.hash = QString::fromLatin1(ProjectClip::calculateHash(candidate.path).first.toHex());
+    });
+    for (const HashCandidate &candidate : qAsConst(candidates)) {
+        m_hashes.insert(candidate.path, candidate.hash);
+    }
+    QStringList results;
+    results.reserve(queries.size());
+    for (const auto &query : queries) {
+        QStringList found;
+        const QStringList matches = m_filesBySize.values(query.first);
+        for (const QString &path : matches) {
+            if (m_hashes.value(path) == query.second) {
+                found << path;
+            }
+        }
+        results << closest(found);
+    }
+    return results;
+}
+
+QString MediaSearchIndex::findByName(const QString &fileName) const
+{
+    return closest(m_filesByName.values(fileName));
+}
+
+QString MediaSearchIndex::closest(const QStringList &paths)
+{
+    QString result;
+    int depth = -1;
+    for (const QString &path : paths) {
+        int pathDepth = path.count(QLatin1Char('/'));
+        if (depth < 0 || pathDepth < depth || (pathDepth == depth && path < result)) {
+            result = path;
+            depth = pathDepth;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,82 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef MEDIASEARCHINDEX_H
+#define MEDIASEARCHINDEX_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMultiHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+/** @class MediaSearchIndex
+    @brief Index of the files contained in a folder tree, used to relocate missing clips.
+    The folder is walked only once (subfolders in parallel), files are indexed by size and name,
+    and only files whose size matches a missing clip are hashed. Indexes are kept for the session
+    so that repeated searches in the same folder don't walk it again, as long as none of its folders
+    was modified since the scan.
+ */
+class MediaSearchIndex
+{
+public:
+    explicit MediaSearchIndex(QString root);
+
+    /** @brief Returns the index of this folder if it was already scanned in this session and is still up to date, nullptr otherwise */
+    static std::shared_ptr<MediaSearchIndex> cached(const QString &root);
+    /** @brief Keep a fully scanned index in the session cache */
+    static void store(const std::shared_ptr<MediaSearchIndex> &index);
+
+    /** @brief Scan the folder tree. Can run in a separate thread.
+     *  @returns false if the scan was aborted */
+    bool build();
+    /** @brief Stop a running scan, can be called from any thread */
+    void abort();
+
+    /** @brief Find the files matching a list of (size, hex hash) pairs.
+     *  Candidates are hashed in parallel and their hash is cached in the index.
+     *  @returns the path found for each query, or an empty string */
+    QStringList findByHash(const QVector<QPair<qint64, QString>> &queries);
+    /** @brief Returns the file with this name closest to the root folder, or an empty string */
+    QString findByName(const QString &fileName) const;
+
+    const QString &root() const;
+    /** @brief Returns false if a folder of the tree was modified (files added, removed or renamed) since the scan */
+    bool isUpToDate() const;
+
+private:
+    QString m_root;
+    QMultiHash<qint64, QString> m_filesBySize;
+    QMultiHash<QString, QString> m_filesByName;
+    /** @brief Hex hash of already hashed files */
+    QHash<QString, QString> m_hashes;
+    /** @brief Modification time of each scanned folder */
+    QHash<QString, QDateTime> m_folderTimes;
+    std::atomic_bool m_abort;
+    /** @brief Returns the path closest to the root folder, so that results don't depend on hash ordering */
+    static QString closest(const QStringList &paths);
+};
+
+#endif
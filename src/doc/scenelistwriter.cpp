@@ -0,0 +1,270 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "scenelistwriter.h"
+
+#include <QDebug>
+#include <QTextCodec>
+#include <QTextStream>
+#include <QXmlStreamReader>
+
+namespace {
+/* Escape text the same way QDom does when serializing: quotes and whitespace are only
+   encoded in attribute values, and '>' only when it closes a "]]>" sequence.
+*/
+void writeEscaped(QTextStream &out, const QStringRef &text, bool attribute)
+{
+    int start = 0;
+    const int length = text.size();
+    for (int i = 0; i < length; ++i) {
+        const char *replacement = nullptr;
+        switch (text.at(i).unicode()) {
+        case '<':
+            replacement = "&lt;";
+            break;
+        case '&':
+            replacement = "&amp;";
+            break;
+        case '>':
+            if (i >= 2 && text.at(i - 1) == QLatin1Char(']') && text.at(i - 2) == QLatin1Char(']')) {
+                replacement = "&gt;";
+            }
+            break;
+        case '"':
+            if (attribute) {
+                replacement = "&quot;";
+            }
+            break;
+        case 0x9:
+            if (attribute) {
+                replacement = "&#x9;";
+            }
+            break;
+        case 0xA:
+            if (attribute) {
+                replacement = "&#xa;";
+            }
+            break;
+        case 0xD:
+            if (attribute) {
+                replacement = "&#xd;";
+            }
+            break;
+        default:
+            break;
+        }
+        if (replacement != nullptr) {
+            out << text.mid(start, i - start) << replacement;
+            start = i + 1;
+        }
+    }
+    out << text.mid(start);
+}
+} // namespace
+
+bool SceneListWriter::write(const QString &scene, QByteArray &output)
+{
+    output.clear();
+    output.reserve(scene.size() + scene.size() / 8);
+    QTextStream out(&output, QIODevice::WriteOnly);
+    out.setCodec(QTextCodec::codecForName("UTF-8"));
+    QXmlStreamReader reader(scene);
+
+    // Layout state, following the rules of QDomNode::save with an indentation of 1
+    int depth = 0;
+    // The last start tag was written without its closing bracket, we don't know yet if it has children
+    bool openStartTag = false;
+    // A line feed is due, unless the next node is a text node
+    bool pendingNewline = false;
+    // The previous sibling is a text node, so no indentation is written
+    bool prevIsText = false;
+
+    // Corruption checks
+    bool hasRoot = false;
+    bool rootHasChildren = false;
+    bool hasTracks = false;
+
+    // Main tractor volume reset
+    bool mainTractorFound = false;
+    int mainTractorDepth = -1;
+    bool volumeProcessed = false;
+    int volumeDepth = -1;
+    bool volumeTextWritten = false;
+
+    auto beforeChild = [&](bool isText) {
+        if (openStartTag) {
+            out << '>';
+            openStartTag = false;
+            pendingNewline = !isText;
+        }
+        if (pendingNewline && !isText) {
+            out << '\n';
+        }
+        pendingNewline = false;
+    };
+    auto indent = [&]() {
+        if (!prevIsText && depth > 0) {
+            out << QString(depth, QLatin1Char(' '));
+        }
+    };
+
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartDocument:
+            if (!reader.documentVersion().isEmpty() || !reader.documentEncoding().isEmpty()) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+                // QDom rebuilds the xml declaration with single quotes
+                out << "<?xml version='" << reader.documentVersion() << '\'';
+                if (!reader.documentEncoding().isEmpty()) {
+                    out << " encoding='" << reader.documentEncoding() << '\'';
+                }
+                if (reader.isStandaloneDocument()) {
+                    out << " standalone='yes'";
+                }
+#else
+                out << "<?xml version=\"" << reader.documentVersion() << '"';
+                if (!reader.documentEncoding().isEmpty()) {
+                    out << " encoding=\"" << reader.documentEncoding() << '"';
+                }
+#endif
+                out << "?>\n";
+            }
+            break;
+        case QXmlStreamReader::StartElement: {
+            const QStringRef name = reader.qualifiedName();
+            if (depth == 0) {
+                if (hasRoot || name != QLatin1String("mlt")) {
+                    qDebug() << " = = = =  = =  CORRUPTED DOC\n" << scene;
+                    out.flush();
+                    output.clear();
+                    return false;
+                }
+                hasRoot = true;
+            } else {
+                rootHasChildren = true;
+            }
+            const QXmlStreamAttributes attributes = reader.attributes();
+            if (!hasTracks && name == QLatin1String("track")) {
+                hasTracks = true;
+            } else if (!mainTractorFound && name == QLatin1String("tractor") && attributes.hasAttribute(QLatin1String("global_feed"))) {
+                // This is our main tractor
+                mainTractorFound = true;
+                mainTractorDepth = depth;
+            } else if (!volumeProcessed && mainTractorDepth >= 0 && depth == mainTractorDepth + 1 && volumeDepth < 0 && name == QLatin1String("property") &&
+                       attributes.value(QLatin1String("name")) == QLatin1String("meta.volume")) {
+                // Set playlist audio volume to 100%, only for the tractor's own property
+                volumeDepth = depth;
+            }
+            beforeChild(false);
+            indent();
+            out << '<' << name;
+            // Attributes are written in the order of the MLT scene, which doesn't change between saves
+            for (const QXmlStreamAttribute &attribute : attributes) {
+                out << ' ' << attribute.qualifiedName() << "=\"";
+                writeEscaped(out, attribute.value(), true);
+                out << '"';
+            }
+            openStartTag = true;
+            prevIsText = false;
+            depth++;
+            break;
+        }
+        case QXmlStreamReader::Characters:
+            if (reader.isWhitespace() && !reader.isCDATA()) {
+                // QDom drops whitespace only text nodes
+                break;
+            }
+            if (depth == 1) {
+                rootHasChildren = true;
+            }
+            beforeChild(true);
+            if (reader.isCDATA()) {
+                out << "<![CDATA[" << reader.text() << "]]>";
+            } else if (volumeDepth >= 0 && !volumeTextWritten) {
+                out << '1';
+                volumeTextWritten = true;
+            } else {
+                writeEscaped(out, reader.text(), false);
+            }
+            prevIsText = true;
+            break;
+        case QXmlStreamReader::EndElement:
+            depth--;
+            if (openStartTag) {
+                out << "/>";
+                openStartTag = false;
+            } else {
+                if (pendingNewline) {
+                    out << '\n';
+                }
+                indent();
+                out << "</" << reader.qualifiedName() << '>';
+            }
+            pendingNewline = true;
+            prevIsText = false;
+            if (depth == volumeDepth) {
+                volumeDepth = -1;
+                volumeProcessed = true;
+            } else if (depth == mainTractorDepth) {
+                mainTractorDepth = -1;
+            }
+            break;
+        case QXmlStreamReader::Comment: {
+            if (depth == 1) {
+                rootHasChildren = true;
+            }
+            beforeChild(false);
+            indent();
+            const QStringRef text = reader.text();
+            out << "<!--" << text;
+            if (text.endsWith(QLatin1Char('-'))) {
+                out << ' ';
+            }
+            out << "-->";
+            pendingNewline = true;
+            prevIsText = false;
+            break;
+        }
+        case QXmlStreamReader::ProcessingInstruction:
+            if (depth == 1) {
+                rootHasChildren = true;
+            }
+            beforeChild(false);
+            out << "<?" << reader.processingInstructionTarget() << ' ' << reader.processingInstructionData() << "?>\n";
+            prevIsText = false;
+            break;
+        default:
+            break;
+        }
+    }
+    if (reader.hasError() || !hasRoot || !rootHasChildren || !hasTracks) {
+        // scenelist is corrupted
+        qDebug() << " = = = =  = =  CORRUPTED DOC\n" << scene;
+        out.flush();
+        output.clear();
+        return false;
+    }
+    if (pendingNewline) {
+        out << '\n';
+    }
+    out.flush();
+    return true;
+}
@@ -0,0 +1,45 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef SCENELISTWRITER_H
+#define SCENELISTWRITER_H
+
+#include <QByteArray>
+#include <QString>
+
+/** @class SceneListWriter
+    @brief Streams an MLT scene list to a Kdenlive project file without building a DOM tree.
+    The output follows the layout and escaping of QDomDocument::toString() for the parsed scene, but keeps the
+    attribute order of the scene instead of QDom's hash order. Peak memory stays close to the document size.
+ */
+class SceneListWriter
+{
+public:
+    /** @brief Write the project file content for a scene list generated by the MLT xml consumer.
+     *  The main tractor volume is reset to 100% on the fly.
+     *  @param scene the MLT xml scene list
+     *  @param output receives the UTF-8 encoded project document
+     *  @returns false if the scene list is corrupted (invalid xml, no tracks)
+     */
+    static bool write(const QString &scene, QByteArray &output);
+};
+
+#endif
@@ -37,6 +37,7 @@ std::once_flag EffectsRepository::m_onceFlag;
 
 EffectsRepository::EffectsRepository()
     : AbstractAssetsRepository<AssetListType::AssetType>()
+    , m_sharedXml(500)
 {
     init();
     // Check that our favorite effects are valid
@@ -68,10 +69,7 @@ Mlt::Properties *EffectsRepository::getMetadata(const QString &effectId) const
 
 void EffectsRepository::parseCustomAssetFile(const QString &file_name, std::unordered_map<QString, Info> &customAssets) const
 {
-    QFile file(file_name);
-    QDomDocument doc;
-    doc.setContent(&file, false);
-    file.close();
+    QDomDocument doc = readAssetFile(file_name);
     QDomElement base = doc.documentElement();
     if (base.tagName() == QLatin1String("effectgroup")) {
         QDomNodeList effects = base.elementsByTagName(QStringLiteral("effect"));
@@ -167,7 +165,7 @@ void EffectsRepository::parseCustomAssetFile(const QString &file_name, std::unor
                 if (effectFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
                     effectFile.write(doc.toString().toUtf8());
                 }
-                file.close();
+                effectFile.close();
             }
         }
         customAssets[result.id] = result;
@@ -199,6 +197,11 @@ QString EffectsRepository::assetBlackListPath() const
     return QStringLiteral(":data/blacklisted_effects.txt");
 }
 
+QString EffectsRepository::assetCatalogName() const
+{
+    return QStringLiteral("effects");
+}
+
 QString EffectsRepository::assetPreferredListPath() const
 {
     return QStringLiteral(":data/preferred_effects.txt");
@@ -240,8 +243,47 @@ QString EffectsRepository::getCustomPath(const QString &id)
 }
   
 
+QDomElement EffectsRepository::getSharedXml(const QString &effectId, Mlt::Properties *filter)
+{
+    QMutexLocker lock(&m_sharedXmlMutex);
+    const QDomElement &base = m_assets.at(effectId).xml;
+    // The parameters of effects with a custom locale are converted in place on construction, they cannot be shared
+    bool shared = !base.hasAttribute(QStringLiteral("LC_NUMERIC"));
+    QStringList values;
+    QString key = effectId;
+    if (filter) {
+        QDomNodeList params = base.elementsByTagName(QStringLiteral("parameter"));
+        for (int i = 0; i < params.count(); ++i) {
+            QString paramName = params.item(i).toElement().attribute(QStringLiteral("name"));
+            values << QString::fromUtf8(filter->get(paramName.toUtf8().constData()));
+        }
+        key.append(QLatin1Char('\n') + values.join(QChar(0x1f)));
+    }
+    if (shared) {
+        QDomElement *cached = m_sharedXml.object(key);
+        if (cached) {
+            return *cached;
+        }
+    }
+    QDomElement xml = base.cloneNode().toElement();
+    if (filter) {
+        QDomNodeList params = xml.elementsByTagName(QStringLiteral("parameter"));
+        for (int i = 0; i < params.count(); ++i) {
+            params.item(i).toElement().setAttribute(QStringLiteral("value"), values.at(i));
+        }
+    }
+    if (shared) {
+        m_sharedXml.insert(key, new QDomElement(xml));
+    }
+    return xml;
+}
+
 QPair<QString, QString> EffectsRepository::reloadCustom(const QString &path)
 {
+    {
+        QMutexLocker lock(&m_sharedXmlMutex);
+        m_sharedXml.clear();
+    }
     std::unordered_map<QString, Info> customAssets;
     parseCustomAssetFile(path, customAssets);
     QPair<QString, QString> result;
@@ -403,6 +445,8 @@ void EffectsRepository::deleteEffect(const QString &id)
     if (file.exists()) {
         file.remove();
         m_assets.erase(id);
+        QMutexLocker lock(&m_sharedXmlMutex);
+        m_sharedXml.clear();
     }
 }
 
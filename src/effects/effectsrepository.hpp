@@ -24,6 +24,8 @@
 
 #include "assets/abstractassetsrepository.hpp"
 #include "definitions.h"
+#include <QCache>
+#include <QMutex>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -42,6 +44,9 @@ public:
 
     /** @brief returns a fresh instance of the given effect */
     std::unique_ptr<Mlt::Filter> getEffect(const QString &effectId) const;
+    /** @brief Returns the xml of the given effect with the parameter values of filter (or the default ones if filter is null).
+       Effects built with the same values share the returned element, so it must not be modified */
+    QDomElement getSharedXml(const QString &effectId, Mlt::Properties *filter = nullptr);
     /** @brief returns true if an effect exists in MLT (bypasses the blacklist/metadata parsing) */
     bool hasInternalEffect(const QString &effectId) const;
     QPair<QString, QString> reloadCustom(const QString &path);
@@ -76,6 +81,9 @@ protected:
     /** @brief Returns the path to the effects' preferred list*/
     QString assetPreferredListPath() const override;
 
+    /** @brief Returns the name of the on-disk catalog cache for these assets*/
+    QString assetCatalogName() const override;
+
     QStringList assetDirs() const override;
 
     void parseType(QScopedPointer<Mlt::Properties> &metadata, Info &res) override;
@@ -87,6 +95,10 @@ protected:
 
     static std::unique_ptr<EffectsRepository> instance;
 
+    /** @brief Effect xml descriptions with their parameter values, by effect id and values */
+    QCache<QString, QDomElement> m_sharedXml;
+    QMutex m_sharedXmlMutex;
+
     /** @brief flag to create the repository only once */
     static std::once_flag m_onceFlag;
 };
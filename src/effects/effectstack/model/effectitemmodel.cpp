@@ -24,14 +24,35 @@
 #include "core.h"
 #include "effects/effectsrepository.hpp"
 #include "effectstackmodel.hpp"
+#include "macros.hpp"
+#include <QHash>
+#include <QUuid>
 #include <utility>
 
+namespace {
+// Linked effects, by link id
+QMultiHash<QString, EffectItemModel *> s_linkedEffects;
+
+QMap<QString, QVariant> parameterMap(const QVector<QPair<QString, QVariant>> &params)
+{
+    QMap<QString, QVariant> result;
+    for (const auto &param : params) {
+        result.insert(param.first, param.second);
+    }
+    return result;
+}
+} // namespace
+
 EffectItemModel::EffectItemModel(const QList<QVariant> &effectData, std::unique_ptr<Mlt::Properties> effect, const QDomElement &xml, const QString &effectId,
                                  const std::shared_ptr<AbstractTreeModel> &stack, bool isEnabled, QString originalDecimalPoint)
     : AbstractEffectItem(EffectItemType::Effect, effectData, stack, false, isEnabled)
     , AssetParameterModel(std::move(effect), xml, effectId, std::static_pointer_cast<EffectStackModel>(stack)->getOwnerId(), originalDecimalPoint)
     , m_childId(0)
 {
+    m_linkId = QString::fromUtf8(m_asset->get("kdenlive:link"));
+    if (!m_linkId.isEmpty()) {
+        s_linkedEffects.insert(m_linkId, this);
+    }
     connect(this, &AssetParameterModel::updateChildren, [&](const QStringList &names) {
         if (m_childEffects.size() == 0) {
             return;
@@ -47,11 +68,18 @@ EffectItemModel::EffectItemModel(const QList<QVariant> &effectData, std::unique_
     });
 }
 
+EffectItemModel::~EffectItemModel()
+{
+    if (!m_linkId.isEmpty()) {
+        s_linkedEffects.remove(m_linkId, this);
+    }
+}
+
 // static
 std::shared_ptr<EffectItemModel> EffectItemModel::construct(const QString &effectId, std::shared_ptr<AbstractTreeModel> stack, bool effectEnabled)
 {
     Q_ASSERT(EffectsRepository::get()->exists(effectId));
-    QDomElement xml = EffectsRepository::get()->getXml(effectId);
+    QDomElement xml = EffectsRepository::get()->getSharedXml(effectId);
 
     std::unique_ptr<Mlt::Properties> effect = EffectsRepository::get()->getEffect(effectId);
     effect->set("kdenlive_id", effectId.toUtf8().constData());
@@ -73,16 +101,8 @@ std::shared_ptr<EffectItemModel> EffectItemModel::construct(std::unique_ptr<Mlt:
     }
     Q_ASSERT(EffectsRepository::get()->exists(effectId));
 
-    // Get the effect XML and add parameter values from the project file
-    QDomElement xml = EffectsRepository::get()->getXml(effectId);
-    QDomNodeList params = xml.elementsByTagName(QStringLiteral("parameter"));
-    for (int i = 0; i < params.count(); ++i) {
-        QDomElement currentParameter = params.item(i).toElement();
-        QString paramName = currentParameter.attribute(QStringLiteral("name"));
-        QString paramValue = effect->get(paramName.toUtf8().constData());
-        qDebug() << effectId << ": Setting parameter " << paramName << " to " << paramValue;
-        currentParameter.setAttribute(QStringLiteral("value"), paramValue);
-    }
+    // Get the effect XML with the parameter values from the project file, shared with the identical effects
+    QDomElement xml = EffectsRepository::get()->getSharedXml(effectId, effect.get());
 
     QList<QVariant> data;
     data << EffectsRepository::get()->getName(effectId) << effectId;
@@ -287,3 +307,120 @@ void EffectItemModel::setInOut(const QString &effectName, QPair<int, int>bounds,
         pCore->pushUndo(undo, redo, i18n("Update zone for %1", effectName));
     }
 }
+
+void EffectItemModel::setLinkId(const QString &linkId)
+{
+    if (linkId == m_linkId) {
+        return;
+    }
+    if (!m_linkId.isEmpty()) {
+        s_linkedEffects.remove(m_linkId, this);
+    }
+    m_linkId = linkId;
+    if (m_linkId.isEmpty()) {
+        m_asset->clear("kdenlive:link");
+    } else {
+        m_asset->set("kdenlive:link", m_linkId.toUtf8().constData());
+        s_linkedEffects.insert(m_linkId, this);
+    }
+}
+
+bool EffectItemModel::isLinked() const
+{
+    return !m_linkId.isEmpty();
+}
+
+int EffectItemModel::linkIdenticalEffects(const std::vector<std::shared_ptr<EffectStackModel>> &stacks)
+{
+    if (m_ownerId.first == ObjectType::BinClip) {
+        // Bin effects are already shared by all the instances of their clip
+        return 0;
+    }
+    const QString linkId = m_linkId.isEmpty() ? QUuid::createUuid().toString() : m_linkId;
+    const QMap<QString, QVariant> params = parameterMap(getAllParameters());
+    std::vector<std::shared_ptr<EffectItemModel>> effects;
+    for (const auto &stack : stacks) {
+        if (stack->getOwnerId().first == ObjectType::BinClip) {
+            continue;
+        }
+        for (int i = 0; i < stack->rowCount(); ++i) {
+            auto effect = std::dynamic_pointer_cast<EffectItemModel>(stack->getEffectStackRow(i));
+            if (effect && effect.get() != this && effect->m_linkId != linkId && effect->m_assetId == m_assetId &&
+                parameterMap(effect->getAllParameters()) == params) {
+                effects.push_back(effect);
+            }
+        }
+    }
+    if (effects.empty()) {
+        return 0;
+    }
+    effects.push_back(std::static_pointer_cast<EffectItemModel>(AssetParameterModel::shared_from_this()));
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    for (const auto &effect : effects) {
+        std::weak_ptr<EffectItemModel> ptr = effect;
+        const QString previousId = effect->m_linkId;
+        Fun local_undo = [ptr, previousId]() {
+            if (auto linkedEffect = ptr.lock()) {
+                linkedEffect->setLinkId(previousId);
+            }
+            return true;
+        };
+        Fun local_redo = [ptr, linkId]() {
+            if (auto linkedEffect = ptr.lock()) {
+                linkedEffect->setLinkId(linkId);
+            }
+            return true;
+        };
+        local_redo();
+        UPDATE_UNDO_REDO_NOLOCK(local_redo, local_undo, undo, redo);
+    }
+    pCore->pushUndo(undo, redo, i18n("Link effects"));
+    return int(effects.size()) - 1;
+}
+
+void EffectItemModel::unlink()
+{
+    if (m_linkId.isEmpty()) {
+        return;
+    }
+    const QString linkId = m_linkId;
+    std::weak_ptr<EffectItemModel> ptr = std::static_pointer_cast<EffectItemModel>(AssetParameterModel::shared_from_this());
+    Fun undo = [ptr, linkId]() {
+        if (auto effect = ptr.lock()) {
+            effect->setLinkId(linkId);
+        }
+        return true;
+    };
+    Fun redo = [ptr]() {
+        if (auto effect = ptr.lock()) {
+            effect->setLinkId(QString());
+        }
+        return true;
+    };
+    redo();
+    pCore->pushUndo(undo, redo, i18n("Unlink effect"));
+}
+
+QList<EffectItemModel *> EffectItemModel::linkedEffects() const
+{
+    QList<EffectItemModel *> effects;
+    if (!m_linkId.isEmpty()) {
+        effects = s_linkedEffects.values(m_linkId);
+        effects.removeAll(const_cast<EffectItemModel *>(this));
+    }
+    return effects;
+}
+
+QVector<std::shared_ptr<AssetParameterModel>> EffectItemModel::linkedAssets()
+{
+    QVector<std::shared_ptr<AssetParameterModel>> assets;
+    const QList<EffectItemModel *> effects = linkedEffects();
+    for (EffectItemModel *effect : effects) {
+        // Deleted effects are only kept alive by the undo history
+        if (effect->isInModel()) {
+            assets << effect->AssetParameterModel::shared_from_this();
+        }
+    }
+    return assets;
+}
@@ -42,6 +42,7 @@ public:
        Only used when loading an existing clip
      */
     static std::shared_ptr<EffectItemModel> construct(std::unique_ptr<Mlt::Properties> effect, std::shared_ptr<AbstractTreeModel> stack, QString originalDecimalPoint);
+    ~EffectItemModel() override;
 
     /** @brief This function plants the effect into the given service in last position
      */
@@ -65,6 +66,15 @@ public:
     bool isValid() const;
     QPair <int, int> getInOut() const;
     void setInOut(const QString &effectName, QPair<int, int>bounds, bool enabled, bool withUndo);
+    /** @brief Link this effect with the effects of the same type and parameters found in the given stacks, so that editing one of them edits all.
+       Returns the number of effects that were added to the link */
+    int linkIdenticalEffects(const std::vector<std::shared_ptr<EffectStackModel>> &stacks);
+    /** @brief Stop propagating the parameter changes of this effect */
+    void unlink();
+    bool isLinked() const;
+    /** @brief Returns the effects linked with this one, excluding itself */
+    QList<EffectItemModel *> linkedEffects() const;
+    QVector<std::shared_ptr<AssetParameterModel>> linkedAssets() override;
 
 protected:
     EffectItemModel(const QList<QVariant> &effectData, std::unique_ptr<Mlt::Properties> effect, const QDomElement &xml, const QString &effectId,
@@ -72,6 +82,9 @@ protected:
     QMap<int, std::shared_ptr<EffectItemModel>> m_childEffects;
     void updateEnable(bool updateTimeline = true) override;
     int m_childId;
+    /** @brief Id shared by the linked effects, stored in the kdenlive:link property of the filter */
+    QString m_linkId;
+    void setLinkId(const QString &linkId);
 };
 
 #endif
@@ -1011,6 +1011,8 @@ void EffectStackModel::importEffects(const std::weak_ptr<Mlt::Service> &service,
                 // duplicate effect
                 std::unique_ptr<Mlt::Filter> asset = EffectsRepository::get()->getEffect(effectId);
                 asset->inherit(*(filter));
+                // A copy is not linked with the effects of its source
+                asset->clear("kdenlive:link");
                 effect = EffectItemModel::construct(std::move(asset), shared_from_this(), originalDecimalPoint);
             }
             if (effect->isAudio()) {
@@ -1027,7 +1029,8 @@ void EffectStackModel::importEffects(const std::weak_ptr<Mlt::Service> &service,
             connect(effect.get(), &AssetParameterModel::replugEffect, this, &EffectStackModel::replugEffect, Qt::DirectConnection);
             connect(effect.get(), &AssetParameterModel::showEffectZone, this, &EffectStackModel::updateEffectZones);
             Fun redo = addItem_lambda(effect, rootItem->getId());
-            effect->prepareKeyframes();
+            // Projects can hold thousands of effects, only build their keyframes when they are displayed or edited
+            effect->deferKeyframes();
             if (redo()) {
                 if (effectId == QLatin1String("fadein") || effectId == QLatin1String("fade_from_black")) {
                     m_fadeIns.insert(effect->getId());
@@ -1230,6 +1233,21 @@ bool EffectStackModel::hasFilter(const QString &effectId) const
     });
 }
 
+bool EffectStackModel::hasKeyframes()
+{
+    READ_LOCK();
+    for (int i = 0; i < rootItem->childCount(); ++i) {
+        auto item = std::static_pointer_cast<AbstractEffectItem>(rootItem->child(i));
+        if (item->effectItemType() == EffectItemType::Group || !item->isEnabled()) {
+            continue;
+        }
+        if (std::static_pointer_cast<EffectItemModel>(item)->hasMoreThanOneKeyframe()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 double EffectStackModel::getFilterParam(const QString &effectId, const QString &paramName)
 {
     READ_LOCK();
@@ -1262,6 +1280,10 @@ void EffectStackModel::replugEffect(const std::shared_ptr<AssetParameterModel> &
     QWriteLocker locker(&m_lock);
     auto effectItem = std::static_pointer_cast<EffectItemModel>(asset);
     int oldRow = effectItem->row();
+    if (oldRow < 0) {
+        // The replug is delayed, the effect may have been removed in between
+        return;
+    }
     int count = rowCount();
     for (int ix = oldRow; ix < count; ix++) {
         auto item = std::static_pointer_cast<EffectItemModel>(rootItem->child(ix));
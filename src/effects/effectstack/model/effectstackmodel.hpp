@@ -99,6 +99,8 @@ public:
 
     /** @brief Returns true if the stack contains an effect with the given Id */
     Q_INVOKABLE bool hasFilter(const QString &effectId) const;
+    /** @brief Returns true if an enabled effect of the stack has more than one keyframe */
+    bool hasKeyframes();
     // TODO: this break the encapsulation, remove
     Q_INVOKABLE double getFilterParam(const QString &effectId, const QString &paramName);
     /** @brief get the active effect's keyframe model */
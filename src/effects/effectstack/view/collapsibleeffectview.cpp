@@ -27,7 +27,11 @@
 #include "effects/effectsrepository.hpp"
 #include "effects/effectstack/model/effectitemmodel.hpp"
 #include "kdenlivesettings.h"
+#include "mainwindow.h"
 #include "monitor/monitor.h"
+#include "timeline2/model/timelineitemmodel.hpp"
+#include "timeline2/view/timelinecontroller.h"
+#include "timeline2/view/timelinewidget.h"
 
 #include "kdenlive_debug.h"
 #include <QDialog>
@@ -125,6 +129,28 @@ CollapsibleEffectView::CollapsibleEffectView(const std::shared_ptr<EffectItemMod
     });
     m_groupAction = new QAction(QIcon::fromTheme(QStringLiteral("folder-new")), i18n("Create Group"), this);
     connect(m_groupAction, &QAction::triggered, this, &CollapsibleEffectView::slotCreateGroup);
+
+    // Link with the identical effects of other clips
+    m_linkAction = new QAction(QIcon::fromTheme(QStringLiteral("link")), i18n("Link Identical Effects"), this);
+    m_linkAction->setCheckable(true);
+    m_linkAction->setChecked(m_model->isLinked());
+    m_linkAction->setEnabled(m_model->getOwnerId().first != ObjectType::BinClip);
+    connect(m_linkAction, &QAction::triggered, this, [this](bool checked) {
+        if (!checked) {
+            m_model->unlink();
+            return;
+        }
+        // Only link with the effects of the clips that are in the timeline
+        int count = m_model->linkIdenticalEffects(pCore->window()->getCurrentTimeline()->controller()->getModel()->getClipEffectStackModels());
+        if (count == 0) {
+            m_linkAction->setChecked(false);
+            pCore->displayMessage(i18n("No identical effect found"), InformationMessage);
+        } else {
+            pCore->displayMessage(i18np("Linked with %1 effect", "Linked with %1 effects", count), InformationMessage);
+        }
+    });
+    frame->setContextMenuPolicy(Qt::ActionsContextMenu);
+    frame->addAction(m_linkAction);
     
     // In /out effect button
     auto *layZone = new QHBoxLayout(zoneFrame);
@@ -287,6 +313,11 @@ CollapsibleEffectView::~CollapsibleEffectView()
     qDebug() << "deleting collapsibleeffectview";
 }
 
+void CollapsibleEffectView::applyPendingChanges()
+{
+    m_view->applyPendingChanges();
+}
+
 void CollapsibleEffectView::setWidgetHeight(qreal value)
 {
     widgetFrame->setFixedHeight(int(m_view->contentHeight() * value));
@@ -89,6 +89,8 @@ public:
     void slotNextKeyframe();
     void slotPreviousKeyframe();
     void addRemoveKeyframe();
+    /** @brief Apply the parameter changes still queued in the view. */
+    void applyPendingChanges();
 
 public slots:
     void slotSyncEffectsPos(int pos);
@@ -137,6 +139,7 @@ private:
     bool m_blockWheel;
     /** @brief The add group action. */
     QAction *m_groupAction;
+    QAction *m_linkAction;
     KDualAction *m_enabledButton;
     QAction *m_inOutButton;
     QLabel *m_colorIcon;
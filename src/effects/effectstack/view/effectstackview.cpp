@@ -402,6 +402,13 @@ void EffectStackView::unsetModel(bool reset)
     // Release ownership of smart pointer
     Kdenlive::MonitorId id = Kdenlive::NoMonitor;
     if (m_model) {
+        // Apply the parameter changes still queued before the effect views are destroyed
+        for (int i = 0; i < m_model->rowCount(); i++) {
+            auto *w = static_cast<CollapsibleEffectView *>(m_effectsTree->indexWidget(m_model->index(i, 0, QModelIndex())));
+            if (w) {
+                w->applyPendingChanges();
+            }
+        }
         ObjectId item = m_model->getOwnerId();
         pCore->showEffectZone(item, {0,0}, false);
         id = item.first == ObjectType::BinClip ? Kdenlive::ClipMonitor : Kdenlive::ProjectMonitor;
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef FRAMETIME_H
+#define FRAMETIME_H
+
+#include "gentime.h"
+#include <QtGlobal>
+
+/** @class FrameTime
+    @brief A time position stored as an integer number of frames in a rational timebase (frame rate numerator / denominator).
+    Unlike GenTime, comparison and arithmetic are exact and don't depend on the fps set with GenTime::setFps, so that
+    positions at 29.97 or 59.94 fps don't drift. Conversions to and from GenTime round like GenTime::frames().
+ */
+class FrameTime
+{
+public:
+    constexpr FrameTime() = default;
+    constexpr FrameTime(qint64 frames, int fpsNum, int fpsDen)
+        : m_frames(frames)
+        , m_fpsNum(fpsNum)
+        , m_fpsDen(fpsDen)
+    {
+    }
+
+    /** @brief Creates a FrameTime from a GenTime, rounded to the nearest frame */
+    static FrameTime fromGenTime(const GenTime &time, int fpsNum, int fpsDen) { return {time.frames(double(fpsNum) / fpsDen), fpsNum, fpsDen}; }
+    /** @brief Creates a FrameTime from a time in seconds, rounded to the nearest frame */
+    static FrameTime fromSeconds(double seconds, int fpsNum, int fpsDen) { return fromGenTime(GenTime(seconds), fpsNum, fpsDen); }
+
+    constexpr qint64 frames() const { return m_frames; }
+    constexpr int fpsNum() const { return m_fpsNum; }
+    constexpr int fpsDen() const { return m_fpsDen; }
+    constexpr double fps() const { return double(m_fpsNum) / m_fpsDen; }
+    constexpr double seconds() const { return double(m_frames) * m_fpsDen / m_fpsNum; }
+    GenTime toGenTime() const { return GenTime(int(m_frames), fps()); }
+
+    /** @brief Returns the same position in another timebase, rounded to the nearest frame */
+    constexpr FrameTime rescaled(int fpsNum, int fpsDen) const
+    {
+        if (fpsNum == m_fpsNum && fpsDen == m_fpsDen) {
+            return *this;
+        }
+        // frames * (fpsNum / fpsDen) / (m_fpsNum / m_fpsDen), rounded like floor(x + 0.5)
+        const qint64 num = 2 * m_frames * fpsNum * m_fpsDen + qint64(m_fpsNum) * fpsDen;
+        const qint64 den = 2 * qint64(m_fpsNum) * fpsDen;
+        return {num >= 0 ? num / den : -((-num + den - 1) / den), fpsNum, fpsDen};
+    }
+
+    constexpr FrameTime operator+(const FrameTime &op) const { return {m_frames + op.rescaled(m_fpsNum, m_fpsDen).m_frames, m_fpsNum, m_fpsDen}; }
+    constexpr FrameTime operator-(const FrameTime &op) const { return {m_frames - op.rescaled(m_fpsNum, m_fpsDen).m_frames, m_fpsNum, m_fpsDen}; }
+    constexpr FrameTime operator+(qint64 frames) const { return {m_frames + frames, m_fpsNum, m_fpsDen}; }
+    constexpr FrameTime operator-(qint64 frames) const { return {m_frames - frames, m_fpsNum, m_fpsDen}; }
+    constexpr FrameTime operator-() const { return {-m_frames, m_fpsNum, m_fpsDen}; }
+    FrameTime &operator+=(const FrameTime &op) { return *this = *this + op; }
+    FrameTime &operator-=(const FrameTime &op) { return *this = *this - op; }
+
+    /* Positions in different timebases are compared exactly, without rounding */
+    constexpr bool operator<(const FrameTime &op) const { return compare(op) < 0; }
+    constexpr bool operator>(const FrameTime &op) const { return compare(op) > 0; }
+    constexpr bool operator<=(const FrameTime &op) const { return compare(op) <= 0; }
+    constexpr bool operator>=(const FrameTime &op) const { return compare(op) >= 0; }
+    constexpr bool operator==(const FrameTime &op) const { return compare(op) == 0; }
+    constexpr bool operator!=(const FrameTime &op) const { return compare(op) != 0; }
+
+private:
+    qint64 m_frames{0};
+    int m_fpsNum{25};
+    int m_fpsDen{1};
+
+    constexpr int compare(const FrameTime &op) const
+    {
+        if (m_fpsNum == op.m_fpsNum && m_fpsDen == op.m_fpsDen) {
+            return m_frames < op.m_frames ? -1 : (m_frames > op.m_frames ? 1 : 0);
+        }
+        // frames * den / num, cross multiplied
+        const qint64 left = m_frames * m_fpsDen * op.m_fpsNum;
+        const qint64 right = op.m_frames * op.m_fpsDen * m_fpsNum;
+        return left < right ? -1 : (left > right ? 1 : 0);
+    }
+};
+
+#endif
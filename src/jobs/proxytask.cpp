@@ -28,6 +28,7 @@
 #include "kdenlivesettings.h"
 #include "macros.hpp"
 
+#include <QEventLoop>
 #include <QProcess>
 #include <QTemporaryFile>
 #include <QThread>
@@ -351,15 +352,22 @@ void ProxyTask::run()
 
         // Make sure we keep the stream order
         parameters << QStringLiteral("-sn") << QStringLiteral("-dn") << QStringLiteral("-map") << QStringLiteral("0");
-        parameters << dest;
-        qDebug()<<"/// FULL PROXY PARAMS:\n"<<parameters<<"\n------";
-        m_jobProcess.reset(new QProcess);
-        // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
-        QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
-        QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
-        m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
-        m_jobProcess->waitForFinished(-1);
-        result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        double sourceDuration = binClip->duration().seconds();
+        if (KdenliveSettings::proxysegmented() && KdenliveSettings::proxysegments() > 1 && sourceDuration >= KdenliveSettings::proxysegmentminduration() &&
+            parameters.contains(QStringLiteral("-i"))) {
+            qDebug()<<"/// SEGMENTED PROXY PARAMS:\n"<<parameters<<"\n------";
+            result = runSegmentedJob(parameters, dest, sourceDuration, binClip->getOriginalFps(), binClip->hasAudio());
+        } else {
+            parameters << dest;
+            qDebug()<<"/// FULL PROXY PARAMS:\n"<<parameters<<"\n------";
+            m_jobProcess.reset(new QProcess);
+            // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
+            QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
+            QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
+            m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
+            m_jobProcess->waitForFinished(-1);
+            result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        }
     }
     // remove temporary playlist if it exists
     m_progress = 100;
@@ -390,6 +398,131 @@ void ProxyTask::run()
     return;
 }
 
+bool ProxyTask::runSegmentedJob(const QStringList &parameters, const QString &dest, double duration, double fps, bool hasAudio)
+{
+    if (fps <= 0.) {
+        fps = pCore->getCurrentFps();
+    }
+    const int segmentCount = KdenliveSettings::proxysegments();
+    const int inputIndex = parameters.indexOf(QStringLiteral("-i"));
+    QFileInfo destInfo(dest);
+    const QString partTemplate = QStringLiteral("%1/%2-part%3.%4").arg(destInfo.absolutePath(), destInfo.completeBaseName());
+    QStringList videoParts;
+    QString audioPart;
+    std::vector<std::unique_ptr<QProcess>> processes;
+    // Seconds already encoded for each video segment, used to merge progress
+    std::vector<double> segmentProgress(size_t(segmentCount), 0.);
+    QEventLoop loop;
+    int running = 0;
+    bool success = true;
+
+    auto startProcess = [&](QStringList args, int segment) {
+        std::unique_ptr<QProcess> process(new QProcess);
+        QProcess *proc = process.get();
+        QObject::connect(this, &ProxyTask::jobCanceled, proc, &QProcess::kill, Qt::DirectConnection);
+        QObject::connect(proc, &QProcess::readyReadStandardError, &loop, [&, proc, segment]() {
+            const QString buffer = QString::fromUtf8(proc->readAllStandardError());
+            m_logDetails.append(buffer);
+            if (segment < 0 || !buffer.contains(QLatin1String("time="))) {
+                return;
+            }
+            const QStringList numbers = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0).split(QLatin1Char(':'));
+            if (numbers.size() < 3) {
+                return;
+            }
+            segmentProgress[size_t(segment)] = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + numbers.at(2).toDouble();
+            double done = 0.;
+            for (double p : segmentProgress) {
+                done += p;
+            }
+            m_progress = qMin(99, int(100 * done / duration));
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        });
+        QObject::connect(proc, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), &loop,
+                         [&](int exitCode, QProcess::ExitStatus exitStatus) {
+                             if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+                                 // One segment failed, no need to continue with the others
+                                 success = false;
+                                 emit jobCanceled();
+                             }
+                             if (--running == 0) {
+                                 loop.quit();
+                             }
+                         });
+        proc->start(KdenliveSettings::ffmpegpath(), args, QIODevice::ReadOnly);
+        if (proc->waitForStarted()) {
+            running++;
+        } else {
+            success = false;
+        }
+        processes.push_back(std::move(process));
+    };
+
+    // Video segments, aligned on source frames. Input seeking decodes from the previous keyframe so segments join without gaps
+    const int totalFrames = int(duration * fps);
+    for (int i = 0; i < segmentCount && success && !m_isCanceled; ++i) {
+        double start = int(totalFrames * i / segmentCount) / fps;
+        double end = int(totalFrames * (i + 1) / segmentCount) / fps;
+        QStringList args = parameters;
+        // The segment length is an output option, placed after the source
+        args.insert(inputIndex + 2, QStringLiteral("-t"));
+        args.insert(inputIndex + 3, QString::number(end - start, 'f', 6));
+        args.insert(inputIndex, QStringLiteral("-ss"));
+        args.insert(inputIndex + 1, QString::number(start, 'f', 6));
+        const QString part = partTemplate.arg(i).arg(destInfo.suffix());
+        args << QStringLiteral("-an") << part;
+        videoParts << part;
+        startProcess(args, i);
+    }
+    // Audio is encoded in one continuous pass to avoid seams between segments
+    if (hasAudio && success && !m_isCanceled) {
+        QStringList args = parameters;
+        audioPart = partTemplate.arg(QStringLiteral("audio")).arg(destInfo.suffix());
+        args << QStringLiteral("-vn") << audioPart;
+        startProcess(args, -1);
+    }
+    if (running > 0) {
+        loop.exec();
+    }
+
+    if (success && !m_isCanceled) {
+        // Losslessly join the segments with the concat demuxer
+        QTemporaryFile concatList;
+        concatList.setFileTemplate(concatList.fileTemplate() + QStringLiteral(".txt"));
+        if (concatList.open()) {
+            QTextStream out(&concatList);
+            for (QString part : qAsConst(videoParts)) {
+                out << QStringLiteral("file '%1'\n").arg(part.replace(QLatin1Char('\''), QStringLiteral("'\\''")));
+            }
+            concatList.close();
+            QStringList args = {QStringLiteral("-hide_banner"), QStringLiteral("-y"),  QStringLiteral("-v"),    QStringLiteral("error"),
+                                QStringLiteral("-f"),           QStringLiteral("concat"), QStringLiteral("-safe"), QStringLiteral("0"),
+                                QStringLiteral("-i"),           concatList.fileName()};
+            if (!audioPart.isEmpty()) {
+                args << QStringLiteral("-i") << audioPart << QStringLiteral("-map") << QStringLiteral("0") << QStringLiteral("-map") << QStringLiteral("1");
+            }
+            args << QStringLiteral("-c") << QStringLiteral("copy") << dest;
+            m_jobProcess.reset(new QProcess);
+            QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
+            m_jobProcess->start(KdenliveSettings::ffmpegpath(), args, QIODevice::ReadOnly);
+            m_jobProcess->waitForFinished(-1);
+            m_logDetails.append(QString::fromUtf8(m_jobProcess->readAllStandardError()));
+            success = m_jobProcess->exitStatus() == QProcess::NormalExit && m_jobProcess->exitCode() == 0;
+        } else {
+            success = false;
+        }
+    }
+
+    // Cleanup intermediate files
+    for (const QString &part : qAsConst(videoParts)) {
+        QFile::remove(part);
+    }
+    if (!audioPart.isEmpty()) {
+        QFile::remove(audioPart);
+    }
+    return success;
+}
+
 void ProxyTask::processLogInfo()
 {
     const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
@@ -38,6 +38,12 @@ private slots:
     void processLogInfo();
 
 private:
+    /** @brief Encode the proxy in parallel segments, then concatenate them losslessly into dest.
+     *  @param parameters the FFmpeg parameters for a single pass, without the destination
+     *  @param duration the source duration in seconds
+     *  @param fps the source frame rate, used to align segment boundaries on frames
+     */
+    bool runSegmentedJob(const QStringList &parameters, const QString &dest, double duration, double fps, bool hasAudio);
     int m_jobDuration;
     bool m_isFfmpegJob;
     std::unique_ptr<QProcess> m_jobProcess;
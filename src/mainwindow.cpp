@@ -1828,10 +1828,16 @@ void MainWindow::setupActions()
 
     QAction *undo = KStandardAction::undo(m_commandStack, SLOT(undo()), actionCollection());
     undo->setEnabled(false);
-    connect(m_commandStack, &QUndoGroup::canUndoChanged, undo, &QAction::setEnabled);
-    connect(this, &MainWindow::enableUndo, this, [this, undo] (bool enable) {
+    // Commands dropped from the undo history are still in the stack, stop before them
+    auto canUndo = [this]() {
+        auto *stack = qobject_cast<DocUndoStack *>(m_commandStack->activeStack());
+        return stack ? stack->canUndoCommand() : m_commandStack->canUndo();
+    };
+    connect(m_commandStack, &QUndoGroup::canUndoChanged, undo, [undo, canUndo]() { undo->setEnabled(canUndo()); });
+    connect(m_commandStack, &QUndoGroup::indexChanged, undo, [undo, canUndo]() { undo->setEnabled(canUndo()); });
+    connect(this, &MainWindow::enableUndo, this, [undo, canUndo] (bool enable) {
         if (enable) {
-            enable = m_commandStack->activeStack()->canUndo();
+            enable = canUndo();
         }
         undo->setEnabled(enable);
     });
@@ -2555,6 +2561,9 @@ void MainWindow::updateConfiguration()
     m_buttonAudioThumbs->setChecked(KdenliveSettings::audiothumbnails());
     m_buttonVideoThumbs->setChecked(KdenliveSettings::videothumbnails());
     m_buttonShowMarkers->setChecked(KdenliveSettings::showmarkers());
+    if (pCore->currentDoc()) {
+        pCore->currentDoc()->commandStack()->setMemoryBudget(qint64(KdenliveSettings::undomemorybudget()) * 1024 * 1024);
+    }
 
     // Update list of transcoding profiles
     buildDynamicActions();
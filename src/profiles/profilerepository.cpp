@@ -32,6 +32,7 @@
 
 std::unique_ptr<ProfileRepository> ProfileRepository::instance;
 std::once_flag ProfileRepository::m_onceFlag;
+std::atomic<int> ProfileRepository::s_revision{0};
 std::vector<std::pair<int, QString>> ProfileRepository::colorProfiles{
     {601, QStringLiteral("ITU-R BT.601")}, {709, QStringLiteral("ITU-R BT.709")}, {240, QStringLiteral("SMPTE ST240")}, {9, QStringLiteral("ITU-R BT.2020")}, {10, QStringLiteral("ITU-R BT.2020")}};
 
@@ -47,6 +48,11 @@ std::unique_ptr<ProfileRepository> &ProfileRepository::get()
     return instance;
 }
 
+int ProfileRepository::revision()
+{
+    return s_revision.load();
+}
+
 void ProfileRepository::refresh(bool fullRefresh)
 {
     QWriteLocker locker(&m_mutex);
@@ -88,6 +94,8 @@ void ProfileRepository::refresh(bool fullRefresh)
             m_profiles.insert(std::make_pair(file, std::move(profile)));
         }
     }
+    // A profile may have been edited or removed, invalidate the values cached from it
+    s_revision++;
 }
 
 QVector<QPair<QString, QString>> ProfileRepository::getAllProfiles() const
@@ -26,6 +26,7 @@
 #include "profileinfo.hpp"
 #include <QReadWriteLock>
 #include <QString>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -46,6 +47,8 @@ public:
 
     /** @brief Reloads all the profiles from the disk */
     void refresh(bool fullRefresh = false);
+    /** @brief Returns a number that changes each time the profiles are reloaded, so that values computed from a profile can be cached */
+    static int revision();
 
     /** @brief Returns a list of all the pairs (description, path) of all the profiles loaded */
     QVector<QPair<QString, QString>> getAllProfiles() const;
@@ -85,6 +88,7 @@ protected:
 
     static std::unique_ptr<ProfileRepository> instance;
     static std::once_flag m_onceFlag; // flag to create the repository only once;
+    static std::atomic<int> s_revision;
 
     static std::vector<std::pair<int, QString>> colorProfiles;
 
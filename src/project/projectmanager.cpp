@@ -40,15 +40,18 @@ the Free Software Foundation, either version 3 of the License, or
 #include <klocalizedstring.h>
 
 #include "kdenlive_debug.h"
+#include "kdenlive_load_debug.h"
 #include <KConfigGroup>
 #include <QAction>
 #include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QLocale>
 #include <QMimeDatabase>
 #include <QMimeType>
 #include <QProgressDialog>
 #include <QTimeZone>
+#include <QtConcurrent>
 #include <audiomixer/mixermanager.hpp>
 #include <lib/localeHandling.h>
 
@@ -243,6 +246,8 @@ void ProjectManager::newFile(QString profileName, bool showProjectSettings)
 
 bool ProjectManager::closeCurrentDocument(bool saveChanges, bool quit)
 {
+    // Make sure a pending backup doesn't access the document while it is closed
+    m_autoSaveThread.waitForFinished();
     if ((m_project != nullptr) && m_project->isModified() && saveChanges) {
         QString message;
         if (m_project->url().fileName().isEmpty()) {
@@ -296,6 +301,7 @@ bool ProjectManager::closeCurrentDocument(bool saveChanges, bool quit)
 
 bool ProjectManager::saveFileAs(const QString &outputFileName, bool saveACopy)
 {
+    m_autoSaveThread.waitForFinished();
     pCore->monitorManager()->pauseActiveMonitor();
     QString oldProjectFolder = m_project->url().isEmpty()
             ? QString()
@@ -428,6 +434,7 @@ bool ProjectManager::saveFile()
     }
     bool result = saveFileAs(m_project->url().toLocalFile());
     m_project->m_autosave->resize(0);
+    m_lastAutoSaveHash.clear();
     return result;
 }
 
@@ -626,9 +633,8 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
     }
     pCore->window()->connectDocument();
     pCore->mixer()->setModel(m_mainTimelineModel);
-    QDateTime documentDate = QFileInfo(m_project->url().toLocalFile()).lastModified();
     pCore->window()->getMainTimeline()->controller()->loadPreview(m_project->getDocumentProperty(QStringLiteral("previewchunks")),
-                                                                  m_project->getDocumentProperty(QStringLiteral("dirtypreviewchunks")), documentDate,
+                                                                  m_project->getDocumentProperty(QStringLiteral("dirtypreviewchunks")),
                                                                   m_project->getDocumentProperty(QStringLiteral("disablepreview")).toInt());
 
     emit docOpened(m_project);
@@ -703,6 +709,7 @@ KRecentFilesAction *ProjectManager::recentFilesAction()
 
 void ProjectManager::slotStartAutoSave()
 {
+    m_autoSaveChanged = true;
     if (m_lastSave.elapsed() > 300000) {
         // If the project was not saved in the last 5 minute, force save
         m_autoSaveTimer.stop();
@@ -714,11 +721,33 @@ void ProjectManager::slotStartAutoSave()
 
 void ProjectManager::slotAutoSave()
 {
+    if (!m_autoSaveChanged) {
+        // Nothing changed since last backup
+        return;
+    }
+    if (m_autoSaveThread.isRunning()) {
+        // Previous backup is still being written, retry later
+        m_autoSaveTimer.start(3000);
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
     prepareSave();
     QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
+    // The MLT scene cannot be walked while the timeline is being edited, so the scene is still serialized on the GUI thread.
+    // Only the post processing and the file write are asynchronous.
     QString scene = projectSceneList(saveFolder);
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
+    m_autoSaveChanged = false;
+    m_lastSave.start();
+    m_autoSaveThread = QtConcurrent::run(this, &ProjectManager::writeAutoSave, scene, m_replacementPattern, timer.elapsed());
+}
+
+void ProjectManager::writeAutoSave(QString scene, const QMap<QString, QString> &replacementPattern, qint64 serializationTime)
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (!replacementPattern.isEmpty()) {
+        QMapIterator<QString, QString> i(replacementPattern);
         while (i.hasNext()) {
             i.next();
             scene.replace(i.key(), i.value());
@@ -729,8 +758,16 @@ void ProjectManager::slotAutoSave()
         pCore->displayMessage(i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"), ErrorMessage);
         return;
     }
-    m_project->slotAutoSave(scene);
-    m_lastSave.start();
+    const QByteArray data = scene.toUtf8();
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    if (hash == m_lastAutoSaveHash) {
+        qCDebug(KDENLIVE_LOG) << "Autosave skipped, scene unchanged. Serialization (GUI thread):" << serializationTime << "ms, check:" << timer.elapsed() << "ms";
+        return;
+    }
+    if (m_project->slotAutoSave(data)) {
+        m_lastAutoSaveHash = hash;
+    }
+    qCDebug(KDENLIVE_LOG) << "Autosave done. Serialization (GUI thread):" << serializationTime << "ms, asynchronous write:" << timer.elapsed() << "ms," << data.size() << "bytes";
 }
 
 QString ProjectManager::projectSceneList(const QString &outputFolder, const QString overlayData)
@@ -934,8 +971,11 @@ bool ProjectManager::updateTimeline(int pos, int scrollPos)
     pCore->window()->getMainTimeline()->loading = true;
     pCore->window()->slotSwitchTimelineZone(m_project->getDocumentProperty(QStringLiteral("enableTimelineZone")).toInt() == 1);
 
+    QElapsedTimer loadTimer;
+    loadTimer.start();
     QScopedPointer<Mlt::Producer> xmlProd(new Mlt::Producer(pCore->getCurrentProfile()->profile(), "xml-string",
                                                             m_project->getAndClearProjectXml().constData()));
+    qCDebug(KDENLIVE_LOAD_LOG) << "Project load, MLT producers:" << loadTimer.elapsed() << "ms";
 
     Mlt::Service s(*xmlProd);
     Mlt::Tractor tractor(s);
@@ -962,6 +1002,19 @@ bool ProjectManager::updateTimeline(int pos, int scrollPos)
         //TODO: act on project load failure
         qDebug()<<"// Project failed to load!!";
     }
+    qCDebug(KDENLIVE_LOAD_LOG) << "Project load, timeline total:" << loadTimer.restart() << "ms";
+    if (KDENLIVE_LOAD_LOG().isDebugEnabled()) {
+        // Clip thumbnails and audio levels are generated by the task manager after the timeline is built
+        auto thumbTimer = std::make_shared<QElapsedTimer>();
+        thumbTimer->start();
+        auto connection = std::make_shared<QMetaObject::Connection>();
+        *connection = connect(&pCore->taskManager, &TaskManager::jobCount, this, [thumbTimer, connection](int count) {
+            if (count == 0) {
+                qCDebug(KDENLIVE_LOAD_LOG) << "Project load, thumbnails and audio levels:" << thumbTimer->elapsed() << "ms";
+                disconnect(*connection);
+            }
+        });
+    }
     const QString groupsData = m_project->getDocumentProperty(QStringLiteral("groups"));
     // update track compositing
     int compositing = pCore->currentDoc()->getDocumentProperty(QStringLiteral("compositing"), QStringLiteral("2")).toInt();
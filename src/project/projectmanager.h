@@ -19,6 +19,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include <QTimer>
 #include <QUrl>
 #include <QElapsedTimer>
+#include <QFuture>
 
 #include "timeline2/model/timelineitemmodel.hpp"
 
@@ -195,11 +196,19 @@ protected:
 private:
     /** @brief checks if autoback files exists, recovers from it if user says yes, returns true if files were recovered. */
     bool checkForBackupFile(const QUrl &url, bool newFile = false);
+    /** @brief Apply the path replacements on a serialized scene and write it to the autosave file. Runs in a separate thread,
+     *  the scene itself is serialized on the GUI thread. */
+    void writeAutoSave(QString scene, const QMap<QString, QString> &replacementPattern, qint64 serializationTime);
 
     KdenliveDoc *m_project{nullptr};
     std::shared_ptr<TimelineItemModel> m_mainTimelineModel;
     QElapsedTimer m_lastSave;
     QTimer m_autoSaveTimer;
+    QFuture<void> m_autoSaveThread;
+    /** @brief True if the document was modified since the last autosave */
+    bool m_autoSaveChanged{false};
+    /** @brief Hash of the last written autosave, to avoid rewriting an identical file */
+    QByteArray m_lastAutoSaveHash;
     QUrl m_startUrl;
     QString m_loadClipsOnOpen;
     QMap<QString, QString> m_replacementPattern;
@@ -28,11 +28,13 @@
 #include "bin/bin.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
+#include "kdenlive_load_debug.h"
 #include "kdenlivesettings.h"
 
 #include <KLocalizedString>
 #include <KMessageBox>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QProgressDialog>
 #include <QSet>
 #include <mlt++/MltPlaylist.h>
@@ -59,8 +61,11 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
     m_errorMessage.clear();
     std::unordered_map<QString, QString> binIdCorresp;
     QStringList expandedFolders;
+    QElapsedTimer loadTimer;
+    loadTimer.start();
     pCore->projectItemModel()->loadBinPlaylist(&tractor, timeline->tractor(), binIdCorresp, expandedFolders, progressDialog);
     pCore->bin()->checkMissingProxies();
+    qCDebug(KDENLIVE_LOAD_LOG) << "Project load, bin clips:" << loadTimer.restart() << "ms";
     QStringList foldersToExpand;
     // Find updated ids for expanded folders
     for (const QString &folderId : expandedFolders) {
@@ -70,8 +75,26 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
     }
     pCore->bin()->loadFolderState(foldersToExpand);
 
+    bool ok = constructTimelineItemsFromMelt(timeline, tractor, binIdCorresp, undo, redo, progressDialog, originalDecimalPoint);
+    if (!ok) {
+        // TODO log error
+        // Don't abort loading because of failed composition
+        undo();
+        return false;
+    }
+    if (!m_errorMessage.isEmpty()) {
+        KMessageBox::sorry(qApp->activeWindow(), m_errorMessage.join("\n"), i18n("Problems found in your project file"));
+    }
+    return true;
+}
+
+bool constructTimelineItemsFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, Mlt::Tractor &tractor, const std::unordered_map<QString, QString> &binIdCorresp,
+                                    Fun &undo, Fun &redo, QProgressDialog *progressDialog, QString originalDecimalPoint)
+{
     QSet<QString> reserved_names{QLatin1String("playlistmain"), QLatin1String("timeline_preview"), QLatin1String("timeline_overlay"), QLatin1String("black_track"), QLatin1String("overlay_track")};
     bool ok = true;
+    QElapsedTimer loadTimer;
+    loadTimer.start();
 
     // Import master track effects
     std::shared_ptr<Mlt::Service> serv = std::make_shared<Mlt::Service>(tractor.get_service());
@@ -138,6 +161,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
         }
     }
     timeline->_resetView();
+    qCDebug(KDENLIVE_LOAD_LOG) << "Project load, timeline tracks:" << loadTimer.restart() << "ms";
 
     // Loading compositions
     QScopedPointer<Mlt::Service> service(tractor.producer());
@@ -195,22 +219,14 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
 
     // build internal track compositing
     timeline->buildTrackCompositing();
+    qCDebug(KDENLIVE_LOAD_LOG) << "Project load, compositions:" << loadTimer.restart() << "ms";
 
     // load locked state as last step
     for (int tid : qAsConst(lockedTracksIndexes)) {
         timeline->setTrackLockedState(tid, true);
     }
 
-    if (!ok) {
-        // TODO log error
-        // Don't abort loading because of failed composition
-        undo();
-        return false;
-    }
-    if (!m_errorMessage.isEmpty()) {
-        KMessageBox::sorry(qApp->activeWindow(), m_errorMessage.join("\n"), i18n("Problems found in your project file"));
-    }
-    return true;
+    return ok;
 }
 
 bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, int tid, Mlt::Tractor &track,
@@ -361,7 +377,7 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
             }
             bool ok = false;
             int cid = -1;
-            if (pCore->bin()->getBinClip(binId)) {
+            if (pCore->projectItemModel()->hasClip(binId)) {
                 PlaylistState::ClipState st = inferState(clip, audioTrack);
                 cid = ClipModel::construct(timeline, binId, clip, st, tid, originalDecimalPoint, playlist);
                 ok = timeline->requestClipMove(cid, tid, position, true, true, false, true, undo, redo);
@@ -21,9 +21,11 @@
 
 #ifndef MELTBUILDER_H
 #define MELTBUILDER_H
+#include "undohelper.hpp"
 #include <memory>
 #include <mlt++/MltTractor.h>
 #include <QtCore/QString>
+#include <unordered_map>
 
 class TimelineItemModel;
 class QProgressDialog;
@@ -32,4 +34,10 @@ class QProgressDialog;
  */
 bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, Mlt::Tractor mlt_timeline, QProgressDialog *progressDialog = nullptr, QString originalDecimalPoint = QString());
 
+/** @brief Builds the tracks, clips and compositions of the timeline, once the bin clips of the tractor are loaded
+    @param binIdCorresp maps the clip ids used in the tractor to the ids of the loaded bin clips
+ */
+bool constructTimelineItemsFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, Mlt::Tractor &tractor, const std::unordered_map<QString, QString> &binIdCorresp,
+                                    Fun &undo, Fun &redo, QProgressDialog *progressDialog = nullptr, QString originalDecimalPoint = QString());
+
 #endif
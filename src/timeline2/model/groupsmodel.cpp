@@ -73,6 +73,7 @@ Fun GroupsModel::groupItems_lambda(int gid, const std::unordered_set<int> &ids,
     QWriteLocker locker(&m_lock);
     Q_ASSERT(ids.size() == 0 || type != GroupType::Leaf);
     return [gid, ids, parent, type, this]() {
+        QWriteLocker lambdaLocker(&m_lock);
         createGroupItem(gid);
         if (parent != -1) {
             setGroup(gid, parent);
@@ -81,14 +82,14 @@ Fun GroupsModel::groupItems_lambda(int gid, const std::unordered_set<int> &ids,
         if (ids.size() > 0) {
             promoteToGroup(gid, type);
             std::unordered_set<int> roots;
-            std::transform(ids.begin(), ids.end(), std::inserter(roots, roots.begin()), [&](int id) { return getRootId(id); });
+            std::transform(ids.begin(), ids.end(), std::inserter(roots, roots.begin()), [&](int id) { return getRootIdNoCacheLock(id); });
             auto ptr = m_parent.lock();
             if (!ptr) Q_ASSERT(false);
             for (int id : roots) {
                 if (type != GroupType::Selection) {
-                    setGroup(getRootId(id), gid, true);
+                    setGroup(getRootIdNoCacheLock(id), gid, true);
                 } else {
-                    setGroup(getRootId(id), gid, false);
+                    setGroup(getRootIdNoCacheLock(id), gid, false);
                     ptr->setSelected(id, true);
                 }
             }
@@ -104,7 +105,7 @@ int GroupsModel::groupItems(const std::unordered_set<int> &ids, Fun &undo, Fun &
     Q_ASSERT(!ids.empty());
     std::unordered_set<int> roots;
     qDebug()<<"==========GROUPING ITEMS: "<<ids.size();
-    std::transform(ids.begin(), ids.end(), std::inserter(roots, roots.begin()), [&](int id) { return getRootId(id); });
+    std::transform(ids.begin(), ids.end(), std::inserter(roots, roots.begin()), [&](int id) { return getRootIdNoCacheLock(id); });
     if (roots.size() == 1 && !force) {
         // We do not create a group with only one element. Instead, we return the id of that element
         return *(roots.begin());
@@ -123,7 +124,7 @@ int GroupsModel::groupItems(const std::unordered_set<int> &ids, Fun &undo, Fun &
 bool GroupsModel::ungroupItem(int id, Fun &undo, Fun &redo)
 {
     QWriteLocker locker(&m_lock);
-    int gid = getRootId(id);
+    int gid = getRootIdNoCacheLock(id);
     if (m_groupIds.count(gid) == 0) {
         // element is not part of a group
         return false;
@@ -139,6 +140,18 @@ void GroupsModel::createGroupItem(int id)
     Q_ASSERT(m_downLink.count(id) == 0);
     m_upLink[id] = -1;
     m_downLink[id] = std::unordered_set<int>();
+    invalidateCaches();
+}
+
+void GroupsModel::invalidateCaches()
+{
+    QMutexLocker cacheLocker(&m_cacheMutex);
+    if (!m_rootCache.empty()) {
+        m_rootCache.clear();
+    }
+    if (!m_leavesCache.empty()) {
+        m_leavesCache.clear();
+    }
 }
 
 Fun GroupsModel::destructGroupItem_lambda(int id)
@@ -150,6 +163,7 @@ Fun GroupsModel::destructGroupItem_lambda(int id)
         if (!ptr) Q_ASSERT(false);
         for (int child : m_downLink[id]) {
             m_upLink[child] = -1;
+            invalidateCaches();
             QModelIndex ix;
             if (ptr->isClip(child)) {
                 ix = ptr->makeClipIndexFromID(child);
@@ -168,6 +182,7 @@ Fun GroupsModel::destructGroupItem_lambda(int id)
         }
         m_downLink.erase(id);
         m_upLink.erase(id);
+        invalidateCaches();
         return true;
     };
 }
@@ -212,17 +227,33 @@ bool GroupsModel::destructGroupItem(int id)
 int GroupsModel::getRootId(int id) const
 {
     READ_LOCK();
+    QMutexLocker cacheLocker(&m_cacheMutex);
+    return getRootIdNoCacheLock(id);
+}
+
+int GroupsModel::getRootIdNoCacheLock(int id) const
+{
+    auto cached = m_rootCache.find(id);
+    if (cached != m_rootCache.end()) {
+        return cached->second;
+    }
+    const int start = id;
+#ifdef QT_DEBUG
     std::unordered_set<int> seen; // we store visited ids to detect cycles
+#endif
     int father = -1;
     do {
         Q_ASSERT(m_upLink.count(id) > 0);
+#ifdef QT_DEBUG
         Q_ASSERT(seen.count(id) == 0);
         seen.insert(id);
+#endif
         father = m_upLink.at(id);
         if (father != -1) {
             id = father;
         }
     } while (father != -1);
+    m_rootCache[start] = id;
     return id;
 }
 
@@ -284,20 +315,33 @@ std::unordered_set<int> GroupsModel::getSubtree(int id) const
 std::unordered_set<int> GroupsModel::getLeaves(int id) const
 {
     READ_LOCK();
-    std::unordered_set<int> result;
-    std::queue<int> queue;
-    queue.push(id);
-    while (!queue.empty()) {
-        int current = queue.front();
-        queue.pop();
-        for (const int &child : m_downLink.at(current)) {
-            queue.push(child);
-        }
-        if (m_downLink.at(current).empty()) {
-            result.insert(current);
+    const std::vector<int> &leaves = getLeavesList(id);
+    return std::unordered_set<int>(leaves.begin(), leaves.end());
+}
+
+const std::vector<int> &GroupsModel::getLeavesList(int id) const
+{
+    READ_LOCK();
+    QMutexLocker cacheLocker(&m_cacheMutex);
+    auto cached = m_leavesCache.find(id);
+    if (cached != m_leavesCache.end()) {
+        return cached->second;
+    }
+    std::vector<int> result;
+    std::vector<int> stack{id};
+    while (!stack.empty()) {
+        int current = stack.back();
+        stack.pop_back();
+        const auto &children = m_downLink.at(current);
+        if (children.empty()) {
+            result.push_back(current);
+        } else {
+            stack.insert(stack.end(), children.begin(), children.end());
         }
     }
-    return result;
+    std::vector<int> &cachedLeaves = m_leavesCache[id];
+    cachedLeaves = std::move(result);
+    return cachedLeaves;
 }
 
 std::unordered_set<int> GroupsModel::getDirectChildren(int id) const
@@ -321,6 +365,7 @@ void GroupsModel::setGroup(int id, int groupId, bool changeState)
     Q_ASSERT(id != groupId);
     removeFromGroup(id);
     m_upLink[id] = groupId;
+    invalidateCaches();
     if (groupId != -1) {
         m_downLink[groupId].insert(id);
         auto ptr = m_parent.lock();
@@ -352,6 +397,7 @@ void GroupsModel::removeFromGroup(int id)
     if (parent != -1) {
         Q_ASSERT(getType(parent) != GroupType::Leaf);
         m_downLink[parent].erase(id);
+        invalidateCaches();
         QModelIndex ix;
         auto ptr = m_parent.lock();
         if (!ptr) Q_ASSERT(false);
@@ -370,6 +416,7 @@ void GroupsModel::removeFromGroup(int id)
         }
     }
     m_upLink[id] = -1;
+    invalidateCaches();
 }
 
 bool GroupsModel::mergeSingleGroups(int id, Fun &undo, Fun &redo)
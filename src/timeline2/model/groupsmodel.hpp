@@ -24,10 +24,12 @@
 
 #include "definitions.h"
 #include "undohelper.hpp"
+#include <QMutex>
 #include <QReadWriteLock>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 class TimelineItemModel;
 
@@ -138,6 +140,9 @@ public:
        @param id of the groupItem
     */
     std::unordered_set<int> getLeaves(int id) const;
+    /** @brief Same as getLeaves, but returns the cached flat list, cheaper when the result is only iterated.
+       The reference is valid until the hierarchy changes */
+    const std::vector<int> &getLeavesList(int id) const;
 
     /** @brief Gets direct children of a given group item
        @param id of the groupItem
@@ -222,6 +227,11 @@ protected:
     
     void adjustOffset(QJsonArray &updatedNodes, QJsonObject childObject, int offset, const QMap<int, int> &trackMap);
 
+    /** @brief Clear the cached roots and leaves, must be called whenever the hierarchy changes */
+    void invalidateCaches();
+    /** @brief Same as getRootId, without locking the caches. Only call it while holding the write lock, when no reader can fill the caches concurrently */
+    int getRootIdNoCacheLock(int id) const;
+
 private:
     std::weak_ptr<TimelineItemModel> m_parent;
 
@@ -233,6 +243,11 @@ private:
     std::unordered_map<int, GroupType> m_groupIds;
     /** @brief This is a lock that ensures safety in case of concurrent access */
     mutable QReadWriteLock m_lock;
+    /** @brief Cached results of getRootId and getLeavesList, cleared by invalidateCaches() */
+    mutable std::unordered_map<int, int> m_rootCache;
+    mutable std::unordered_map<int, std::vector<int>> m_leavesCache;
+    /** @brief Protects the caches, which are filled by const accessors running concurrently under the read lock */
+    mutable QMutex m_cacheMutex;
 };
 
 #endif
@@ -48,66 +48,108 @@ void SnapModel::removePoint(int position)
     }
 }
 
-int SnapModel::getClosestPoint(int position)
+bool SnapModel::isIgnored(std::map<int, int>::const_iterator it) const
+{
+    if (m_ignore.empty()) {
+        return false;
+    }
+    auto ignored = m_ignore.find(it->first);
+    return ignored != m_ignore.end() && ignored->second >= it->second;
+}
+
+bool SnapModel::closestPoint(int position, long long maxSnapDist, int &snapped) const
 {
-    if (m_snaps.empty()) {
-        return -1;
+    if (m_snaps.empty() || maxSnapDist < 0) {
+        return false;
     }
     auto it = m_snaps.lower_bound(position);
-    long long int prev = INT_MIN, next = INT_MAX;
-    if (it != m_snaps.end()) {
-        next = (*it).first;
+    auto next = it;
+    while (next != m_snaps.end() && next->first - (long long)position <= maxSnapDist && isIgnored(next)) {
+        ++next;
     }
-    if (it != m_snaps.begin()) {
-        --it;
-        prev = (*it).first;
+    bool hasNext = next != m_snaps.end() && next->first - (long long)position <= maxSnapDist;
+    bool hasPrev = false;
+    auto prev = it;
+    while (prev != m_snaps.begin()) {
+        --prev;
+        if ((long long)position - prev->first > maxSnapDist) {
+            break;
+        }
+        if (!isIgnored(prev)) {
+            hasPrev = true;
+            break;
+        }
     }
-    if (std::llabs(position - prev) < std::llabs(position - next)) {
-        return int(prev);
+    if (hasPrev && (!hasNext || (long long)position - prev->first < next->first - (long long)position)) {
+        snapped = prev->first;
+        return true;
     }
-    return int(next);
+    if (hasNext) {
+        snapped = next->first;
+        return true;
+    }
+    return false;
 }
 
-int SnapModel::getNextPoint(int position)
+int SnapModel::getClosestPoint(int position)
 {
-    if (m_snaps.empty()) {
-        return position;
+    int snapped = -1;
+    closestPoint(position, LLONG_MAX, snapped);
+    return snapped;
+}
+
+std::pair<int, int> SnapModel::getClosestPoint(const std::vector<int> &positions, int maxSnapDist)
+{
+    std::pair<int, int> result = {-1, -1};
+    long long lowestDiff = maxSnapDist + 1LL;
+    for (int position : positions) {
+        int snapped;
+        // Only look for points strictly closer than the best match so far
+        if (closestPoint(position, lowestDiff - 1, snapped)) {
+            lowestDiff = std::llabs((long long)position - snapped);
+            result = {position, snapped};
+            if (lowestDiff == 0) {
+                break;
+            }
+        }
     }
+    return result;
+}
+
+int SnapModel::getNextPoint(int position)
+{
     auto it = m_snaps.lower_bound(position + 1);
-    long long int next = position;
+    while (it != m_snaps.end() && isIgnored(it)) {
+        ++it;
+    }
     if (it != m_snaps.end()) {
-        next = (*it).first;
+        return (*it).first;
     }
-    return int(next);
+    return position;
 }
 
 int SnapModel::getPreviousPoint(int position)
 {
-    if (m_snaps.empty()) {
-        return 0;
-    }
     auto it = m_snaps.lower_bound(position);
-    long long int prev = 0;
-    if (it != m_snaps.begin()) {
+    while (it != m_snaps.begin()) {
         --it;
-        prev = (*it).first;
+        if (!isIgnored(it)) {
+            return (*it).first;
+        }
     }
-    return int(prev);
+    return 0;
 }
 
 void SnapModel::ignore(const std::vector<int> &pts)
 {
     for (int pt : pts) {
-        removePoint(pt);
-        m_ignore.push_back(pt);
+        Q_ASSERT(m_snaps.count(pt) > 0);
+        m_ignore[pt]++;
     }
 }
 
 void SnapModel::unIgnore()
 {
-    for (const auto &pt : m_ignore) {
-        addPoint(pt);
-    }
     m_ignore.clear();
 }
 
@@ -117,14 +159,14 @@ int SnapModel::proposeSize(int in, int out, int size, bool right, int maxSnapDis
     int proposed_size = -1;
     if (right) {
         int target_pos = in + size - 1;
-        int snapped_pos = getClosestPoint(target_pos);
-        if (snapped_pos != -1 && qAbs(target_pos - snapped_pos) <= maxSnapDist) {
+        int snapped_pos;
+        if (closestPoint(target_pos, maxSnapDist, snapped_pos)) {
             proposed_size = snapped_pos - in;
         }
     } else {
         int target_pos = out + 1 - size;
-        int snapped_pos = getClosestPoint(target_pos);
-        if (snapped_pos != -1 && qAbs(target_pos - snapped_pos) <= maxSnapDist) {
+        int snapped_pos;
+        if (closestPoint(target_pos, maxSnapDist, snapped_pos)) {
             proposed_size = out - snapped_pos;
         }
     }
@@ -138,14 +180,14 @@ int SnapModel::proposeSize(int in, int out, const std::vector<int> boundaries, i
     int proposed_size = -1;
     if (right) {
         int target_pos = in + size - 1;
-        int snapped_pos = getClosestPoint(target_pos);
-        if (snapped_pos != -1 && qAbs(target_pos - snapped_pos) <= maxSnapDist) {
+        int snapped_pos;
+        if (closestPoint(target_pos, maxSnapDist, snapped_pos)) {
             proposed_size = snapped_pos - in;
         }
     } else {
         int target_pos = out + 1 - size;
-        int snapped_pos = getClosestPoint(target_pos);
-        if (snapped_pos != -1 && qAbs(target_pos - snapped_pos) <= maxSnapDist) {
+        int snapped_pos;
+        if (closestPoint(target_pos, maxSnapDist, snapped_pos)) {
             proposed_size = out - snapped_pos;
         }
     }
@@ -23,6 +23,8 @@
 #define SNAPMODEL_H
 
 #include <map>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 /** @class SnapInterface
@@ -60,6 +62,15 @@ public:
     /** @brief Retrieves closest point. Returns -1 if there is no snappoint available */
     int getClosestPoint(int position);
 
+    /** @brief Retrieves the snap point closest to any of the given positions, in one query.
+       Only points at most maxSnapDist frames away are considered, and the search window shrinks as closer points are found.
+       On equal distance, the earliest position in the list wins.
+       @param positions list of positions to snap (for example the boundaries of a dragged group)
+       @param maxSnapDist maximal number of frames we are allowed to snap to
+       @return a pair (position, snap point), where position is the entry of the list that snapped. Returns (-1, -1) if no point was found
+    */
+    std::pair<int, int> getClosestPoint(const std::vector<int> &positions, int maxSnapDist);
+
     /** @brief Retrieves next snap point. Returns position if there is no snappoint available */
     int getNextPoint(int position);
 
@@ -67,8 +78,8 @@ public:
     int getPreviousPoint(int position);
 
     /** @brief Ignores the given positions until unIgnore() is called
-       You can make several call to this before unIgnoring
-       Note that you cannot remove ignored points.
+       You can make several call to this before unIgnoring. Each entry hides one occurrence of the snap point.
+       The snap points themselves are not modified, so ignoring is cheap even for large groups.
        @param points list of point to ignore
      */
     void ignore(const std::vector<int> &pts);
@@ -95,7 +106,13 @@ private:
      * position. Note that it is important that the datastructure is ordered. QMap is NOT ordered, and therefore not suitable.
      */
     std::map<int, int> m_snaps;
-    std::vector<int> m_ignore;
+    /** Overlay of ignored points. The keys are the positions and the values are the number of hidden elements at this position */
+    std::unordered_map<int, int> m_ignore;
+
+    /** @brief Returns true if all the elements at this snap point are ignored */
+    bool isIgnored(std::map<int, int>::const_iterator it) const;
+    /** @brief Finds the closest non ignored point at most maxSnapDist frames away from position. Returns false if there is none */
+    bool closestPoint(int position, long long maxSnapDist, int &snapped) const;
 };
 
 #endif
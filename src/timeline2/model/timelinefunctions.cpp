@@ -109,25 +109,7 @@ bool TimelineFunctions::cloneClip(const std::shared_ptr<TimelineItemModel> &time
 bool TimelineFunctions::requestMultipleClipsInsertion(const std::shared_ptr<TimelineItemModel> &timeline, const QStringList &binIds, int trackId, int position,
                                                       QList<int> &clipIds, bool logUndo, bool refreshView)
 {
-    std::function<bool(void)> undo = []() { return true; };
-    std::function<bool(void)> redo = []() { return true; };
-    for (const QString &binId : binIds) {
-        int clipId;
-        if (timeline->requestClipInsertion(binId, trackId, position, clipId, logUndo, refreshView, false, undo, redo)) {
-            clipIds.append(clipId);
-            position += timeline->getItemPlaytime(clipId);
-        } else {
-            undo();
-            clipIds.clear();
-            return false;
-        }
-    }
-
-    if (logUndo) {
-        pCore->pushUndo(undo, redo, i18n("Insert Clips"));
-    }
-
-    return true;
+    return timeline->requestClipsInsertion(binIds, trackId, position, clipIds, logUndo, refreshView);
 }
 
 bool TimelineFunctions::processClipCut(const std::shared_ptr<TimelineItemModel> &timeline, int clipId, int position, int &newId, Fun &undo, Fun &redo)
@@ -302,6 +284,7 @@ bool TimelineFunctions::requestClipCutAll(std::shared_ptr<TimelineItemModel> tim
     }
 
     unsigned count = 0;
+    TimelineModel::NotificationsBatch batch(timeline.get());
     for (auto track: qAsConst(affectedTracks)) {
         int clipId = track->getClipByPosition(position);
         if (clipId > -1) {
@@ -321,7 +304,7 @@ bool TimelineFunctions::requestClipCutAll(std::shared_ptr<TimelineItemModel> tim
     if (!count) {
         pCore->displayMessage(i18n("No clips to cut"), ErrorMessage);
     } else {
-        pCore->pushUndo(undo, redo, i18n("Cut all clips"));
+        pCore->pushUndo(timeline->batchNotifications(undo), timeline->batchNotifications(redo), i18n("Cut all clips"));
     }
 
     return count > 0;
@@ -541,6 +524,7 @@ bool TimelineFunctions::extractZone(const std::shared_ptr<TimelineItemModel> &ti
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
     bool result = true;
+    TimelineModel::NotificationsBatch batch(timeline.get());
     result = breakAffectedGroups(timeline, tracks, zone, undo, redo);
 
     for (int &trackId : tracks) {
@@ -552,7 +536,7 @@ bool TimelineFunctions::extractZone(const std::shared_ptr<TimelineItemModel> &ti
     if (result && !liftOnly) {
         result = TimelineFunctions::removeSpace(timeline, zone, undo, redo, tracks);
     }
-    pCore->pushUndo(undo, redo, liftOnly ? i18n("Lift zone") : i18n("Extract zone"));
+    pCore->pushUndo(timeline->batchNotifications(undo), timeline->batchNotifications(redo), liftOnly ? i18n("Lift zone") : i18n("Extract zone"));
     return result;
 }
 
@@ -561,9 +545,10 @@ bool TimelineFunctions::insertZone(const std::shared_ptr<TimelineItemModel> &tim
 {
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
+    TimelineModel::NotificationsBatch batch(timeline.get());
     bool res = TimelineFunctions::insertZone(timeline, trackIds, binId, insertFrame, zone, overwrite, useTargets, undo, redo);
     if (res) {
-        pCore->pushUndo(undo, redo, overwrite ? i18n("Overwrite zone") : i18n("Insert zone"));
+        pCore->pushUndo(timeline->batchNotifications(undo), timeline->batchNotifications(redo), overwrite ? i18n("Overwrite zone") : i18n("Insert zone"));
     } else {
         pCore->displayMessage(i18n("Could not insert zone"), ErrorMessage);
         undo();
@@ -774,9 +759,7 @@ bool TimelineFunctions::requestItemCopy(const std::shared_ptr<TimelineItemModel>
         int target_position = timeline->getItemPosition(id) + deltaPos;
         int target_track_position = timeline->getTrackPosition(timeline->getItemTrackId(id)) + deltaTrack;
         if (target_track_position >= 0 && target_track_position < timeline->getTracksCount()) {
-            auto it = timeline->m_allTracks.cbegin();
-            std::advance(it, target_track_position);
-            int target_track = (*it)->getId();
+            int target_track = timeline->getTrackIndexFromPosition(target_track_position);
             if (timeline->isClip(id)) {
                 res = res && timeline->requestClipMove(newId, target_track, target_position, true, true, true, true, undo, redo);
             } else {
@@ -1511,8 +1494,9 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
 {
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
+    TimelineModel::NotificationsBatch batch(timeline.get());
     if (TimelineFunctions::pasteClips(timeline, pasteString, trackId, position, undo, redo)) {
-        pCore->pushUndo(undo, redo, i18n("Paste clips"));
+        pCore->pushUndo(timeline->batchNotifications(undo), timeline->batchNotifications(redo), i18n("Paste clips"));
         return true;
     }
     return false;
@@ -36,6 +36,7 @@
 #include "transitions/transitionsrepository.hpp"
 #include <QDebug>
 #include <QFileInfo>
+#include <map>
 #include <mlt++/MltField.h>
 #include <mlt++/MltProfile.h>
 #include <mlt++/MltTractor.h>
@@ -101,9 +102,7 @@ QModelIndex TimelineItemModel::index(int row, int column, const QModelIndex &par
     } else if (row < int(m_allTracks.size()) && row >= 0) {
         // Get sort order
         // row = getTracksCount() - 1 - row;
-        auto it = m_allTracks.cbegin();
-        std::advance(it, row);
-        int trackId = (*it)->getId();
+        int trackId = m_trackIdsByPosition[size_t(row)];
         result = createIndex(row, column, quintptr(trackId));
     }
     return result;
@@ -148,8 +147,7 @@ QModelIndex TimelineItemModel::makeTrackIndexFromID(int trackId) const
 {
     // we retrieve iterator
     Q_ASSERT(m_iteratorTable.count(trackId) > 0);
-    auto it = m_iteratorTable.at(trackId);
-    int ind = int(std::distance<decltype(m_allTracks.cbegin())>(m_allTracks.begin(), it));
+    int ind = m_trackPositions.at(trackId);
     // Get sort order
     // ind = getTracksCount() - 1 - ind;
     return index(ind);
@@ -634,12 +632,80 @@ void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelInd
             roles.push_back(TimelineModel::OutPointRole);
         }
     }
-    emit dataChanged(topleft, bottomright, roles);
+    sendChange(topleft, bottomright, roles);
 }
 
 void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelIndex &bottomright, const QVector<int> &roles)
 {
-    emit dataChanged(topleft, bottomright, roles);
+    sendChange(topleft, bottomright, roles);
+}
+
+void TimelineItemModel::sendChange(const QModelIndex &topleft, const QModelIndex &bottomright, const QVector<int> &roles)
+{
+    if (m_notificationsBatch == 0 || !topleft.isValid()) {
+        emit dataChanged(topleft, bottomright, roles);
+        return;
+    }
+    // Store the change by item id, rows may move before the batch ends
+    for (int row = topleft.row(); row <= bottomright.row(); ++row) {
+        PendingChange &change = m_pendingChanges[int(topleft.sibling(row, 0).internalId())];
+        if (roles.isEmpty()) {
+            change.allRoles = true;
+        }
+        for (int role : roles) {
+            if (!change.roles.contains(role)) {
+                change.roles.push_back(role);
+            }
+        }
+    }
+}
+
+void TimelineItemModel::flushNotifications()
+{
+    if (m_pendingChanges.empty()) {
+        return;
+    }
+    // Group the changed rows by parent and roles, so that adjacent items are sent as a single range
+    std::map<std::pair<int, QVector<int>>, std::vector<int>> changedRows;
+    for (auto &change : m_pendingChanges) {
+        int itemId = change.first;
+        QModelIndex ix;
+        if (isClip(itemId)) {
+            if (getClipTrackId(itemId) != -1) {
+                ix = makeClipIndexFromID(itemId);
+            }
+        } else if (isComposition(itemId)) {
+            if (getCompositionTrackId(itemId) != -1) {
+                ix = makeCompositionIndexFromID(itemId);
+            }
+        } else if (isTrack(itemId)) {
+            ix = makeTrackIndexFromID(itemId);
+        }
+        if (!ix.isValid()) {
+            // Item was deleted during the batch
+            continue;
+        }
+        QVector<int> roles;
+        if (!change.second.allRoles) {
+            roles = change.second.roles;
+            std::sort(roles.begin(), roles.end());
+        }
+        int parentId = ix.parent().isValid() ? int(ix.parent().internalId()) : -1;
+        changedRows[{parentId, roles}].push_back(ix.row());
+    }
+    m_pendingChanges.clear();
+    for (auto &changed : changedRows) {
+        QModelIndex parentIndex = changed.first.first == -1 ? QModelIndex() : makeTrackIndexFromID(changed.first.first);
+        std::vector<int> &rows = changed.second;
+        std::sort(rows.begin(), rows.end());
+        size_t first = 0;
+        for (size_t i = 1; i <= rows.size(); ++i) {
+            if (i == rows.size() || rows[i] != rows[i - 1] + 1) {
+                emit dataChanged(index(rows[first], 0, parentIndex), index(rows[i - 1], 0, parentIndex), changed.first.second);
+                first = i;
+            }
+        }
+    }
 }
 
 void TimelineItemModel::buildTrackCompositing(bool rebuild)
@@ -706,7 +772,7 @@ void TimelineItemModel::buildTrackCompositing(bool rebuild)
 
 void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelIndex &bottomright, int role)
 {
-    emit dataChanged(topleft, bottomright, {role});
+    sendChange(topleft, bottomright, {role});
 }
 
 void TimelineItemModel::_beginRemoveRows(const QModelIndex &i, int j, int k)
@@ -111,11 +111,23 @@ public:
     void _endRemoveRows() override;
     void _endInsertRows() override;
     void _resetView() override;
+    void flushNotifications() override;
 
 protected:
     /** @brief This is an helper function that finishes a construction of a freshly created TimelineItemModel */
     static void finishConstruct(const std::shared_ptr<TimelineItemModel> &ptr, const std::shared_ptr<MarkerListModel> &guideModel);
 
+private:
+    struct PendingChange
+    {
+        bool allRoles{false};
+        QVector<int> roles;
+    };
+    /** @brief Data changes waiting for the end of a notifications batch, by item id */
+    std::unordered_map<int, PendingChange> m_pendingChanges;
+    /** @brief Emit a data change, or store it if a notifications batch is active */
+    void sendChange(const QModelIndex &topleft, const QModelIndex &bottomright, const QVector<int> &roles);
+
 signals:
     /** @brief Triggered when a video track visibility changed */
     void trackVisibilityChanged();
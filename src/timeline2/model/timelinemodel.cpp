@@ -34,8 +34,13 @@
 #include "kdenlivesettings.h"
 #include "snapmodel.hpp"
 #include "timelinefunctions.hpp"
+#include "transitions/transitionsrepository.hpp"
+#include "xml/xml.hpp"
 
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QFileInfo>
+#include <QTextStream>
 #include <QThread>
 #include <QModelIndex>
 #include <klocalizedstring.h>
@@ -218,12 +223,7 @@ int TimelineModel::getTrackIndexFromPosition(int pos) const
 {
     Q_ASSERT(pos >= 0 && pos < int(m_allTracks.size()));
     READ_LOCK();
-    auto it = m_allTracks.cbegin();
-    while (pos > 0) {
-        it++;
-        pos--;
-    }
-    return (*it)->getId();
+    return m_trackIdsByPosition[size_t(pos)];
 }
 
 int TimelineModel::getClipsCount() const
@@ -366,11 +366,9 @@ int TimelineModel::getSubtitleByStartPosition(int position) const
 {
     READ_LOCK();
     GenTime startTime(position, pCore->getCurrentFps());
-    auto findResult = std::find_if(std::begin(m_allSubtitles), std::end(m_allSubtitles), [&](const std::pair<int, GenTime> &pair) {
-        return pair.second == startTime;
-    });
-    if (findResult != std::end(m_allSubtitles)) {
-        return findResult->first;
+    auto findResult = m_subtitlesByStart.find(startTime);
+    if (findResult != m_subtitlesByStart.end()) {
+        return findResult->second;
     }
     return -1;
 }
@@ -392,9 +390,7 @@ int TimelineModel::getTrackPosition(int trackId) const
 {
     READ_LOCK();
     Q_ASSERT(isTrack(trackId));
-    auto it = m_allTracks.cbegin();
-    int pos = int(std::distance(it, static_cast<decltype(it)>(m_iteratorTable.at(trackId))));
-    return pos;
+    return m_trackPositions.at(trackId);
 }
 
 int TimelineModel::getTrackMltIndex(int trackId) const
@@ -1832,6 +1828,174 @@ bool TimelineModel::requestClipInsertion(const QString &binClipId, int trackId,
     return true;
 }
 
+bool TimelineModel::requestClipsInsertion(const QStringList &binIds, int trackId, int position, QList<int> &clipIds, bool logUndo, bool refreshView)
+{
+    QWriteLocker locker(&m_lock);
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    bool result = requestClipsInsertion(binIds, trackId, position, clipIds, logUndo, refreshView, undo, redo);
+    if (result && logUndo) {
+        PUSH_UNDO(batchNotifications(undo), batchNotifications(redo), i18n("Insert Clips"));
+    }
+    return result;
+}
+
+bool TimelineModel::requestClipsInsertion(const QStringList &binIds, int trackId, int position, QList<int> &clipIds, bool logUndo, bool refreshView, Fun &undo,
+                                          Fun &redo)
+{
+    QWriteLocker locker(&m_lock);
+    clipIds.clear();
+    if (!isTrack(trackId) || getTrackById_const(trackId)->isLocked()) {
+        return false;
+    }
+    struct ClipDrop
+    {
+        QString binId;                  // bin id with in and out points, without the audio / video prefix
+        PlaylistState::ClipState state; // state of the clip inserted on the target track
+        int audioStream;
+        bool split;                     // an audio / video partner is inserted on the mirror track
+    };
+    bool audioDrop = getTrackById_const(trackId)->isAudioTrack();
+    PlaylistState::ClipState trackState = audioDrop ? PlaylistState::AudioOnly : PlaylistState::VideoOnly;
+    int audioStream = m_binAudioTargets.isEmpty() ? -1 : m_binAudioTargets.firstKey();
+    // Clips with several audio streams go through the regular insertion, which dispatches the streams on the audio tracks
+    bool batchInsert = m_binAudioTargets.size() <= 1;
+    // Check all clips and compute the range they will use before touching the timeline
+    std::vector<ClipDrop> drops;
+    drops.reserve(size_t(binIds.size()));
+    int length = 0;
+    // Ranges used on the mirror track by the audio/video clips
+    QVector<QPair<int, int>> mirrorRanges;
+    for (const QString &binClipId : binIds) {
+        QString binIdWithInOut = binClipId;
+        QString bid = binClipId.section(QLatin1Char('/'), 0, 0);
+        PlaylistState::ClipState dropType = PlaylistState::Disabled;
+        if (bid.startsWith(QLatin1Char('A')) || bid.startsWith(QLatin1Char('V'))) {
+            dropType = bid.startsWith(QLatin1Char('A')) ? PlaylistState::AudioOnly : PlaylistState::VideoOnly;
+            bid.remove(0, 1);
+            binIdWithInOut.remove(0, 1);
+            if (dropType != trackState) {
+                return false;
+            }
+        }
+        if (!pCore->projectItemModel()->hasClip(bid)) {
+            qWarning() << "no clip found in bin for" << bid;
+            return false;
+        }
+        std::shared_ptr<ProjectClip> master = pCore->projectItemModel()->getClipByBinID(bid);
+        if (!master->statusReady()) {
+            qWarning() << "clip not ready" << bid;
+            return false;
+        }
+        int clipLength;
+        if (binClipId.contains(QLatin1Char('/'))) {
+            clipLength = binClipId.section(QLatin1Char('/'), 2, 2).toInt() - binClipId.section(QLatin1Char('/'), 1, 1).toInt() + 1;
+        } else {
+            clipLength = int(master->frameDuration());
+        }
+        bool avClip = master->clipType() == ClipType::AV || master->clipType() == ClipType::Playlist;
+        ClipDrop drop{binIdWithInOut, trackState, -1, false};
+        if (avClip && (dropType == PlaylistState::Disabled || dropType == PlaylistState::AudioOnly)) {
+            if (audioDrop) {
+                drop.audioStream = audioStream;
+                batchInsert = batchInsert && audioStream > -1;
+            }
+            if (dropType == PlaylistState::Disabled) {
+                mirrorRanges.append({position + length, clipLength});
+                drop.split = master->hasAudioAndVideo() && (audioDrop || audioStream > -1);
+            }
+        } else if (!avClip || dropType == PlaylistState::VideoOnly) {
+            drop.audioStream = master->getProducerIntProperty(QStringLiteral("audio_index"));
+        }
+        drops.push_back(drop);
+        length += clipLength;
+    }
+    if (length <= 0 || !getTrackById(trackId)->getClipsInRange(position, position + length - 1).empty()) {
+        // Not enough space on the track
+        return false;
+    }
+    int mirror = mirrorRanges.isEmpty() ? -1 : getMirrorTrackId(trackId);
+    if (mirror > -1 && !getTrackById_const(mirror)->isLocked()) {
+        // The audio/video clips also need space on the mirror track
+        for (const auto &range : qAsConst(mirrorRanges)) {
+            if (!getTrackById(mirror)->getClipsInRange(range.first, range.first + range.second - 1).empty()) {
+                return false;
+            }
+        }
+    } else if (mirror == -1 && !mirrorRanges.isEmpty()) {
+        // Let the regular insertion check the other audio tracks
+        batchInsert = false;
+    }
+    Fun local_undo = []() { return true; };
+    Fun local_redo = []() { return true; };
+    NotificationsBatch batch(this);
+    if (!batchInsert) {
+        for (const QString &binClipId : binIds) {
+            int clipId;
+            if (!requestClipInsertion(binClipId, trackId, position, clipId, logUndo, refreshView, false, local_undo, local_redo)) {
+                bool undone = local_undo();
+                Q_ASSERT(undone);
+                clipIds.clear();
+                return false;
+            }
+            clipIds.append(clipId);
+            position += getItemPlaytime(clipId);
+        }
+        UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+        return true;
+    }
+    // Create all the clips, then insert them with a single pass on each track
+    bool splitOnMirror = mirror > -1 && !getTrackById_const(mirror)->isLocked();
+    std::vector<std::pair<int, int>> trackClips;
+    std::vector<std::pair<int, int>> mirrorClips;
+    trackClips.reserve(drops.size());
+    bool res = true;
+    for (const ClipDrop &drop : drops) {
+        int clipId;
+        res = requestClipCreation(drop.binId, clipId, drop.state, drop.audioStream, 1.0, false, local_undo, local_redo);
+        if (!res) {
+            break;
+        }
+        trackClips.push_back({clipId, position});
+        clipIds.append(clipId);
+        if (drop.split && splitOnMirror) {
+            int partnerId;
+            PlaylistState::ClipState partnerState = audioDrop ? PlaylistState::VideoOnly : PlaylistState::AudioOnly;
+            res = requestClipCreation(drop.binId, partnerId, partnerState, audioDrop ? -1 : audioStream, 1.0, false, local_undo, local_redo);
+            if (!res) {
+                pCore->displayMessage(i18n("Audio split failed: impossible to create audio clip"), ErrorMessage);
+                break;
+            }
+            mirrorClips.push_back({partnerId, position});
+        }
+        position += getClipPlaytime(clipId);
+    }
+    res = res && getTrackById(trackId)->requestClipsInsertion(trackClips, refreshView, local_undo, local_redo);
+    res = res && (mirrorClips.empty() || getTrackById(mirror)->requestClipsInsertion(mirrorClips, true, local_undo, local_redo));
+    if (res && !mirrorClips.empty()) {
+        // Create the audio / video groups together
+        requestClearSelection();
+        auto partner = mirrorClips.cbegin();
+        for (const auto &clip : trackClips) {
+            if (partner != mirrorClips.cend() && partner->second == clip.second) {
+                m_groups->groupItems({clip.first, partner->first}, local_undo, local_redo, GroupType::AVSplit);
+                ++partner;
+            }
+        }
+        Fun unselect = [this]() { return requestClearSelection(); };
+        PUSH_FRONT_LAMBDA(unselect, local_undo);
+        PUSH_FRONT_LAMBDA(unselect, local_redo);
+    }
+    if (!res) {
+        bool undone = local_undo();
+        Q_ASSERT(undone);
+        clipIds.clear();
+        return false;
+    }
+    UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+    return true;
+}
+
 bool TimelineModel::requestItemDeletion(int itemId, Fun &undo, Fun &redo, bool logUndo)
 {
     Q_UNUSED(logUndo)
@@ -2013,6 +2177,165 @@ std::unordered_set<int> TimelineModel::getItemsInRange(int trackId, int start, i
     return allClips;
 }
 
+QByteArray TimelineModel::getTimelineHash(bool &keyframed)
+{
+    READ_LOCK();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QDomDocument document;
+    auto addValue = [&hash](const QString &value) {
+        hash.addData(value.toUtf8());
+        hash.addData("\n", 1);
+    };
+    auto addXml = [&addValue](const QDomElement &xml) {
+        QString data;
+        QTextStream stream(&data);
+        xml.save(stream, 0);
+        addValue(data);
+    };
+    keyframed = false;
+    if (m_masterStack) {
+        addXml(m_masterStack->toXml(document));
+        keyframed = m_masterStack->hasKeyframes();
+    }
+    addValue(TransitionsRepository::get()->getCompositingTransition());
+    int trackPosition = 0;
+    for (const auto &track : m_allTracks) {
+        addValue(QStringLiteral("track:%1").arg(trackPosition++));
+        if (track->isAudioTrack()) {
+            continue;
+        }
+        addValue(track->getProperty(QStringLiteral("hide")).toString());
+        addXml(track->m_effectStack->toXml(document));
+        keyframed = keyframed || track->m_effectStack->hasKeyframes();
+    }
+    if (m_subtitleModel && !m_subtitleModel->isDisabled()) {
+        addValue(m_subtitleModel->styleDescription());
+    }
+    return hash.result().toHex();
+}
+
+QByteArray TimelineModel::getRangeHash(int start, int end)
+{
+    READ_LOCK();
+    bool keyframed;
+    const QByteArray timelineHash = getTimelineHash(keyframed);
+    return getRangeHash(start, end, timelineHash, keyframed);
+}
+
+QByteArray TimelineModel::getRangeHash(int start, int end, const QByteArray &timelineHash, bool keyframed)
+{
+    READ_LOCK();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QDomDocument document;
+    auto addValue = [&hash](const QString &value) {
+        hash.addData(value.toUtf8());
+        hash.addData("\n", 1);
+    };
+    auto addXml = [&addValue](const QDomElement &xml) {
+        QString data;
+        QTextStream stream(&data);
+        xml.save(stream, 0);
+        addValue(data);
+    };
+    hash.addData(timelineHash);
+    if (keyframed) {
+        // Keyframes of the master and track effects use timeline positions
+        addValue(QStringLiteral("start:%1").arg(start));
+    }
+    // Bin clips are usually used by several items in the range
+    std::unordered_map<QString, QString> binSources;
+    auto binSource = [&binSources](const QString &binId) {
+        auto found = binSources.find(binId);
+        if (found != binSources.end()) {
+            return found->second;
+        }
+        QString source = binId;
+        std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
+        std::shared_ptr<Mlt::Producer> producer = binClip ? binClip->originalProducer() : nullptr;
+        if (producer) {
+            for (int i = 0; i < producer->count(); ++i) {
+                QString name = producer->get_name(i);
+                if (name.startsWith(QLatin1Char('_')) || name.startsWith(QLatin1String("meta.")) ||
+                    (name.startsWith(QLatin1String("kdenlive:")) && name != QLatin1String("kdenlive:proxy"))) {
+                    continue;
+                }
+                source.append(QStringLiteral(";%1=%2").arg(name, producer->get(i)));
+            }
+            // Catch changes of the source file on disk
+            QFileInfo info(producer->get("resource"));
+            if (info.isFile()) {
+                source.append(QStringLiteral(";%1:%2").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch()));
+            }
+        }
+        binSources[binId] = source;
+        return source;
+    };
+    auto relativePosition = [start](QDomElement xml, int playtime) {
+        int position = xml.attribute(QStringLiteral("position")).toInt();
+        for (const QString &attribute : {QStringLiteral("id"), QStringLiteral("track"), QStringLiteral("mirrorTrack"), QStringLiteral("in"), QStringLiteral("out")}) {
+            xml.removeAttribute(attribute);
+        }
+        xml.setAttribute(QStringLiteral("position"), position - start);
+        xml.setAttribute(QStringLiteral("playtime"), playtime);
+    };
+    int trackPosition = 0;
+    for (const auto &track : m_allTracks) {
+        // Track order matters for compositions
+        addValue(QStringLiteral("track:%1").arg(trackPosition++));
+        if (track->isAudioTrack()) {
+            continue;
+        }
+        std::map<int, int> sortedClips;
+        for (int clipId : track->getClipsInRange(start, end)) {
+            sortedClips[m_allClips.at(clipId)->getPosition()] = clipId;
+        }
+        for (const auto &item : sortedClips) {
+            const auto &clip = m_allClips.at(item.second);
+            QDomElement xml = clip->toXml(document);
+            int in = clip->getIn();
+            int out = clip->getOut();
+            relativePosition(xml, clip->getPlaytime());
+            xml.setAttribute(QStringLiteral("in"), in);
+            xml.setAttribute(QStringLiteral("out"), out);
+            xml.setAttribute(QStringLiteral("source"), binSource(clip->binId()));
+            addXml(xml);
+            if (track->m_sameCompositions.count(item.second) > 0) {
+                const auto &mix = track->m_sameCompositions.at(item.second);
+                addValue(mix->getAssetId());
+                for (const auto &param : mix->getAllParameters()) {
+                    addValue(QStringLiteral("%1=%2").arg(param.first, param.second.toString()));
+                }
+            }
+        }
+        std::map<int, int> sortedCompositions;
+        for (int compoId : track->getCompositionsInRange(start, end)) {
+            sortedCompositions[m_allCompositions.at(compoId)->getPosition()] = compoId;
+        }
+        for (const auto &item : sortedCompositions) {
+            const auto &composition = m_allCompositions.at(item.second);
+            QDomElement xml = composition->toXml(document);
+            relativePosition(xml, composition->getPlaytime());
+            // The transition in and out properties are timeline positions
+            Xml::removeXmlProperty(xml, QStringLiteral("in"));
+            Xml::removeXmlProperty(xml, QStringLiteral("out"));
+            addXml(xml);
+        }
+    }
+    if (m_subtitleModel && !m_subtitleModel->isDisabled()) {
+        // Not using the subtitle model range query as it ignores locked subtitles
+        double fps = pCore->getCurrentFps();
+        auto last = m_subtitlesByStart.lower_bound(GenTime(end, fps));
+        for (auto it = m_subtitlesByStart.begin(); it != last; ++it) {
+            int subEnd = m_subtitleModel->getSubtitleEnd(it->second);
+            if (subEnd < start) {
+                continue;
+            }
+            addValue(QStringLiteral("subtitle:%1:%2:%3").arg(it->first.frames(fps) - start).arg(subEnd - start).arg(m_subtitleModel->getText(it->second)));
+        }
+    }
+    return hash.result().toHex();
+}
+
 bool TimelineModel::requestFakeGroupMove(int clipId, int groupId, int delta_track, int delta_pos, bool updateView, bool logUndo)
 {
     TRACE(clipId, groupId, delta_track, delta_pos, updateView, logUndo);
@@ -2037,7 +2360,7 @@ bool TimelineModel::requestFakeGroupMove(int clipId, int groupId, int delta_trac
     QWriteLocker locker(&m_lock);
     Q_ASSERT(m_allGroups.count(groupId) > 0);
     bool ok = true;
-    auto all_items = m_groups->getLeaves(groupId);
+    const std::vector<int> &all_items = m_groups->getLeavesList(groupId);
     Q_ASSERT(all_items.size() > 1);
     Fun local_undo = []() { return true; };
     Fun local_redo = []() { return true; };
@@ -2097,9 +2420,7 @@ bool TimelineModel::requestFakeGroupMove(int clipId, int groupId, int delta_trac
         int d = getTrackById_const(current_track_id)->isAudioTrack() ? audio_delta : video_delta;
         int target_track_position = current_track_position + d;
         if (target_track_position >= 0 && target_track_position < getTracksCount()) {
-            auto it = m_allTracks.cbegin();
-            std::advance(it, target_track_position);
-            int target_track = (*it)->getId();
+            int target_track = getTrackIndexFromPosition(target_track_position);
             int target_position = old_position[item] + delta_pos;
             if (isClip(item)) {
                 m_allClips[item]->setFakePosition(target_position);
@@ -2159,8 +2480,10 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
         return false;
     }
     bool ok = true;
-    auto all_items = m_groups->getLeaves(groupId);
+    // The cached leaves are iterated in place, the hierarchy does not change during the move
+    const std::vector<int> &all_items = m_groups->getLeavesList(groupId);
     Q_ASSERT(all_items.size() > 1);
+    auto isMoving = [&all_items](int id) { return std::find(all_items.begin(), all_items.end(), id) != all_items.end(); };
     Fun local_undo = []() { return true; };
     Fun local_redo = []() { return true; };
     std::vector< std::pair<int, int> > sorted_clips;
@@ -2195,11 +2518,11 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
                 std::pair<MixInfo, MixInfo> mixData = getTrackById_const(current_track_id)->getMixInfo(affectedItemId);
                 mixDataArray.insert(affectedItemId, mixData);
                 if (delta_track != 0) {
-                    if (mixData.first.firstClipId > -1 && all_items.find(mixData.first.firstClipId) == all_items.end()) {
+                    if (mixData.first.firstClipId > -1 && !isMoving(mixData.first.firstClipId)) {
                         // First part of the mix is not moving, delete start mix
                         mixesToDelete.insert({mixData.first.firstClipId,affectedItemId}, current_track_id);
                     }
-                    if (mixData.second.firstClipId > -1 && all_items.find(mixData.second.secondClipId) == all_items.end()) {
+                    if (mixData.second.firstClipId > -1 && !isMoving(mixData.second.secondClipId)) {
                         // First part of the mix is not moving, delete start mix
                         mixesToDelete.insert({affectedItemId, mixData.second.secondClipId}, current_track_id);
                     }
@@ -2490,9 +2813,7 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
             }
             int target_track_position = current_track_position + d;
             if (target_track_position >= 0 && target_track_position < getTracksCount()) {
-                auto it = m_allTracks.cbegin();
-                std::advance(it, target_track_position);
-                int target_track = (*it)->getId();
+                int target_track = getTrackIndexFromPosition(target_track_position);
                 int target_position = old_position[item.first] + delta_pos;
                 ok = ok && requestClipMove(item.first, target_track, target_position, moveMirrorTracks, updateThisView, finalMove, finalMove, local_undo, local_redo, revertMove, true, oldTrackIds, mixDataArray.contains(item.first) ? mixDataArray.value(item.first) : std::pair<MixInfo,MixInfo>());
             } else {
@@ -2513,9 +2834,7 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
             int target_track_position = current_track_position + d;
 
             if (target_track_position >= 0 && target_track_position < getTracksCount()) {
-                auto it = m_allTracks.cbegin();
-                std::advance(it, target_track_position);
-                int target_track = (*it)->getId();
+                int target_track = getTrackIndexFromPosition(target_track_position);
                 int target_position = old_position[item.first] + delta_pos;
                 ok = ok &&
                      requestCompositionMove(item.first, target_track, old_forced_track[item.first], target_position, updateThisView, finalMove, local_undo, local_redo);
@@ -3627,11 +3946,23 @@ void TimelineModel::registerTrack(std::shared_ptr<TrackModel> track, int pos, bo
     // it now contains the iterator to the inserted element, we store it
     Q_ASSERT(m_iteratorTable.count(id) == 0); // check that id is not used (shouldn't happen)
     m_iteratorTable[id] = it;
+    updateTrackPositions();
     endInsertRows();
     int cache = int(QThread::idealThreadCount()) + int(m_allTracks.size() + 1) * 2;
     mlt_service_cache_set_size(nullptr, "producer_avformat", qMax(4, cache));
 }
 
+void TimelineModel::updateTrackPositions()
+{
+    m_trackPositions.clear();
+    m_trackIdsByPosition.clear();
+    m_trackIdsByPosition.reserve(m_allTracks.size());
+    for (const auto &track : m_allTracks) {
+        m_trackPositions[track->getId()] = int(m_trackIdsByPosition.size());
+        m_trackIdsByPosition.push_back(track->getId());
+    }
+}
+
 void TimelineModel::registerClip(const std::shared_ptr<ClipModel> &clip, bool registerProducer)
 {
     int id = clip->getId();
@@ -3646,6 +3977,7 @@ void TimelineModel::registerSubtitle(int id, GenTime startTime, bool temporary)
 {
     Q_ASSERT(m_allSubtitles.count(id) == 0);
     m_allSubtitles.emplace(id, startTime);
+    m_subtitlesByStart[startTime] = id;
     if (!temporary) {
         m_groups->createGroupItem(id);
     }
@@ -3662,12 +3994,27 @@ void TimelineModel::deregisterSubtitle(int id, bool temporary)
     if (!temporary && m_subtitleModel->isSelected(id)) {
         requestClearSelection(true);
     }
+    auto startIndex = m_subtitlesByStart.find(m_allSubtitles.at(id));
+    if (startIndex != m_subtitlesByStart.end() && startIndex->second == id) {
+        m_subtitlesByStart.erase(startIndex);
+    }
     m_allSubtitles.erase(id);
     if (!temporary) {
         m_groups->destructGroupItem(id);
     }
 }
 
+void TimelineModel::updateSubtitleStart(int id, GenTime startTime)
+{
+    Q_ASSERT(m_allSubtitles.count(id) > 0);
+    auto startIndex = m_subtitlesByStart.find(m_allSubtitles.at(id));
+    if (startIndex != m_subtitlesByStart.end() && startIndex->second == id) {
+        m_subtitlesByStart.erase(startIndex);
+    }
+    m_allSubtitles[id] = startTime;
+    m_subtitlesByStart[startTime] = id;
+}
+
 void TimelineModel::registerGroup(int groupId)
 {
     Q_ASSERT(m_allGroups.count(groupId) == 0);
@@ -3690,6 +4037,7 @@ Fun TimelineModel::deregisterTrack_lambda(int id)
         m_allTracks.erase(it);
         // clean table
         m_iteratorTable.erase(id);
+        updateTrackPositions();
         // Finish operation
         endRemoveRows();
         if (!m_closing) {
@@ -3962,17 +4310,12 @@ int TimelineModel::getBestSnapPos(int referencePos, int diff, std::vector<int> p
     pts.erase( std::unique(pts.begin(), pts.end()), pts.end());
     m_snaps->addPoint(cursorPosition);
     int closest = -1;
-    int lowestDiff = snapDistance + 1;
-    for (int point : pts) {
-        int snapped = m_snaps->getClosestPoint(point + diff);
-        int currentDiff = qAbs(point + diff - snapped);
-        if (currentDiff < lowestDiff) {
-            lowestDiff = currentDiff;
-            closest = snapped - (point - referencePos);
-            if (lowestDiff < 2) {
-                break;
-            }
-        }
+    for (int &point : pts) {
+        point += diff;
+    }
+    std::pair<int, int> snapped = m_snaps->getClosestPoint(pts, snapDistance);
+    if (snapped.second != -1) {
+        closest = snapped.second - (snapped.first - diff - referencePos);
     }
     if (m_editMode == TimelineMode::NormalEdit) {
         m_snaps->unIgnore();
@@ -4450,6 +4793,27 @@ bool TimelineModel::unplantComposition(int compoId)
     return ret != 0;
 }
 
+TimelineModel::NotificationsBatch::NotificationsBatch(TimelineModel *model)
+    : m_model(model)
+{
+    m_model->m_notificationsBatch++;
+}
+
+TimelineModel::NotificationsBatch::~NotificationsBatch()
+{
+    if (--m_model->m_notificationsBatch == 0) {
+        m_model->flushNotifications();
+    }
+}
+
+Fun TimelineModel::batchNotifications(const Fun &operation)
+{
+    return [this, operation]() {
+        NotificationsBatch batch(this);
+        return operation();
+    };
+}
+
 bool TimelineModel::checkConsistency()
 {
     // We store all in/outs of clips to check snap points
@@ -4467,6 +4831,12 @@ bool TimelineModel::checkConsistency()
             qWarning() << "NULL parent for track" << tck.first;
             return false;
         }
+        // check the track position cache
+        int trackPos = int(std::distance(m_allTracks.begin(), tck.second));
+        if (getTrackPosition(tck.first) != trackPos || getTrackIndexFromPosition(trackPos) != tck.first) {
+            qWarning() << "Wrong cached position for track" << tck.first;
+            return false;
+        }
         // check consistency of track
         if (!track->checkConsistency()) {
             qWarning() << "Consistency check failed for track" << tck.first;
@@ -4692,6 +5062,19 @@ std::shared_ptr<EffectStackModel> TimelineModel::getClipEffectStackModel(int cli
     return std::static_pointer_cast<EffectStackModel>(m_allClips.at(clipId)->m_effectStack);
 }
 
+std::vector<std::shared_ptr<EffectStackModel>> TimelineModel::getClipEffectStackModels() const
+{
+    READ_LOCK();
+    std::vector<std::shared_ptr<EffectStackModel>> stacks;
+    stacks.reserve(m_allClips.size());
+    for (const auto &clip : m_allClips) {
+        if (clip.second->getCurrentTrackId() != -1) {
+            stacks.push_back(std::static_pointer_cast<EffectStackModel>(clip.second->m_effectStack));
+        }
+    }
+    return stacks;
+}
+
 std::shared_ptr<EffectStackModel> TimelineModel::getClipMixStackModel(int clipId) const
 {
     READ_LOCK();
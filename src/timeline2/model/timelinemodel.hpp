@@ -263,6 +263,8 @@ public:
     std::shared_ptr<AssetParameterModel> getCompositionParameterModel(int compoId) const;
     /** @brief Given a clip Id, returns its underlying effect stack model */
     std::shared_ptr<EffectStackModel> getClipEffectStackModel(int clipId) const;
+    /** @brief Returns the effect stack models of all the clips inserted in a track */
+    std::vector<std::shared_ptr<EffectStackModel>> getClipEffectStackModels() const;
     /** @brief Given a clip Id, returns its mix transition stack model */
     std::shared_ptr<EffectStackModel> getClipMixStackModel(int clipId) const;
 
@@ -431,6 +433,19 @@ public:
     /* Same function, but accumulates undo and redo*/
     bool requestClipInsertion(const QString &binClipId, int trackId, int position, int &id, bool logUndo, bool refreshView, bool useTargets, Fun &undo,
                               Fun &redo, QVector<int> allowedTracks = QVector<int>());
+    /** @brief Insert a list of clips one after the other, starting at the given position.
+       The clips are all checked before modifying the timeline: the bin clips must be ready and the target range must be free on the track, and on its mirror track
+       for the clips with audio and video.
+       Returns true on success, with the ids of the inserted clips. If it fails, nothing is modified and a single undo entry is created otherwise.
+       The clips are inserted in a single pass on the track and on its mirror track, and their audio/video groups are created together. Clips with several
+       audio streams use the regular insertion of each clip.
+       @param binIds ids of the clips in the bin, in the same form as for requestClipInsertion
+       @param trackId Id of the track where to insert
+       @param position Position of the first clip
+    */
+    bool requestClipsInsertion(const QStringList &binIds, int trackId, int position, QList<int> &clipIds, bool logUndo = true, bool refreshView = false);
+    /* Same function, but accumulates undo and redo*/
+    bool requestClipsInsertion(const QStringList &binIds, int trackId, int position, QList<int> &clipIds, bool logUndo, bool refreshView, Fun &undo, Fun &redo);
 
     /** @brief Switch current composition type
      *  @param cid the id of the composition we want to change
@@ -660,6 +675,17 @@ public:
      * @param listCompositions if enabled, the list will also contains composition ids
      */
     std::unordered_set<int> getItemsInRange(int trackId, int start, int end = -1, bool listCompositions = true);
+    /** @brief Returns a hash of what applies to the whole timeline: master and track effects, track visibility, compositing and subtitle style.
+     * @param keyframed is set to true if the master or track effects have keyframes, the content of a range then also depends on its position
+     */
+    QByteArray getTimelineHash(bool &keyframed);
+    /** @brief Returns a hash of everything contributing to the video frames between start and end - 1: clips with their bin source, in/out, speed and
+     * effects, compositions, mixes, subtitles and the timeline hash. Positions are relative to start, so the same content gives the same hash
+     * wherever it is in the timeline, unless the master or track effects have keyframes. Audio tracks are ignored.
+     */
+    QByteArray getRangeHash(int start, int end);
+    /** @brief Same function, reusing a timeline hash computed by getTimelineHash for several ranges */
+    QByteArray getRangeHash(int start, int end, const QByteArray &timelineHash, bool keyframed);
     /** @brief define current project's subtitle model */
     void setSubModel(std::shared_ptr<SubtitleModel> model);
 
@@ -752,6 +778,8 @@ protected:
        @param pos indicates the number of the track we are adding. If this is -1, then we add at the end.
      */
     void registerTrack(std::shared_ptr<TrackModel> track, int pos = -1, bool doInsert = true);
+    /** @brief Renumber the track positions after a track was added or removed */
+    void updateTrackPositions();
 
     /** @brief Register a new clip. This is a call-back meant to be called from ClipModel
      */
@@ -763,6 +791,9 @@ protected:
     
     void registerSubtitle(int id, GenTime startTime, bool temporary = false);
     void deregisterSubtitle(int id, bool temporary = false);
+    /** @brief Update the start position of a registered subtitle, keeping the start position index in sync
+     */
+    void updateSubtitleStart(int id, GenTime startTime);
     /** @brief Returns the index for a subtitle's id (it's position in the list
      */
     int positionForIndex(int id);
@@ -832,6 +863,22 @@ public:
     /** @brief Debugging function that checks consistency with Mlt objects */
     bool checkConsistency();
 
+    /** @brief While a batch exists, the data changes sent through notifyChange are merged by item and role and sent once the outermost batch ends.
+       Row insertions and removals are still sent immediately, since the views must stay in sync with the model structure.
+     */
+    class NotificationsBatch
+    {
+    public:
+        explicit NotificationsBatch(TimelineModel *model);
+        ~NotificationsBatch();
+
+    private:
+        TimelineModel *m_model;
+        Q_DISABLE_COPY(NotificationsBatch)
+    };
+    /** @brief Returns an operation that runs the given one inside a notifications batch, used for the undo/redo of large edits */
+    Fun batchNotifications(const Fun &operation);
+
 protected:
     /** @brief Refresh project monitor if cursor was inside range */
     void checkRefresh(int start, int end);
@@ -867,6 +914,8 @@ protected:
 
     std::unordered_map<int, std::list<std::shared_ptr<TrackModel>>::iterator>
         m_iteratorTable; // this logs the iterator associated which each track id. This allows easy access of a track based on its id.
+    std::unordered_map<int, int> m_trackPositions; // position of each track id in m_allTracks
+    std::vector<int> m_trackIdsByPosition;          // track ids in the order of m_allTracks
 
     std::unordered_map<int, std::shared_ptr<ClipModel>> m_allClips; // the keys are the clip id, and the values are the corresponding pointers
 
@@ -874,6 +923,7 @@ protected:
         m_allCompositions; // the keys are the composition id, and the values are the corresponding pointers
         
     std::map<int, GenTime> m_allSubtitles;
+    std::map<GenTime, int> m_subtitlesByStart; // reverse index of m_allSubtitles, the keys are the subtitle start positions
 
     static int next_id; /// next valid id to assign
 
@@ -930,5 +980,9 @@ protected:
     virtual QModelIndex makeCompositionIndexFromID(int) const = 0;
     virtual QModelIndex makeTrackIndexFromID(int) const = 0;
     virtual void _resetView() = 0;
+    /** @brief Send the data changes collected during a notifications batch */
+    virtual void flushNotifications() = 0;
+    /** @brief Depth of the active notifications batches */
+    int m_notificationsBatch{0};
 };
 #endif
@@ -149,6 +149,7 @@ bool TrackModel::switchPlaylist(int clipId, int position, int sourcePlaylist, in
         clip->setSubPlaylistIndex(destPlaylist, m_id);
         int index = m_playlists[destPlaylist].insert_at(position, *clip, 1);
         m_playlists[destPlaylist].consolidate_blanks();
+        indexClipPosition(clipId, clip->getPosition(), destPlaylist);
         return index != -1;
     }
     return false;
@@ -181,11 +182,13 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
         if (auto ptr = m_parent.lock()) {
             std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
             m_allClips[clip->getId()] = clip; // store clip
+            m_rowsDirty = true;
             // update clip position and track
             clip->setPosition(position);
             if (finalMove) {
                 clip->setSubPlaylistIndex(subPlaylist, m_id);
             }
+            indexClipPosition(clipId, position, subPlaylist);
             int new_in = clip->getPosition();
             int new_out = new_in + clip->getPlaytime();
             ptr->m_snaps->addPoint(new_in);
@@ -322,6 +325,124 @@ bool TrackModel::requestClipInsertion(int clipId, int position, bool updateView,
     return false;
 }
 
+bool TrackModel::requestClipsInsertion(const std::vector<std::pair<int, int>> &clips, bool updateView, Fun &undo, Fun &redo)
+{
+    QWriteLocker locker(&m_lock);
+    if (isLocked() || clips.empty()) {
+        return false;
+    }
+    auto ptr = m_parent.lock();
+    if (!ptr) {
+        qDebug() << "impossible to get parent timeline";
+        return false;
+    }
+    Fun local_undo = []() { return true; };
+    Fun local_redo = []() { return true; };
+    bool res = true;
+    for (const auto &item : clips) {
+        std::shared_ptr<ClipModel> clip = ptr->getClipPtr(item.first);
+        Q_ASSERT(clip->getCurrentTrackId() == -1 && clip->getSubPlaylistIndex() == 0);
+        if ((isAudioTrack() && !clip->canBeAudio()) || (!isAudioTrack() && !clip->canBeVideo())) {
+            qDebug() << "// ATTEMPTING TO INSERT A CLIP ON A TRACK OF THE WRONG TYPE";
+            res = false;
+            break;
+        }
+        // The range must be free on both playlists
+        int end = item.second + clip->getPlaytime();
+        if (item.second < 0 || getBlankEnd(item.second) < end) {
+            res = false;
+            break;
+        }
+        if (clip->clipState() != PlaylistState::Disabled) {
+            res = clip->setClipState(isAudioTrack() ? PlaylistState::AudioOnly : PlaylistState::VideoOnly, local_undo, local_redo);
+            if (!res) {
+                break;
+            }
+        }
+    }
+    if (!res) {
+        bool undone = local_undo();
+        Q_ASSERT(undone);
+        return false;
+    }
+    int duration = trackDuration();
+    Fun operation = [this, clips, updateView]() {
+        if (isLocked()) return false;
+        auto ptr = m_parent.lock();
+        if (!ptr) {
+            qDebug() << "Error : Clip Insertion failed because timeline is not available anymore";
+            return false;
+        }
+        // Lock MLT playlist so that we don't end up with an invalid frame being displayed
+        m_playlists[0].lock();
+        bool inserted = true;
+        for (const auto &item : clips) {
+            std::shared_ptr<ClipModel> clip = ptr->getClipPtr(item.first);
+            clip->setCurrentTrackId(m_id, true);
+            inserted = m_playlists[0].insert_at(item.second, *clip, 1) != -1 && inserted;
+        }
+        m_playlists[0].consolidate_blanks();
+        m_playlists[0].unlock();
+        int zoneStart = -1;
+        int zoneEnd = -1;
+        for (const auto &item : clips) {
+            std::shared_ptr<ClipModel> clip = ptr->getClipPtr(item.first);
+            m_allClips[item.first] = clip;
+            clip->setPosition(item.second);
+            indexClipPosition(item.first, item.second, 0);
+            int new_out = item.second + clip->getPlaytime();
+            ptr->m_snaps->addPoint(item.second);
+            ptr->m_snaps->addPoint(new_out);
+            if (!clip->isAudioOnly()) {
+                zoneStart = zoneStart == -1 ? item.second : qMin(zoneStart, item.second);
+                zoneEnd = qMax(zoneEnd, new_out);
+            }
+        }
+        m_rowsDirty = true;
+        ptr->updateDuration();
+        if (updateView) {
+            // New clips have the highest ids, so their rows follow the existing clips
+            int first_row = getRowfromClip(clips.front().first);
+            for (const auto &item : clips) {
+                first_row = qMin(first_row, getRowfromClip(item.first));
+            }
+            ptr->_beginInsertRows(ptr->makeTrackIndexFromID(m_id), first_row, first_row + int(clips.size()) - 1);
+            ptr->_endInsertRows();
+            if (zoneStart > -1 && !isAudioTrack()) {
+                if (!isHidden()) {
+                    // only refresh monitor if not an audio track and not hidden
+                    ptr->checkRefresh(zoneStart, zoneEnd);
+                }
+                emit ptr->invalidateZone(zoneStart, zoneEnd);
+            }
+        }
+        return inserted;
+    };
+    if (!operation()) {
+        bool undone = local_undo();
+        Q_ASSERT(undone);
+        return false;
+    }
+    // Remove the clips starting with the last one, and check the project duration once
+    Fun reverse = [this]() {
+        if (auto ptr = m_parent.lock()) {
+            ptr->updateDuration();
+        }
+        return true;
+    };
+    for (const auto &item : clips) {
+        Fun deletion = requestClipDeletion_lambda(item.first, updateView, true, true, true);
+        PUSH_FRONT_LAMBDA(deletion, reverse);
+    }
+    if (duration != trackDuration()) {
+        // The insertion changed the track duration, update track effects
+        m_effectStack->adjustStackLength(true, 0, duration, 0, trackDuration(), 0, undo, redo, true);
+    }
+    UPDATE_UNDO_REDO(operation, reverse, local_undo, local_redo);
+    UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+    return true;
+}
+
 void TrackModel::temporaryUnplugClip(int clipId)
 {
     QWriteLocker locker(&m_lock);
@@ -414,6 +535,8 @@ Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool fin
             m_allClips[clipId]->setCurrentTrackId(-1);
             //m_allClips[clipId]->setSubPlaylistIndex(-1);
             m_allClips.erase(clipId);
+            m_rowsDirty = true;
+            unindexClipPosition(clipId);
             delete prod;
             m_playlists[target_track].unlock();
             if (auto ptr = m_parent.lock()) {
@@ -676,6 +799,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
             m_playlists[target_track].insert_blank(blank_index, delta - 1);
             if (!right) {
                 m_allClips[clipId]->setPosition(clip_position + delta);
+                indexClipPosition(clipId, clip_position + delta, target_track);
                 // Because we inserted blank before, the index of our clip has increased
                 target_clip_mutable++;
             }
@@ -759,6 +883,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
                 }
                 if (!right && err == 0) {
                     m_allClips[clipId]->setPosition(m_playlists[target_track].clip_start(target_clip_mutable));
+                    indexClipPosition(clipId, m_allClips[clipId]->getPosition(), target_track);
                 }
                 if (err == 0) {
                     update_snaps(m_allClips[clipId]->getPosition(), m_allClips[clipId]->getPosition() + out - in + 1);
@@ -781,28 +906,62 @@ int TrackModel::getId() const
 int TrackModel::getClipByStartPosition(int position) const
 {
     READ_LOCK();
-    for (auto &clip : m_allClips) {
-        if (clip.second->getPosition() == position) {
-            return clip.second->getId();
+    for (const auto &clipPos : m_clipPos) {
+        auto it = clipPos.find(position);
+        if (it != clipPos.end()) {
+            return it->second;
         }
     }
     return -1;
 }
 
-int TrackModel::getClipByPosition(int position, int playlist)
+void TrackModel::indexClipPosition(int clipId, int position, int playlist)
 {
-    READ_LOCK();
-    QSharedPointer<Mlt::Producer> prod(nullptr);
-    if ((playlist == 0 || playlist == -1) && m_playlists[0].count() > 0) {
-        prod = QSharedPointer<Mlt::Producer>(m_playlists[0].get_clip_at(position));
+    unindexClipPosition(clipId);
+    m_clipPos[playlist][position] = clipId;
+    m_clipPosIndex[clipId] = {playlist, position};
+}
+
+void TrackModel::unindexClipPosition(int clipId)
+{
+    auto it = m_clipPosIndex.find(clipId);
+    if (it == m_clipPosIndex.end()) {
+        return;
     }
-    if (playlist != 0 && (!prod || prod->is_blank()) && m_playlists[1].count() > 0) {
-        prod = QSharedPointer<Mlt::Producer>(m_playlists[1].get_clip_at(position));
+    auto &clipPos = m_clipPos[it->second.first];
+    auto pos = clipPos.find(it->second.second);
+    if (pos != clipPos.end() && pos->second == clipId) {
+        clipPos.erase(pos);
     }
-    if (!prod || prod->is_blank()) {
+    m_clipPosIndex.erase(it);
+}
+
+int TrackModel::clipAtPosition(int position, int playlist) const
+{
+    const auto &clipPos = m_clipPos[playlist];
+    // Clips of a playlist don't overlap, so the only candidate is the last one starting before position
+    auto it = clipPos.upper_bound(position);
+    if (it == clipPos.begin()) {
         return -1;
     }
-    return prod->get_int("_kdenlive_cid");
+    --it;
+    if (position < it->first + m_allClips.at(it->second)->getPlaytime()) {
+        return it->second;
+    }
+    return -1;
+}
+
+int TrackModel::getClipByPosition(int position, int playlist)
+{
+    READ_LOCK();
+    int clipId = -1;
+    if (playlist == 0 || playlist == -1) {
+        clipId = clipAtPosition(position, 0);
+    }
+    if (playlist != 0 && clipId == -1) {
+        clipId = clipAtPosition(position, 1);
+    }
+    return clipId;
 }
 
 QSharedPointer<Mlt::Producer> TrackModel::getClipProducer(int clipId)
@@ -821,41 +980,74 @@ QSharedPointer<Mlt::Producer> TrackModel::getClipProducer(int clipId)
 int TrackModel::getCompositionByPosition(int position)
 {
     READ_LOCK();
-    for (const auto &comp : m_compoPos) {
-        if (comp.first == position) {
-            return comp.second;
-        } else if (comp.first < position) {
-            if (comp.first + m_allCompositions[comp.second]->getPlaytime() >= position) {
-                return comp.second;
-            }
+    // Compositions don't overlap, so only the two last compositions starting before position can match (the end is inclusive)
+    auto it = m_compoPos.upper_bound(position);
+    if (it == m_compoPos.begin()) {
+        return -1;
+    }
+    --it;
+    if (it != m_compoPos.begin()) {
+        auto prev = std::prev(it);
+        if (prev->first + m_allCompositions[prev->second]->getPlaytime() >= position) {
+            return prev->second;
         }
     }
+    if (it->first == position || it->first + m_allCompositions[it->second]->getPlaytime() >= position) {
+        return it->second;
+    }
     return -1;
 }
 
+void TrackModel::updateRows() const
+{
+    if (!m_rowsDirty) {
+        return;
+    }
+    QMutexLocker locker(&m_rowsMutex);
+    if (!m_rowsDirty) {
+        return;
+    }
+    // Clips come first, then compositions, each ordered by id
+    m_itemsByRow.clear();
+    m_itemsByRow.reserve(m_allClips.size() + m_allCompositions.size());
+    m_itemRows.clear();
+    m_itemRows.reserve(m_allClips.size() + m_allCompositions.size());
+    for (const auto &clip : m_allClips) {
+        m_itemRows[clip.first] = int(m_itemsByRow.size());
+        m_itemsByRow.push_back(clip.first);
+    }
+    for (const auto &compo : m_allCompositions) {
+        m_itemRows[compo.first] = int(m_itemsByRow.size());
+        m_itemsByRow.push_back(compo.first);
+    }
+    m_rowsDirty = false;
+}
+
 int TrackModel::getClipByRow(int row) const
 {
     READ_LOCK();
-    if (row >= static_cast<int>(m_allClips.size())) {
+    if (row < 0 || row >= static_cast<int>(m_allClips.size())) {
         return -1;
     }
-    auto it = m_allClips.cbegin();
-    std::advance(it, row);
-    return (*it).first;
+    updateRows();
+    return m_itemsByRow[size_t(row)];
 }
 
 std::unordered_set<int> TrackModel::getClipsInRange(int position, int end)
 {
     READ_LOCK();
     std::unordered_set<int> ids;
-    for (const auto &clp : m_allClips) {
-        int pos = clp.second->getPosition();
-        int length = clp.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
+    for (const auto &clipPos : m_clipPos) {
+        auto it = clipPos.upper_bound(position);
+        if (it != clipPos.begin()) {
+            // The previous clip may overlap the start of the range
+            auto prev = std::prev(it);
+            if (prev->first + m_allClips.at(prev->second)->getPlaytime() - 1 >= position) {
+                it = prev;
+            }
         }
-        if (pos >= position || pos + length - 1 >= position) {
-            ids.insert(clp.first);
+        for (; it != clipPos.end() && (end < 0 || it->first < end); ++it) {
+            ids.insert(it->second);
         }
     }
     return ids;
@@ -865,7 +1057,8 @@ int TrackModel::getRowfromClip(int clipId) const
 {
     READ_LOCK();
     Q_ASSERT(m_allClips.count(clipId) > 0);
-    return int(std::distance(m_allClips.begin(), m_allClips.find(clipId)));
+    updateRows();
+    return m_itemRows.at(clipId);
 }
 
 std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end)
@@ -873,17 +1066,17 @@ std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end
     READ_LOCK();
     // TODO: this function doesn't take into accounts the fact that there are two tracks
     std::unordered_set<int> ids;
-    for (const auto &compo : m_allCompositions) {
-        int pos = compo.second->getPosition();
-        int length = compo.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
-        }
-        if (pos >= position || pos + length - 1 >= position) {
-            
-            ids.insert(compo.first);
+    auto it = m_compoPos.upper_bound(position);
+    if (it != m_compoPos.begin()) {
+        // The previous composition may overlap the start of the range
+        auto prev = std::prev(it);
+        if (prev->first + m_allCompositions[prev->second]->getPlaytime() - 1 >= position) {
+            it = prev;
         }
     }
+    for (; it != m_compoPos.end() && (end < 0 || it->first < end); ++it) {
+        ids.insert(it->second);
+    }
     return ids;
 }
 
@@ -891,7 +1084,8 @@ int TrackModel::getRowfromComposition(int tid) const
 {
     READ_LOCK();
     Q_ASSERT(m_allCompositions.count(tid) > 0);
-    return int(m_allClips.size()) + int(std::distance(m_allCompositions.begin(), m_allCompositions.find(tid)));
+    updateRows();
+    return m_itemRows.at(tid);
 }
 
 QVariant TrackModel::getProperty(const QString &name) const
@@ -1037,6 +1231,42 @@ bool TrackModel::checkConsistency()
         return false;
     }
 
+    // Check the rows cache
+    int row = 0;
+    for (const auto &c : m_allClips) {
+        if (getRowfromClip(c.first) != row || getClipByRow(row) != c.first) {
+            qDebug() << "Error: wrong row for clip " << c.first;
+            return false;
+        }
+        row++;
+    }
+    for (const auto &c : m_allCompositions) {
+        if (getRowfromComposition(c.first) != row || getCompositionByRow(row) != c.first) {
+            qDebug() << "Error: wrong row for composition " << c.first;
+            return false;
+        }
+        row++;
+    }
+
+    // We now check the clips position index
+    if (m_clipPos[0].size() + m_clipPos[1].size() != m_allClips.size() || m_clipPosIndex.size() != m_allClips.size()) {
+        qDebug() << "Error: the number of indexed clip positions doesn't match number of clips";
+        return false;
+    }
+    for (int pl = 0; pl <= 1; ++pl) {
+        for (const auto &clipPos : m_clipPos[pl]) {
+            if (m_allClips.count(clipPos.second) == 0 || m_allClips[clipPos.second]->getPosition() != clipPos.first) {
+                qDebug() << "Error: the position of clip " << clipPos.second << " is not properly indexed";
+                return false;
+            }
+            int clip_index = m_playlists[pl].get_clip_index_at(clipPos.first);
+            if (m_playlists[pl].is_blank(clip_index) || m_playlists[pl].clip_start(clip_index) != clipPos.first) {
+                qDebug() << "Error: clip " << clipPos.second << " is indexed at position " << clipPos.first << " but not found in playlist " << pl;
+                return false;
+            }
+        }
+    }
+
     // We now check compositions positions
     if (m_allCompositions.size() != m_compoPos.size()) {
         qDebug() << "Error: the number of compositions position doesn't match number of compositions";
@@ -1345,6 +1575,7 @@ Fun TrackModel::requestCompositionDeletion_lambda(int compoId, bool updateView,
         }
         m_allCompositions[compoId]->setCurrentTrackId(-1);
         m_allCompositions.erase(compoId);
+        m_rowsDirty = true;
         m_compoPos.erase(old_in);
         ptr->m_snaps->removePoint(old_in);
         ptr->m_snaps->removePoint(old_out);
@@ -1362,9 +1593,8 @@ int TrackModel::getCompositionByRow(int row) const
         return -1;
     }
     Q_ASSERT(row <= int(m_allClips.size() + m_allCompositions.size()));
-    auto it = m_allCompositions.cbegin();
-    std::advance(it, row - int(m_allClips.size()));
-    return (*it).first;
+    updateRows();
+    return m_itemsByRow.at(size_t(row));
 }
 
 int TrackModel::getCompositionsCount() const
@@ -1388,6 +1618,7 @@ Fun TrackModel::requestCompositionInsertion_lambda(int compoId, int position, bo
             if (auto ptr = m_parent.lock()) {
                 std::shared_ptr<CompositionModel> composition = ptr->getCompositionPtr(compoId);
                 m_allCompositions[composition->getId()] = composition; // store clip
+                m_rowsDirty = true;
                 // update clip position and track
                 composition->setCurrentTrackId(getId());
                 int new_in = position;
@@ -1774,6 +2005,7 @@ bool TrackModel::requestClipMix(std::pair<int, int> clipIds, int mixDuration, bo
                             m_playlists[1].consolidate_blanks();
                             return false;
                         }
+                        indexClipPosition(i.key(), pos, 0);
                     }
                     m_playlists[1].consolidate_blanks();
                 }
@@ -1793,6 +2025,7 @@ bool TrackModel::requestClipMix(std::pair<int, int> clipIds, int mixDuration, bo
                             m_playlists[0].consolidate_blanks();
                             return false;
                         }
+                        indexClipPosition(i.key(), pos, 1);
                     }
                     if (m_sameCompositions.count(i.key()) > 0) {
                         // There is a mix at clip start, adjust direction
@@ -1837,6 +2070,7 @@ bool TrackModel::requestClipMix(std::pair<int, int> clipIds, int mixDuration, bo
                             m_playlists[0].consolidate_blanks();
                             return false;
                         }
+                        indexClipPosition(i.key(), pos, 1);
                     }
                     m_playlists[0].consolidate_blanks();
                 }
@@ -1856,6 +2090,7 @@ bool TrackModel::requestClipMix(std::pair<int, int> clipIds, int mixDuration, bo
                             m_playlists[1].consolidate_blanks();
                             return false;
                         }
+                        indexClipPosition(i.key(), pos, 0);
                     }
                     if (m_sameCompositions.count(i.key()) > 0) {
                         // There is a mix at clip start, adjust direction
@@ -24,8 +24,10 @@
 
 #include "definitions.h"
 #include "undohelper.hpp"
+#include <QMutex>
 #include <QReadWriteLock>
 #include <QSharedPointer>
+#include <atomic>
 #include <memory>
 #include <mlt++/MltPlaylist.h>
 #include <mlt++/MltTractor.h>
@@ -189,6 +191,15 @@ protected:
     bool requestClipInsertion(int clipId, int position, bool updateView, bool finalMove, Fun &undo, Fun &redo, bool groupMove = false, QList<int> allowedClipMixes = {});
     /** @brief This function returns a lambda that performs the requested operation */
     Fun requestClipInsertion_lambda(int clipId, int position, bool updateView, bool finalMove, bool groupMove = false, QList<int> allowedClipMixes = {});
+    /** @brief Performs the insertion of several clips that are not on a track yet, in a single pass on the MLT playlist.
+       The track duration, the view and the monitor are updated once for all the clips.
+       Returns true if the operation succeeded, and otherwise, the track is not modified.
+       @param clips is a list of (clip id, position) pairs, ordered by position. The ranges must be free on the track
+       @param updateView whether we send update to the view
+       @param undo Lambda function containing the current undo stack. Will be updated with current operation
+       @param redo Lambda function containing the current redo queue. Will be updated with current operation
+    */
+    bool requestClipsInsertion(const std::vector<std::pair<int, int>> &clips, bool updateView, Fun &undo, Fun &redo);
 
     /** @brief Performs an deletion of the given clip.
        Returns true if the operation succeeded, and otherwise, the track is not modified.
@@ -331,6 +342,16 @@ protected:
     /** @brief Returns true if this clip has a mix at end */
     bool hasEndMix(int cid) const;
 
+private:
+    /** @brief Store the start position of a clip in the position index of a playlist, replacing its previous entry */
+    void indexClipPosition(int clipId, int position, int playlist);
+    /** @brief Remove a clip from the position index */
+    void unindexClipPosition(int clipId);
+    /** @brief Returns the id of the clip covering position in the given playlist, or -1 */
+    int clipAtPosition(int position, int playlist) const;
+    /** @brief Renumber the rows of clips and compositions if they changed since last call */
+    void updateRows() const;
+
 public slots:
     /*Delete the current track and all its associated clips */
     void slotDelete();
@@ -355,6 +376,16 @@ private:
     std::map<int, int> m_compoPos; // We store the positions of the compositions. In Melt, the compositions are not inserted at the track level, but we keep
                                    // those positions here to check for moves and resize
 
+    std::map<int, int> m_clipPos[2]; // Start position of the clips in each playlist (position -> clip id), so that position queries don't have to walk the
+                                     // Mlt playlists
+    std::unordered_map<int, std::pair<int, int>> m_clipPosIndex; // Position of each clip in m_clipPos, in the form: {playlist, start position}
+
+    // Row of each clip and composition in the item model, renumbered lazily after an insertion or deletion
+    mutable std::vector<int> m_itemsByRow;
+    mutable std::unordered_map<int, int> m_itemRows;
+    mutable std::atomic_bool m_rowsDirty{true};
+    mutable QMutex m_rowsMutex;
+
     mutable QReadWriteLock m_lock; // This is a lock that ensures safety in case of concurrent access
 
 protected:
@@ -30,6 +30,11 @@
 #include <QProcess>
 #include <QStandardPaths>
 #include <QCollator>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QSet>
+
+#include <algorithm>
 
 PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tractor)
     : QObject()
@@ -39,12 +44,12 @@ PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tra
     , m_previewTrack(nullptr)
     , m_overlayTrack(nullptr)
     , m_previewTrackIndex(-1)
+    , m_sceneIndex(0)
     , m_initialized(false)
+    , m_timelineKeyframed(false)
 {
     m_previewGatherTimer.setSingleShot(true);
     m_previewGatherTimer.setInterval(200);
-    QObject::connect(&m_previewProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &PreviewManager::processEnded);
-
 
     // Find path for Kdenlive renderer
 #ifdef Q_OS_WIN
@@ -58,18 +63,13 @@ PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tra
             m_renderer = QStringLiteral("kdenlive_render");
         }
     }
-    connect(this, &PreviewManager::abortPreview, &m_previewProcess, &QProcess::kill, Qt::DirectConnection);
-    connect(&m_previewProcess, &QProcess::readyReadStandardError, this, &PreviewManager::receivedStderr);
 }
 
 PreviewManager::~PreviewManager()
 {
     if (m_initialized) {
         abortRendering();
-        if (m_undoDir.dirName() == QLatin1String("undo")) {
-            m_undoDir.removeRecursively();
-        }
-        if ((pCore->currentDoc()->url().isEmpty() && m_cacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot).isEmpty()) ||
+        if (pCore->currentDoc()->url().isEmpty() ||
             m_cacheDir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot).isEmpty()) {
             if (m_cacheDir.dirName() == QLatin1String("preview")) {
                 m_cacheDir.removeRecursively();
@@ -97,8 +97,7 @@ bool PreviewManager::initialize()
         pCore->displayMessage(i18n("Cannot create folder %1", m_cacheDir.absolutePath()), ErrorMessage);
         return false;
     }
-    if (m_cacheDir.dirName() != QLatin1String("preview") || m_cacheDir == QDir() ||
-        (!m_cacheDir.exists(QStringLiteral("undo")) && !m_cacheDir.mkdir(QStringLiteral("undo"))) || !m_cacheDir.absolutePath().contains(documentId)) {
+    if (m_cacheDir.dirName() != QLatin1String("preview") || m_cacheDir == QDir() || !m_cacheDir.absolutePath().contains(documentId)) {
         pCore->displayMessage(i18n("Something is wrong with cache folder %1", m_cacheDir.absolutePath()), ErrorMessage);
         return false;
     }
@@ -106,16 +105,19 @@ bool PreviewManager::initialize()
         pCore->displayMessage(i18n("Invalid timeline preview parameters"), ErrorMessage);
         return false;
     }
-    m_undoDir = QDir(m_cacheDir.absoluteFilePath(QStringLiteral("undo")));
 
-    // Make sure our cache dirs are inside the temporary folder
-    if (!m_cacheDir.makeAbsolute() || !m_undoDir.makeAbsolute() || !m_undoDir.mkpath(QStringLiteral("."))) {
+    // Make sure our cache dir is inside the temporary folder
+    if (!m_cacheDir.makeAbsolute()) {
         pCore->displayMessage(i18n("Something is wrong with cache folders"), ErrorMessage);
         return false;
     }
+    // Chunks used to be archived per undo step, they are now found by content
+    QDir undoDir = m_cacheDir;
+    if (undoDir.cd(QStringLiteral("undo"))) {
+        undoDir.removeRecursively();
+    }
 
     connect(this, &PreviewManager::cleanupOldPreviews, this, &PreviewManager::doCleanupOldPreviews);
-    connect(doc, &KdenliveDoc::removeInvalidUndo, this, &PreviewManager::slotRemoveInvalidUndo, Qt::DirectConnection);
     m_previewTimer.setSingleShot(true);
     m_previewTimer.setInterval(3000);
     connect(&m_previewTimer, &QTimer::timeout, this, &PreviewManager::startPreviewRender);
@@ -140,7 +142,7 @@ bool PreviewManager::buildPreviewTrack()
     return true;
 }
 
-void PreviewManager::loadChunks(QVariantList previewChunks, QVariantList dirtyChunks, const QDateTime &documentDate)
+void PreviewManager::loadChunks(QVariantList previewChunks, QVariantList dirtyChunks)
 {
     if (previewChunks.isEmpty()) {
         previewChunks = m_renderedChunks;
@@ -148,18 +150,10 @@ void PreviewManager::loadChunks(QVariantList previewChunks, QVariantList dirtyCh
     if (dirtyChunks.isEmpty()) {
         dirtyChunks = m_dirtyChunks;
     }
+    updateTimelineHash();
     for (const auto &frame : qAsConst(previewChunks)) {
-        const QString fileName = m_cacheDir.absoluteFilePath(QStringLiteral("%1.%2").arg(frame.toInt()).arg(m_extension));
-        QFile file(fileName);
-        if (file.exists()) {
-            if (!documentDate.isNull() && QFileInfo(file).lastModified() > documentDate) {
-                // Timeline preview file was created after document, invalidate
-                file.remove();
-                dirtyChunks << frame;
-            } else {
-                gotPreviewRender(frame.toInt(), fileName, 1000);
-            }
-        } else {
+        // The chunk file name depends on its content, so an existing file is always up to date
+        if (!loadCachedChunk(frame.toInt(), 1000)) {
             dirtyChunks << frame;
         }
     }
@@ -184,6 +178,7 @@ void PreviewManager::deletePreviewTrack()
     m_previewTrack = nullptr;
     m_dirtyChunks.clear();
     m_renderedChunks.clear();
+    m_chunkFiles.clear();
     emit m_controller->dirtyChunksChanged();
     emit m_controller->renderedChunksChanged();
     m_tractor->unlock();
@@ -312,99 +307,92 @@ void PreviewManager::invalidatePreviews(const QVariantList chunks)
         m_previewTimer.stop();
         timer = true;
     }
-    KdenliveDoc *doc = pCore->currentDoc();
-    int stackIx = doc->commandStack()->index();
-    int stackMax = doc->commandStack()->count();
-    if (stackIx == stackMax && !m_undoDir.exists(QString::number(stackIx - 1))) {
-        // We just added a new command in stack, archive existing chunks
-        int ix = stackIx - 1;
-        m_undoDir.mkdir(QString::number(ix));
-        bool foundPreviews = false;
-        for (const auto &i : chunks) {
-            QString current = QStringLiteral("%1.%2").arg(i.toInt()).arg(m_extension);
-            if (m_cacheDir.rename(current, QStringLiteral("undo/%1/%2").arg(ix).arg(current))) {
-                foundPreviews = true;
-            }
-        }
-        if (!foundPreviews) {
-            // No preview files found, remove undo folder
-            m_undoDir.rmdir(QString::number(ix));
-        } else {
-            // new chunks archived, cleanup old ones
-            emit cleanupOldPreviews();
-        }
-    } else {
-        // Restore existing chunks, delete others
-        // Check if we just undo the last stack action, then backup, otherwise delete
-        bool lastUndo = false;
-        if (stackIx + 1 == stackMax) {
-            if (!m_undoDir.exists(QString::number(stackMax))) {
-                lastUndo = true;
-                bool foundPreviews = false;
-                m_undoDir.mkdir(QString::number(stackMax));
-                for (const auto &i : chunks) {
-                    QString current = QStringLiteral("%1.%2").arg(i.toInt()).arg(m_extension);
-                    if (m_cacheDir.rename(current, QStringLiteral("undo/%1/%2").arg(stackMax).arg(current))) {
-                        foundPreviews = true;
-                    }
-                }
-                if (!foundPreviews) {
-                    m_undoDir.rmdir(QString::number(stackMax));
-                }
-            }
-        }
-        bool moveFile = true;
-        QDir tmpDir = m_undoDir;
-        if (!tmpDir.cd(QString::number(stackIx))) {
-            moveFile = false;
-        }
-        QVariantList foundChunks;
-        for (const auto &i : chunks) {
-            QString cacheFileName = QStringLiteral("%1.%2").arg(i.toInt()).arg(m_extension);
-            if (!lastUndo) {
-                m_cacheDir.remove(cacheFileName);
-            }
-            if (moveFile) {
-                if (QFile::copy(tmpDir.absoluteFilePath(cacheFileName), m_cacheDir.absoluteFilePath(cacheFileName))) {
-                    foundChunks << i;
-                    m_dirtyChunks.removeAll(i);
-                    m_renderedChunks << i;
-                } else {
-                    qDebug() << "// ERROR PROCESSE CHUNK: " << i << ", " << cacheFileName;
-                }
-            }
+    // Reuse chunks rendered for the same content, for example after an undo or a move
+    int progress = isRendering() ? 1000 * m_processedChunks / m_chunksToRender : 1000;
+    bool foundChunks = false;
+    updateTimelineHash();
+    for (const auto &i : chunks) {
+        if (!m_dirtyChunks.contains(i) || m_chunkHashes.contains(i.toInt())) {
+            // Not dirty anymore or being rendered
+            continue;
         }
-        if (!foundChunks.isEmpty()) {
-            std::sort(foundChunks.begin(), foundChunks.end());
-            emit m_controller->dirtyChunksChanged();
-            emit m_controller->renderedChunksChanged();
-            reloadChunks(foundChunks);
+        if (loadCachedChunk(i.toInt(), progress)) {
+            foundChunks = true;
         }
     }
-    doc->setModified(true);
+    if (foundChunks) {
+        emit m_controller->dirtyChunksChanged();
+    }
+    pCore->currentDoc()->setModified(true);
     if (timer) {
         m_previewTimer.start();
     }
 }
 
+void PreviewManager::updateTimelineHash()
+{
+    m_timelineHash = m_controller->getModel()->getTimelineHash(m_timelineKeyframed);
+}
+
+const QString PreviewManager::chunkHash(int frame) const
+{
+    int chunkSize = KdenliveSettings::timelinechunks();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(m_controller->getModel()->getRangeHash(frame, frame + chunkSize, m_timelineHash, m_timelineKeyframed));
+    // The same content rendered with other parameters is another chunk
+    hash.addData(QStringLiteral("%1 %2 %3").arg(pCore->getCurrentProfilePath(), m_consumerParams.join(QLatin1Char(' '))).arg(chunkSize).toUtf8());
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+const QString PreviewManager::chunkFileName(const QString &hash) const
+{
+    return QStringLiteral("%1.%2").arg(hash, m_extension);
+}
+
+bool PreviewManager::loadCachedChunk(int frame, int progress)
+{
+    const QString fileName = m_cacheDir.absoluteFilePath(chunkFileName(chunkHash(frame)));
+    QFile file(fileName);
+    if (!file.exists()) {
+        return false;
+    }
+    // Mark the file as recently used so it is evicted last
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        file.close();
+    }
+    gotPreviewRender(frame, fileName, progress);
+    return true;
+}
+
 void PreviewManager::doCleanupOldPreviews()
 {
-    if (m_undoDir.dirName() != QLatin1String("undo")) {
+    qint64 budget = qint64(KdenliveSettings::previewcachebudget()) * 1024 * 1024;
+    if (budget <= 0 || m_cacheDir.dirName() != QLatin1String("preview")) {
         return;
     }
-    QStringList dirs = m_undoDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-
-    // Use QCollator to do a natural sorting so that 10 is after 2
-    QCollator collator;
-    collator.setNumericMode(true);
-    std::sort(dirs.begin(), dirs.end(), [&collator](const QString &file1, const QString &file2) { return collator.compare(file1, file2) < 0; });
-    bool ok;
-    while (dirs.count() > 5) {
-        QDir tmp = m_undoDir;
-        QString dirName = dirs.takeFirst();
-        dirName.toInt(&ok);
-        if (ok && tmp.cd(dirName)) {
-            tmp.removeRecursively();
+    QSet<QString> usedFiles;
+    for (const QString &fileName : qAsConst(m_chunkFiles)) {
+        usedFiles << fileName;
+    }
+    for (const QString &hash : qAsConst(m_chunkHashes)) {
+        usedFiles << chunkFileName(hash);
+    }
+    // Least recently used first
+    const QFileInfoList files = m_cacheDir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 total = 0;
+    for (const QFileInfo &info : files) {
+        total += info.size();
+    }
+    for (const QFileInfo &info : files) {
+        if (total <= budget) {
+            break;
+        }
+        if (usedFiles.contains(info.fileName()) || info.suffix() == QLatin1String("mlt")) {
+            continue;
+        }
+        if (QFile::remove(info.absoluteFilePath())) {
+            total -= info.size();
         }
     }
 }
@@ -416,7 +404,7 @@ void PreviewManager::clearPreviewRange(bool resetZones)
     m_tractor->lock();
     bool hasPreview = m_previewTrack != nullptr;
     for (const auto &ix : qAsConst(m_renderedChunks)) {
-        m_cacheDir.remove(QStringLiteral("%1.%2").arg(ix.toInt()).arg(m_extension));
+        m_cacheDir.remove(m_chunkFiles.take(ix.toInt()));
         if (!m_dirtyChunks.contains(ix)) {
             m_dirtyChunks << ix;
         }
@@ -468,18 +456,19 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
     if (add) {
         qDebug() << "CHUNKS CHANGED: " << m_dirtyChunks;
         emit m_controller->dirtyChunksChanged();
-        if (m_previewProcess.state() == QProcess::NotRunning && KdenliveSettings::autopreview()) {
+        if (!isRendering() && KdenliveSettings::autopreview()) {
             m_previewTimer.start();
         }
     } else {
         // Remove processed chunks
-        bool isRendering = m_previewProcess.state() != QProcess::NotRunning;
+        bool wasRendering = isRendering();
         m_previewGatherTimer.stop();
         abortRendering();
         m_tractor->lock();
         bool hasPreview = m_previewTrack != nullptr;
         for (int ix : qAsConst(toRemove)) {
-            m_cacheDir.remove(QStringLiteral("%1.%2").arg(ix).arg(m_extension));
+            // Keep the file in the cache, it will be reused if the zone is added back
+            m_chunkFiles.remove(ix);
             if (!hasPreview) {
                 continue;
             }
@@ -495,27 +484,38 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
         emit m_controller->renderedChunksChanged();
         emit m_controller->dirtyChunksChanged();
         m_tractor->unlock();
-        if (isRendering || KdenliveSettings::autopreview()) {
+        if (wasRendering || KdenliveSettings::autopreview()) {
             m_previewTimer.start();
         }
     }
 }
 
+bool PreviewManager::isRendering() const
+{
+    return !m_workers.isEmpty();
+}
+
 void PreviewManager::abortRendering()
 {
-    if (m_previewProcess.state() == QProcess::NotRunning) {
+    if (!isRendering()) {
         return;
     }
-    emit abortPreview();
-    m_previewProcess.waitForFinished();
-    if (m_previewProcess.state() != QProcess::NotRunning) {
-        m_previewProcess.kill();
-        m_previewProcess.waitForFinished();
-    }
+    stopWorkers();
     // Re-init time estimation
     emit previewRender(-1, QString(), 1000);
 }
 
+void PreviewManager::stopWorkers()
+{
+    m_chunkQueue.clear();
+    while (!m_workers.isEmpty()) {
+        releaseWorker(m_workers.first(), true);
+    }
+    m_chunkHashes.clear();
+    QFile::remove(m_sceneList);
+    updateWorkingPreview();
+}
+
 void PreviewManager::startPreviewRender()
 {
     QMutexLocker lock(&m_previewMutex);
@@ -528,28 +528,74 @@ void PreviewManager::startPreviewRender()
         m_waitingThumbs.clear();
         // clear log
         m_errorLog.clear();
-        const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
-        pCore->getMonitor(Kdenlive::ProjectMonitor)->sceneList(m_cacheDir.absolutePath(), sceneList);
+        const QString sceneList = saveSceneList();
         m_previewTimer.stop();
         doPreviewRender(sceneList);
     }
 }
 
-void PreviewManager::receivedStderr()
+const QString PreviewManager::saveSceneList()
+{
+    const QString previous = m_sceneList;
+    m_sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview-%1.mlt").arg(++m_sceneIndex));
+    pCore->getMonitor(Kdenlive::ProjectMonitor)->sceneList(m_cacheDir.absolutePath(), m_sceneList);
+    releaseSceneList(previous);
+    return m_sceneList;
+}
+
+void PreviewManager::releaseSceneList(const QString &scene)
+{
+    if (scene.isEmpty() || scene == m_sceneList) {
+        return;
+    }
+    for (const auto *worker : qAsConst(m_workers)) {
+        if (worker->scene == scene) {
+            return;
+        }
+    }
+    QFile::remove(scene);
+}
+
+void PreviewManager::receivedStderr(PreviewWorker *worker)
 {
-    QStringList resultList = QString::fromLocal8Bit(m_previewProcess.readAllStandardError()).split(QLatin1Char('\n'));
+    // Output may arrive in several parts, only parse complete lines
+    worker->stderrBuffer.append(worker->process->readAllStandardError());
+    int lineEnd = worker->stderrBuffer.lastIndexOf('\n');
+    if (lineEnd < 0) {
+        return;
+    }
+    QStringList resultList = QString::fromLocal8Bit(worker->stderrBuffer.left(lineEnd)).split(QLatin1Char('\n'));
+    worker->stderrBuffer.remove(0, lineEnd + 1);
     for (auto &result : resultList) {
         if (result.startsWith(QLatin1String("START:"))) {
-            workingPreview = result.section(QLatin1String("START:"), 1).simplified().toInt();
-            qDebug() << "// GOT START INFO: " << workingPreview;
-            emit m_controller->workingPreviewChanged();
+            qDebug() << "// GOT START INFO: " << result.section(QLatin1String("START:"), 1).simplified().toInt();
         } else if (result.startsWith(QLatin1String("DONE:"))) {
             int chunk = result.section(QLatin1String("DONE:"), 1).simplified().toInt();
-            m_processedChunks++;
-            QString fileName = QStringLiteral("%1.%2").arg(chunk).arg(m_extension);
-            qDebug() << "---------------\nJOB PROGRRESS: " << m_chunksToRender << ", " << m_processedChunks << " = "
-                     << (100 * m_processedChunks / m_chunksToRender);
-            emit previewRender(chunk, m_cacheDir.absoluteFilePath(fileName), 1000 * m_processedChunks / m_chunksToRender);
+            if (chunk != worker->chunk) {
+                continue;
+            }
+            const QString fileName = m_cacheDir.absoluteFilePath(chunkFileName(m_chunkHashes.value(chunk)));
+            // Keep the worker busy while we load the chunk in the timeline
+            dispatchChunk(worker);
+            updateWorkingPreview();
+            // Other chunks with the same content were waiting for this one
+            QList<int> frames;
+            for (auto it = m_chunkHashes.cbegin(); it != m_chunkHashes.cend(); ++it) {
+                if (it.value() == m_chunkHashes.value(chunk) && !isRenderingChunk(it.key())) {
+                    frames << it.key();
+                }
+            }
+            for (int frame : qAsConst(frames)) {
+                m_chunkHashes.remove(frame);
+                m_processedChunks++;
+                qDebug() << "---------------\nJOB PROGRRESS: " << m_chunksToRender << ", " << m_processedChunks << " = "
+                         << (100 * m_processedChunks / m_chunksToRender);
+                emit previewRender(frame, fileName, 1000 * m_processedChunks / m_chunksToRender);
+                if (!m_workers.contains(worker)) {
+                    // The chunk was corrupted and rendering aborted
+                    return;
+                }
+            }
         } else {
             m_errorLog.append(result);
         }
@@ -563,78 +609,194 @@ void PreviewManager::doPreviewRender(const QString &scene)
     if (m_dirtyChunks.isEmpty()) {
         return;
     }
-    Q_ASSERT(m_previewProcess.state() == QProcess::NotRunning);
+    Q_ASSERT(!isRendering());
+    m_sceneList = scene;
+    m_processedChunks = 0;
+    m_chunksToRender = 0;
+    pCore->currentDoc()->previewProgress(0);
+    queueDirtyChunks();
+    startWorkers();
+    if (!isRendering()) {
+        // All chunks were found in the cache
+        QFile::remove(m_sceneList);
+        pCore->currentDoc()->previewProgress(1000);
+    }
+}
 
-    QStringList chunks;
-    for (QVariant &frame : m_dirtyChunks) {
-        chunks << frame.toString();
+bool PreviewManager::isRenderingChunk(int frame) const
+{
+    return std::any_of(m_workers.cbegin(), m_workers.cend(), [frame](const PreviewWorker *worker) { return worker->chunk == frame; });
+}
+
+void PreviewManager::queueDirtyChunks()
+{
+    int chunkSize = KdenliveSettings::timelinechunks();
+    int position = pCore->getTimelinePosition();
+    position -= position % chunkSize;
+    m_chunkQueue.clear();
+    // Only the chunks being rendered keep their hash
+    QHash<int, QString> hashes;
+    QSet<QString> queuedHashes;
+    for (const auto *worker : qAsConst(m_workers)) {
+        if (worker->chunk >= 0) {
+            hashes.insert(worker->chunk, m_chunkHashes.value(worker->chunk));
+            queuedHashes << m_chunkHashes.value(worker->chunk);
+        }
+    }
+    m_chunkHashes = hashes;
+    updateTimelineHash();
+    QList<int> cachedChunks;
+    const QVariantList dirtyChunks = m_dirtyChunks;
+    for (const QVariant &frame : dirtyChunks) {
+        int chunk = frame.toInt();
+        if (m_chunkHashes.contains(chunk)) {
+            continue;
+        }
+        const QString hash = chunkHash(chunk);
+        if (m_cacheDir.exists(chunkFileName(hash))) {
+            cachedChunks << chunk;
+            continue;
+        }
+        m_chunkHashes.insert(chunk, hash);
+        // Chunks with the same content are rendered once
+        if (!queuedHashes.contains(hash)) {
+            queuedHashes << hash;
+            m_chunkQueue << chunk;
+        }
     }
-    m_chunksToRender = m_dirtyChunks.count();
-    m_processedChunks = 0;
+    // Closest chunks first, when at the same distance the one after the cursor wins since playback goes forward
+    std::sort(m_chunkQueue.begin(), m_chunkQueue.end(), [position](int a, int b) {
+        qint64 distA = a >= position ? 2 * qint64(a - position) : 2 * qint64(position - a) + 1;
+        qint64 distB = b >= position ? 2 * qint64(b - position) : 2 * qint64(position - b) + 1;
+        return distA < distB;
+    });
+    m_chunksToRender = m_processedChunks + m_chunkHashes.count();
+    for (int chunk : qAsConst(cachedChunks)) {
+        loadCachedChunk(chunk, m_chunksToRender > 0 ? 1000 * m_processedChunks / m_chunksToRender : 0);
+    }
+    if (!cachedChunks.isEmpty()) {
+        emit m_controller->dirtyChunksChanged();
+    }
+}
+
+void PreviewManager::startWorkers()
+{
+    int maxWorkers = qMax(1, KdenliveSettings::previewworkers());
     int chunkSize = KdenliveSettings::timelinechunks();
-    QStringList args{KdenliveSettings::rendererpath(),
-                     scene,
-                     m_cacheDir.absolutePath(),
-                     QStringLiteral("-split"),
-                     chunks.join(QLatin1Char(',')),
-                     QString::number(chunkSize - 1),
-                     pCore->getCurrentProfilePath(),
-                     m_extension,
-                     m_consumerParams.join(QLatin1Char(' '))};
-    qDebug() << " -  - -STARTING PREVIEW JOBS: " << args;
-    pCore->currentDoc()->previewProgress(0);
-    m_previewProcess.start(m_renderer, args);
-    if (m_previewProcess.waitForStarted()) {
-        qDebug() << " -  - -STARTING PREVIEW JOBS . . . STARTED";
+    while (!m_chunkQueue.isEmpty() && m_workers.count() < maxWorkers) {
+        auto *worker = new PreviewWorker{new QProcess(this), m_sceneList, -1, false, QByteArray()};
+        QStringList args{KdenliveSettings::rendererpath(),
+                         m_sceneList,
+                         m_cacheDir.absolutePath(),
+                         QStringLiteral("-split"),
+                         QStringLiteral("-"),
+                         QString::number(chunkSize - 1),
+                         pCore->getCurrentProfilePath(),
+                         m_extension,
+                         m_consumerParams.join(QLatin1Char(' '))};
+        qDebug() << " -  - -STARTING PREVIEW WORKER: " << args;
+        worker->process->start(m_renderer, args);
+        if (!worker->process->waitForStarted()) {
+            qDebug() << " -  - -PREVIEW WORKER FAILED TO START";
+            worker->process->deleteLater();
+            delete worker;
+            if (m_workers.isEmpty()) {
+                stopWorkers();
+                emit previewRender(0, m_errorLog, -1);
+            }
+            break;
+        }
+        connect(worker->process, &QProcess::readyReadStandardError, this, [this, worker]() { receivedStderr(worker); });
+        connect(worker->process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, worker](int exitCode, QProcess::ExitStatus status) { processEnded(worker, exitCode, status); });
+        m_workers << worker;
+        dispatchChunk(worker);
     }
+    updateWorkingPreview();
 }
 
-void PreviewManager::processEnded(int, QProcess::ExitStatus status)
+void PreviewManager::dispatchChunk(PreviewWorker *worker)
 {
-    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
-    QFile::remove(sceneList);
-    if (status == QProcess::QProcess::CrashExit) {
-        pCore->currentDoc()->previewProgress(-1);
-        if (workingPreview >= 0) {
-            const QString fileName = QStringLiteral("%1.%2").arg(workingPreview).arg(m_extension);
+    if (worker->retired || m_chunkQueue.isEmpty()) {
+        // Closing its input lets the worker exit
+        worker->chunk = -1;
+        worker->process->closeWriteChannel();
+        return;
+    }
+    worker->chunk = m_chunkQueue.takeFirst();
+    // The worker names the chunk file after its content
+    worker->process->write(QStringLiteral("%1 %2\n").arg(worker->chunk).arg(m_chunkHashes.value(worker->chunk)).toUtf8());
+}
+
+void PreviewManager::releaseWorker(PreviewWorker *worker, bool kill)
+{
+    m_workers.removeAll(worker);
+    worker->process->disconnect(this);
+    if (kill) {
+        if (worker->process->state() != QProcess::NotRunning) {
+            worker->process->kill();
+            worker->process->waitForFinished();
+        }
+        if (worker->chunk >= 0) {
+            const QString fileName = chunkFileName(m_chunkHashes.value(worker->chunk));
             if (m_cacheDir.exists(fileName)) {
                 m_cacheDir.remove(fileName);
             }
         }
-    } else {
-        pCore->currentDoc()->previewProgress(1000);
     }
-    workingPreview = -1;
-    emit m_controller->workingPreviewChanged();
+    worker->process->deleteLater();
+    releaseSceneList(worker->scene);
+    delete worker;
 }
 
-void PreviewManager::slotProcessDirtyChunks()
+void PreviewManager::updateWorkingPreview()
 {
-    if (m_dirtyChunks.isEmpty()) {
+    int working = -1;
+    for (const auto *worker : qAsConst(m_workers)) {
+        if (worker->chunk >= 0 && (working < 0 || worker->chunk < working)) {
+            working = worker->chunk;
+        }
+    }
+    if (working != workingPreview) {
+        workingPreview = working;
+        emit m_controller->workingPreviewChanged();
+    }
+}
+
+void PreviewManager::processEnded(PreviewWorker *worker, int exitCode, QProcess::ExitStatus status)
+{
+    if (!worker->stderrBuffer.isEmpty()) {
+        // Last line of output, without line break
+        m_errorLog.append(QString::fromLocal8Bit(worker->stderrBuffer));
+        worker->stderrBuffer.clear();
+    }
+    if (status == QProcess::CrashExit || exitCode != 0) {
+        // Other chunks would fail the same way
+        stopWorkers();
+        pCore->currentDoc()->previewProgress(-1);
         return;
     }
-    invalidatePreviews(m_dirtyChunks);
-    if (KdenliveSettings::autopreview()) {
-        m_previewTimer.start();
+    releaseWorker(worker, false);
+    // A worker started on an outdated timeline leaves room for a new one
+    startWorkers();
+    if (!isRendering()) {
+        QFile::remove(m_sceneList);
+        m_chunkHashes.clear();
+        pCore->currentDoc()->previewProgress(1000);
+        emit cleanupOldPreviews();
     }
 }
 
-void PreviewManager::slotRemoveInvalidUndo(int ix)
+void PreviewManager::slotProcessDirtyChunks()
 {
-    QMutexLocker lock(&m_previewMutex);
-    if (m_undoDir.dirName() != QLatin1String("undo")) {
-        // Make sure we delete correct folder
+    QVariantList chunks;
+    chunks.swap(m_invalidatedChunks);
+    if (m_dirtyChunks.isEmpty()) {
         return;
     }
-    QStringList dirs = m_undoDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-    bool ok;
-    for (const QString &dir : qAsConst(dirs)) {
-        if (dir.toInt(&ok) >= ix && ok) {
-            QDir tmp = m_undoDir;
-            if (tmp.cd(dir)) {
-                tmp.removeRecursively();
-            }
-        }
+    invalidatePreviews(chunks);
+    if (KdenliveSettings::autopreview()) {
+        m_previewTimer.start();
     }
 }
 
@@ -647,16 +809,18 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
     int start = startFrame - startFrame % chunkSize;
     int end = endFrame - endFrame % chunkSize;
 
-    std::sort(m_renderedChunks.begin(), m_renderedChunks.end());
     m_previewGatherTimer.stop();
-    bool stopPreview = m_previewProcess.state() == QProcess::Running;
-    if (m_renderedChunks.isEmpty() || ((workingPreview < m_renderedChunks.first().toInt() || workingPreview > m_renderedChunks.last().toInt()) && (end < m_renderedChunks.first().toInt() || start > m_renderedChunks.last().toInt()))) {
-        // invalidated zone is not in the preview zone, don't stop process
-        stopPreview = false;
-    }
-    if (stopPreview) {
-        abortRendering();
+    // Cancel the chunks being rendered in the invalidated zone, workers busy elsewhere keep going
+    bool cancelled = false;
+    const QList<PreviewWorker *> workers = m_workers;
+    for (PreviewWorker *worker : workers) {
+        if (worker->chunk >= start && worker->chunk <= end) {
+            qDebug() << "// CANCELLING PREVIEW CHUNK: " << worker->chunk;
+            releaseWorker(worker, true);
+            cancelled = true;
+        }
     }
+    bool queued = std::any_of(m_chunkQueue.cbegin(), m_chunkQueue.cend(), [start, end](int chunk) { return chunk >= start && chunk <= end; });
     m_tractor->lock();
     bool chunksChanged = false;
     for (int i = start; i <= end; i += chunkSize) {
@@ -669,11 +833,16 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
             delete prod;
             QVariant val(i);
             m_renderedChunks.removeAll(val);
+            m_chunkFiles.remove(i);
             if (!m_dirtyChunks.contains(val)) {
                 m_dirtyChunks << val;
                 chunksChanged = true;
             }
         }
+        // Once the changes are gathered, look for a rendered chunk matching the new content
+        if (m_dirtyChunks.contains(i) && !m_invalidatedChunks.contains(i)) {
+            m_invalidatedChunks << i;
+        }
     }
     m_tractor->unlock();
     if (chunksChanged) {
@@ -681,33 +850,22 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
         emit m_controller->renderedChunksChanged();
         emit m_controller->dirtyChunksChanged();
     }
-    if (stopPreview) {
-        startPreviewRender();
-    }
-    m_previewGatherTimer.start();
-}
-
-void PreviewManager::reloadChunks(const QVariantList chunks)
-{
-    if (m_previewTrack == nullptr || chunks.isEmpty()) {
-        return;
-    }
-    m_tractor->lock();
-    for (const auto &ix : chunks) {
-        if (m_previewTrack->is_blank_at(ix.toInt())) {
-            QString fileName = m_cacheDir.absoluteFilePath(QStringLiteral("%1.%2").arg(ix.toInt()).arg(m_extension));
-            fileName.prepend(QStringLiteral("avformat:"));
-            Mlt::Producer prod(pCore->getCurrentProfile()->profile(), fileName.toUtf8().constData());
-            if (prod.is_valid()) {
-                // m_ruler->updatePreview(ix, true);
-                prod.set("mlt_service", "avformat-novalidate");
-                prod.set("mute_on_pause", 1);
-                m_previewTrack->insert_at(ix.toInt(), &prod, 1);
+    if (cancelled || (isRendering() && (queued || chunksChanged))) {
+        // Running workers use the previous timeline, let them finish their current chunk and render the rest from the new one
+        for (PreviewWorker *worker : qAsConst(m_workers)) {
+            worker->retired = true;
+            if (worker->chunk < 0) {
+                worker->process->closeWriteChannel();
             }
         }
+        saveSceneList();
+        queueDirtyChunks();
+        startWorkers();
+        if (!isRendering()) {
+            QFile::remove(m_sceneList);
+        }
     }
-    m_previewTrack->consolidate_blanks();
-    m_tractor->unlock();
+    m_previewGatherTimer.start();
 }
 
 void PreviewManager::gotPreviewRender(int frame, const QString &file, int progress)
@@ -734,6 +892,7 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
         if (prod.is_valid()) {
             m_dirtyChunks.removeAll(frame);
             m_renderedChunks << frame;
+            m_chunkFiles.insert(frame, QFileInfo(file).fileName());
             emit m_controller->renderedChunksChanged();
             prod.set("mlt_service", "avformat-novalidate");
             prod.set("mute_on_pause", 1);
@@ -755,12 +914,7 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
 
 void PreviewManager::corruptedChunk(int frame, const QString &fileName)
 {
-    emit abortPreview();
-    m_previewProcess.waitForFinished();
-    if (workingPreview >= 0) {
-        workingPreview = -1;
-        emit m_controller->workingPreviewChanged();
-    }
+    stopWorkers();
     emit previewRender(0, m_errorLog, -1);
     m_cacheDir.remove(fileName);
     if (!m_dirtyChunks.contains(frame)) {
@@ -24,6 +24,7 @@
 
 #include <QDir>
 #include <QFuture>
+#include <QHash>
 #include <QMutex>
 #include <QProcess>
 #include <QTimer>
@@ -41,6 +42,12 @@ class Producer;
     This manager creates an additional video track on top of the current timeline and renders
     chunks (small video files of 25 frames) that are added on this track when rendered.
     This allow us to get a preview with a smooth playback of our project.
+    Chunk files are named after a hash of the timeline content they show, so a chunk
+    is reused wherever and whenever the same content appears, for example after an undo
+    or a move. The cache folder size is kept under a budget by removing the least recently
+    used files.
+    Chunks are rendered by several kdenlive_render workers pulling from a shared queue,
+    sorted so that the chunks closest to the timeline cursor are rendered first.
     Only the preview zone is rendered. Once defined, a preview zone shows as a red line below
     the timeline ruler. As chunks are rendered, the zone turns to green.
  */
@@ -78,11 +85,11 @@ public:
     /** @brief: Returns directory currently used to store the preview files. */
     const QDir getCacheDir() const;
     /** @brief: Load existing ruler chunks. */
-    void loadChunks(QVariantList previewChunks, QVariantList dirtyChunks, const QDateTime &documentDate);
+    void loadChunks(QVariantList previewChunks, QVariantList dirtyChunks);
     int setOverlayTrack(Mlt::Playlist *overlay);
     /** @brief Remove the effect compare overlay track */
     void removeOverlayTrack();
-    /** @brief The current preview chunk being processed, -1 if none */
+    /** @brief The first preview chunk being processed, -1 if none */
     int workingPreview;
     /** @brief Returns the list of existing chunks */
     QPair<QStringList, QStringList> previewChunks() const;
@@ -98,12 +105,34 @@ private:
     int m_previewTrackIndex;
     /** @brief: The kdenlive renderer app. */
     QString m_renderer;
-    /** @brief: The kdenlive timeline preview process. */
-    QProcess m_previewProcess;
+    /** @brief: A kdenlive_render process reading the chunks to render on its standard input. */
+    struct PreviewWorker
+    {
+        QProcess *process;
+        /** @brief: The playlist this worker was started with. */
+        QString scene;
+        /** @brief: The chunk currently sent to the worker, -1 if none. */
+        int chunk;
+        /** @brief: The timeline changed since this worker started, don't send it more chunks. */
+        bool retired;
+        /** @brief: Standard error output received after the last complete line. */
+        QByteArray stderrBuffer;
+    };
+    /** @brief: The running timeline preview processes. */
+    QList<PreviewWorker *> m_workers;
+    /** @brief: Chunks waiting for a worker, closest to the timeline cursor first. */
+    QList<int> m_chunkQueue;
+    /** @brief: Content hash of the chunks queued or being rendered. */
+    QHash<int, QString> m_chunkHashes;
+    /** @brief: File name of the chunks in the preview track. */
+    QHash<int, QString> m_chunkFiles;
+    /** @brief: Dirty chunks waiting for the gather timer to look for a matching rendered chunk. */
+    QVariantList m_invalidatedChunks;
+    /** @brief: The playlist used to start new workers. */
+    QString m_sceneList;
+    int m_sceneIndex;
     /** @brief: The directory used to store the preview files. */
     QDir m_cacheDir;
-    /** @brief: The directory used to store undo history of preview files (child of m_cacheDir). */
-    QDir m_undoDir;
     QMutex m_previewMutex;
     QStringList m_consumerParams;
     QString m_extension;
@@ -120,27 +149,54 @@ private:
     int m_processedChunks;
     /** @brief: The render process output, useful in case of failure */
     QString m_errorLog;
-    /** @brief: After an undo/redo, if we have preview history, use it. */
-    void reloadChunks(const QVariantList chunks);
+    /** @brief: Hash of the parts of the timeline shared by all chunks, computed once per invalidation pass. */
+    QByteArray m_timelineHash;
+    /** @brief: The master or track effects have keyframes, chunk hashes depend on their position. */
+    bool m_timelineKeyframed;
+    /** @brief: Compute the hash of the parts of the timeline shared by all chunks, must be called before chunkHash. */
+    void updateTimelineHash();
+    /** @brief: Returns a hash of the timeline content and rendering parameters of a chunk. */
+    const QString chunkHash(int frame) const;
+    const QString chunkFileName(const QString &hash) const;
+    /** @brief: If a file was rendered for the current content of a chunk, add it to the preview track. */
+    bool loadCachedChunk(int frame, int progress);
     /** @brief: A chunk failed to render, abort. */
     void corruptedChunk(int workingPreview, const QString &fileName);
     /** @brief: Re-enable timeline preview track. */
     void enable();
     /** @brief: Temporarily disable timeline preview track. */
     void disable();
+    /** @brief: Returns true if some chunks are being rendered. */
+    bool isRendering() const;
+    /** @brief: Save the current timeline in a new playlist for the next workers. */
+    const QString saveSceneList();
+    /** @brief: Returns true if a worker is rendering this chunk. */
+    bool isRenderingChunk(int frame) const;
+    /** @brief: Rebuild the chunk queue from the dirty chunks not found in the cache, closest to the timeline cursor first. */
+    void queueDirtyChunks();
+    /** @brief: Start workers until the chunk queue is empty or the configured worker count is reached. */
+    void startWorkers();
+    /** @brief: Send the next queued chunk to a worker, or let it terminate if there is nothing left. */
+    void dispatchChunk(PreviewWorker *worker);
+    /** @brief: Remove a playlist file if no worker uses it anymore. */
+    void releaseSceneList(const QString &scene);
+    /** @brief: Stop a worker, removing the partial file of its current chunk if it is killed. */
+    void releaseWorker(PreviewWorker *worker, bool kill);
+    /** @brief: Kill all workers and clear the chunk queue. */
+    void stopWorkers();
+    /** @brief: Update the chunk displayed as being processed in the ruler. */
+    void updateWorkingPreview();
+    /** @brief: Process preview rendering output. */
+    void receivedStderr(PreviewWorker *worker);
+    void processEnded(PreviewWorker *worker, int exitCode, QProcess::ExitStatus status);
 
 private slots:
-    /** @brief: To avoid filling the hard drive, remove preview undo history after 5 steps. */
+    /** @brief: To avoid filling the hard drive, remove the least recently used chunks above the cache budget. */
     void doCleanupOldPreviews();
     /** @brief: Start the real rendering process. */
     void doPreviewRender(const QString &scene); // std::shared_ptr<Mlt::Producer> sourceProd);
-    /** @brief: If user does an undo, then makes a new timeline operation, delete undo history of more recent stack . */
-    void slotRemoveInvalidUndo(int ix);
     /** @brief: When the timer collecting invalid zones is done, process. */
     void slotProcessDirtyChunks();
-    /** @brief: Process preview rendering output. */
-    void receivedStderr();
-    void processEnded(int, QProcess::ExitStatus status);
 
 public slots:
     /** @brief: Prepare and start rendering. */
@@ -153,7 +209,6 @@ protected:
     QVariantList m_dirtyChunks;
 
 signals:
-    void abortPreview();
     void cleanupOldPreviews();
     void previewRender(int frame, const QString &file, int progress);
 };
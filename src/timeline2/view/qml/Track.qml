@@ -156,7 +156,8 @@ Item{
                 Binding {
                     target: loader.item
                     property: "keyframeModel"
-                    value: model.keyframeModel
+                    // Only query the keyframes of items in the visible part of the timeline, they are built on first access
+                    value: loader.item && model.start * timeline.scaleFactor < scrollView.contentX + scrollView.width && (model.start + model.duration) * timeline.scaleFactor > scrollView.contentX ? model.keyframeModel : undefined
                     when: loader.status == Loader.Ready && loader.item
                 }
                 Binding {
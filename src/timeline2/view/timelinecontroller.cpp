@@ -2017,7 +2017,7 @@ void TimelineController::disablePreview(bool disable)
                 m_timelinePreview->reconnectTrack();
                 m_model->m_tractor->unlock();
             }
-            m_timelinePreview->loadChunks(QVariantList(), QVariantList(), QDateTime());
+            m_timelinePreview->loadChunks(QVariantList(), QVariantList());
             m_usePreview = true;
         }
     }
@@ -2057,7 +2057,7 @@ void TimelineController::resetPreview()
     }
 }
 
-void TimelineController::loadPreview(const QString &chunks, const QString &dirty, const QDateTime &documentDate, int enable)
+void TimelineController::loadPreview(const QString &chunks, const QString &dirty, int enable)
 {
     if (chunks.isEmpty() && dirty.isEmpty()) {
         return;
@@ -2095,7 +2095,7 @@ void TimelineController::loadPreview(const QString &chunks, const QString &dirty
             m_usePreview = true;
             m_model->m_overlayTrackCount = m_timelinePreview->addedTracks();
         }
-        m_timelinePreview->loadChunks(renderedChunks, dirtyChunks, documentDate);
+        m_timelinePreview->loadChunks(renderedChunks, dirtyChunks);
     }
 }
 
@@ -2355,7 +2355,7 @@ void TimelineController::extract(int clipId)
     if (m_model->m_groups->isInGroup(clipId)) {
         int targetRoot = m_model->m_groups->getRootId(clipId);
         if (m_model->isGroup(targetRoot)) {
-            std::unordered_set<int> sub = m_model->m_groups->getLeaves(targetRoot);
+            const std::vector<int> &sub = m_model->m_groups->getLeavesList(targetRoot);
             for (int current_id : sub) {
                 if (current_id == clipId) {
                     continue;
@@ -3015,7 +3015,7 @@ void TimelineController::deleteEffects(int targetId)
     }
     for (int s : sel) {
         if (m_model->isGroup(s)) {
-            std::unordered_set<int> sub = m_model->m_groups->getLeaves(s);
+            const std::vector<int> &sub = m_model->m_groups->getLeavesList(s);
             for (int current_id : sub) {
                 if (m_model->isClip(current_id)) {
                     targetIds.insert(current_id);
@@ -3055,7 +3055,7 @@ void TimelineController::pasteEffects(int targetId)
     }
     for (int s : sel) {
         if (m_model->isGroup(s)) {
-            std::unordered_set<int> sub = m_model->m_groups->getLeaves(s);
+            const std::vector<int> &sub = m_model->m_groups->getLeavesList(s);
             for (int current_id : sub) {
                 if (m_model->isClip(current_id)) {
                     targetIds.insert(current_id);
@@ -3343,7 +3343,7 @@ void TimelineController::updateClipActions()
                     // Check if all clips in the group have have same state (audio or video)
                     int targetRoot = m_model->m_groups->getRootId(item);
                     if (m_model->isGroup(targetRoot)) {
-                        std::unordered_set<int> sub = m_model->m_groups->getLeaves(targetRoot);
+                        const std::vector<int> &sub = m_model->m_groups->getLeavesList(targetRoot);
                         for (int current_id : sub) {
                             if (current_id == item) {
                                 continue;
@@ -3518,13 +3518,12 @@ bool TimelineController::endFakeGroupMove(int clipId, int groupId, int delta_tra
 {
     Q_ASSERT(m_model->m_allGroups.count(groupId) > 0);
     bool ok = true;
-    auto all_items = m_model->m_groups->getLeaves(groupId);
-    Q_ASSERT(all_items.size() > 1);
+    std::vector<int> sorted_clips = m_model->m_groups->getLeavesList(groupId);
+    Q_ASSERT(sorted_clips.size() > 1);
     Fun local_undo = []() { return true; };
     Fun local_redo = []() { return true; };
 
     // Sort clips. We need to delete from right to left to avoid confusing the view
-    std::vector<int> sorted_clips{std::make_move_iterator(std::begin(all_items)), std::make_move_iterator(std::end(all_items))};
     std::sort(sorted_clips.begin(), sorted_clips.end(), [this](const int &clipId1, const int &clipId2) {
         int p1 = m_model->isClip(clipId1) ? m_model->m_allClips[clipId1]->getPosition() : m_model->m_allCompositions[clipId1]->getPosition();
         int p2 = m_model->isClip(clipId2) ? m_model->m_allClips[clipId2]->getPosition() : m_model->m_allCompositions[clipId2]->getPosition();
@@ -3556,9 +3555,7 @@ bool TimelineController::endFakeGroupMove(int clipId, int groupId, int delta_tra
                 int current_track_position = m_model->getTrackPosition(old_trackId);
                 int d = m_model->getTrackById_const(old_trackId)->isAudioTrack() ? audio_delta : video_delta;
                 int target_track_position = current_track_position + d;
-                auto it = m_model->m_allTracks.cbegin();
-                std::advance(it, target_track_position);
-                int target_track = (*it)->getId();
+                int target_track = m_model->getTrackIndexFromPosition(target_track_position);
                 new_track_ids[item] = target_track;
                 old_position[item] = m_model->m_allClips[item]->getPosition();
                 int duration = m_model->m_allClips[item]->getPlaytime();
@@ -65,10 +65,7 @@ Mlt::Properties *TransitionsRepository::getMetadata(const QString &assetId) cons
 
 void TransitionsRepository::parseCustomAssetFile(const QString &file_name, std::unordered_map<QString, Info> &customAssets) const
 {
-    QFile file(file_name);
-    QDomDocument doc;
-    doc.setContent(&file, false);
-    file.close();
+    QDomDocument doc = readAssetFile(file_name);
 
     QDomElement base = doc.documentElement();
     QDomNodeList transitions = doc.elementsByTagName(QStringLiteral("transition"));
@@ -146,6 +143,11 @@ QString TransitionsRepository::assetBlackListPath() const
     return QStringLiteral(":data/blacklisted_transitions.txt");
 }
 
+QString TransitionsRepository::assetCatalogName() const
+{
+    return QStringLiteral("transitions");
+}
+
 QString TransitionsRepository::assetPreferredListPath() const
 {
     // Transitions do not have "Main" filter implemented, so we return an empty
@@ -71,6 +71,9 @@ protected:
     /** @brief Returns the path to the effects' preferred list*/
     QString assetPreferredListPath() const override;
 
+    /** @brief Returns the name of the on-disk catalog cache for these assets*/
+    QString assetCatalogName() const override;
+
     void parseType(QScopedPointer<Mlt::Properties> &metadata, Info &res) override;
 
     /** @brief Returns the metadata associated with the given asset*/
@@ -24,12 +24,98 @@
 #include "logger.hpp"
 #endif
 #include <QDebug>
+#include <climits>
 #include <utility>
+
+namespace {
+// The size of the state captured by a lambda cannot be queried, use the size of a typical capture (a pointer, a few ids and a shared pointer)
+const size_t closureCostEstimate = 64;
+
+size_t operationCost(const Fun &operation)
+{
+    return sizeof(Fun) + sizeof(int) * 2 + UndoSequence::memoryCost(operation);
+}
+} // namespace
+
+UndoSequence::Data &UndoSequence::detach(Fun &sequence)
+{
+    auto *current = sequence.target<UndoSequence>();
+    if (current == nullptr) {
+        UndoSequence created;
+        created.m_data = std::make_shared<Data>();
+        if (sequence) {
+            created.m_data->cost = operationCost(sequence);
+            created.m_data->operations.push_back({std::move(sequence), created.m_data->nextSerial++, Mode::Always});
+        }
+        sequence = std::move(created);
+        current = sequence.target<UndoSequence>();
+    } else if (current->m_data.use_count() > 1) {
+        // The operations are shared with a copy of this sequence, which must not see the modification
+        current->m_data = std::make_shared<Data>(*current->m_data);
+    }
+    return *current->m_data;
+}
+
+void UndoSequence::append(Fun &sequence, const Fun &operation, Mode mode)
+{
+    Q_ASSERT(mode != Mode::Guard);
+    Data &data = detach(sequence);
+    data.cost += operationCost(operation);
+    data.operations.push_back({operation, data.nextSerial++, mode});
+}
+
+void UndoSequence::prepend(Fun &sequence, const Fun &operation, Mode mode)
+{
+    Q_ASSERT(mode != Mode::IfSucceeded);
+    Data &data = detach(sequence);
+    data.cost += operationCost(operation);
+    data.operations.push_front({operation, data.nextSerial++, mode});
+}
+
+int UndoSequence::size(const Fun &function)
+{
+    if (const auto *sequence = function.target<UndoSequence>()) {
+        return int(sequence->m_data->operations.size());
+    }
+    return function ? 1 : 0;
+}
+
+size_t UndoSequence::memoryCost(const Fun &function)
+{
+    if (const auto *sequence = function.target<UndoSequence>()) {
+        return sizeof(Data) + sequence->m_data->cost;
+    }
+    return function ? closureCostEstimate : 0;
+}
+
+bool UndoSequence::operator()() const
+{
+    // Keep a reference on the operations in case one of them modifies this sequence
+    std::shared_ptr<Data> data = m_data;
+    // An operation inserted after another one never depends on its result, so we only need the oldest failure.
+    // IfSucceeded operations are skipped if an older operation failed, and a failed Guard skips all older operations.
+    int firstFailure = INT_MAX;
+    int skipBelow = -1;
+    for (const Operation &operation : data->operations) {
+        if (operation.serial < skipBelow || (operation.mode == Mode::IfSucceeded && firstFailure < operation.serial)) {
+            continue;
+        }
+        if (!operation.function()) {
+            firstFailure = qMin(firstFailure, operation.serial);
+            if (operation.mode == Mode::Guard) {
+                skipBelow = qMax(skipBelow, operation.serial);
+            }
+        }
+    }
+    return firstFailure == INT_MAX;
+}
+
 FunctionalUndoCommand::FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent)
     : QUndoCommand(parent)
     , m_undo(std::move(undo))
     , m_redo(std::move(redo))
     , m_undone(false)
+    , m_cost(sizeof(FunctionalUndoCommand) + UndoSequence::memoryCost(m_undo) + UndoSequence::memoryCost(m_redo))
 {
     setText(text);
 }
@@ -41,13 +127,16 @@ void FunctionalUndoCommand::undo()
     Logger::log_undo(true);
 #endif
     m_undone = true;
+    if (isReleased()) {
+        return;
+    }
     bool res = m_undo();
     Q_ASSERT(res);
 }
 
 void FunctionalUndoCommand::redo()
 {
-    if (m_undone) {
+    if (m_undone && !isReleased()) {
         // qDebug() << "REDOING " <<text();
 #ifdef CRASH_AUTO_TEST
         Logger::log_undo(false);
@@ -56,3 +145,20 @@ void FunctionalUndoCommand::redo()
         Q_ASSERT(res);
     }
 }
+
+size_t FunctionalUndoCommand::memoryCost() const
+{
+    return m_cost;
+}
+
+void FunctionalUndoCommand::release()
+{
+    m_undo = nullptr;
+    m_redo = nullptr;
+    m_cost = sizeof(FunctionalUndoCommand);
+}
+
+bool FunctionalUndoCommand::isReleased() const
+{
+    return !m_undo;
+}
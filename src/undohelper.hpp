@@ -21,25 +21,61 @@
 
 #ifndef UNDOHELPER_H
 #define UNDOHELPER_H
+#include <deque>
 #include <functional>
+#include <memory>
 
 using Fun = std::function<bool(void)>;
 
-/** @brief this macro executes an operation after a given lambda
+/** @brief This class stores a list of undo/redo operations that are executed in order, without recursion.
+  The macros below append (or prepend) operations to an existing sequence instead of wrapping the previous lambda in a new one, so that
+  operations involving thousands of items don't build deeply nested closures. Copies of a sequence share their operations until one of them is modified.
+  Each operation is tagged with its insertion order, which allows to reproduce the short-circuit behavior of the nested lambdas.
  */
-#define PUSH_LAMBDA(operation, lambda)                                                                                                                         \
-    lambda = [lambda, operation]() {                                                                                                                           \
-        bool v = lambda();                                                                                                                                     \
-        return v && operation();                                                                                                                               \
+class UndoSequence
+{
+public:
+    enum class Mode {
+        Always,      /// The operation is executed whatever the result of the other operations
+        IfSucceeded, /// Appended operation, only executed if all operations of the sequence succeeded so far
+        Guard        /// Prepended operation, the rest of the sequence is skipped if it fails
     };
+    /** @brief Add an operation at the end of the sequence, converting the function to a sequence if necessary */
+    static void append(Fun &sequence, const Fun &operation, Mode mode);
+    /** @brief Add an operation at the beginning of the sequence, converting the function to a sequence if necessary */
+    static void prepend(Fun &sequence, const Fun &operation, Mode mode);
+    /** @brief Returns the number of operations stored in the function, 1 if it is not a sequence */
+    static int size(const Fun &function);
+    /** @brief Returns an estimation of the memory (in bytes) used by the operations stored in the function */
+    static size_t memoryCost(const Fun &function);
+
+    bool operator()() const;
+
+private:
+    struct Operation
+    {
+        Fun function;
+        int serial;
+        Mode mode;
+    };
+    struct Data
+    {
+        std::deque<Operation> operations;
+        int nextSerial{0};
+        size_t cost{0};
+    };
+    std::shared_ptr<Data> m_data;
+    /** @brief Returns the operations of the sequence stored in the function, ready to be modified */
+    static Data &detach(Fun &sequence);
+};
+
+/** @brief this macro executes an operation after a given lambda
+ */
+#define PUSH_LAMBDA(operation, lambda) UndoSequence::append(lambda, operation, UndoSequence::Mode::IfSucceeded);
 
 /** @brief this macro executes an operation before a given lambda
  */
-#define PUSH_FRONT_LAMBDA(operation, lambda)                                                                                                                   \
-    lambda = [lambda, operation]() {                                                                                                                           \
-        bool v = operation();                                                                                                                                  \
-        return v && lambda();                                                                                                                                  \
-    };
+#define PUSH_FRONT_LAMBDA(operation, lambda) UndoSequence::prepend(lambda, operation, UndoSequence::Mode::Guard);
 
 #include <QUndoCommand>
 
@@ -54,10 +90,16 @@ public:
     FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent = nullptr);
     void undo() override;
     void redo() override;
+    /** @brief Estimated memory used by the undo and redo operations */
+    size_t memoryCost() const;
+    /** @brief Drop the undo and redo operations to free the state they hold, the command then does nothing. Used when the undo history exceeds its memory budget */
+    void release();
+    bool isReleased() const;
 
 private:
     Fun m_undo, m_redo;
     bool m_undone;
+    size_t m_cost;
 };
 
 #endif
@@ -0,0 +1,120 @@
+#include "test_utils.hpp"
+
+#include "bin/projectfolder.h"
+#include "bin/projectsortproxymodel.h"
+
+#include <QElapsedTimer>
+
+/* Returns true if the proxy displays the bin item with the given id */
+static bool isDisplayed(const std::shared_ptr<ProjectItemModel> &binModel, ProjectSortProxyModel &proxy, const QString &binId)
+{
+    QModelIndex ix = binModel->getIndexFromItem(binModel->getItemByBinId(binId));
+    return proxy.filterAcceptsRow(ix.row(), ix.parent());
+}
+
+TEST_CASE("Bin search filters", "[BinSearch]")
+{
+    auto binModel = pCore->projectItemModel();
+    ProjectSortProxyModel proxy;
+    proxy.setSourceModel(binModel.get());
+
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    QString holidays, beach, mountains, interviews;
+    REQUIRE(binModel->requestAddFolder(holidays, QStringLiteral("Holidays searchtest"), binModel->getRootFolder()->clipId(), undo, redo));
+    REQUIRE(binModel->requestAddFolder(beach, QStringLiteral("Beach"), holidays, undo, redo));
+    REQUIRE(binModel->requestAddFolder(mountains, QStringLiteral("Mountains"), holidays, undo, redo));
+    REQUIRE(binModel->requestAddFolder(interviews, QStringLiteral("Interviews"), binModel->getRootFolder()->clipId(), undo, redo));
+
+    SECTION("Text search is case insensitive and shows parent folders")
+    {
+        proxy.slotSetSearchString(QStringLiteral("bEaCh"));
+        proxy.slotRefilter();
+        REQUIRE(isDisplayed(binModel, proxy, beach));
+        REQUIRE(isDisplayed(binModel, proxy, holidays));
+        REQUIRE_FALSE(isDisplayed(binModel, proxy, mountains));
+        REQUIRE_FALSE(isDisplayed(binModel, proxy, interviews));
+
+        auto ids = binModel->searchItems(QStringLiteral("searchtest"), {}, 0, 0, false);
+        REQUIRE(ids.size() == 1);
+        REQUIRE(ids.count(binModel->getItemByBinId(holidays)->getId()) == 1);
+    }
+
+    SECTION("Renamed items are found under their new name")
+    {
+        Fun renameUndo = []() { return true; };
+        Fun renameRedo = []() { return true; };
+        REQUIRE(binModel->requestRenameFolder(binModel->getFolderByBinId(mountains), QStringLiteral("Alps"), renameUndo, renameRedo));
+        proxy.slotSetSearchString(QStringLiteral("alps"));
+        proxy.slotRefilter();
+        REQUIRE(isDisplayed(binModel, proxy, mountains));
+        REQUIRE(isDisplayed(binModel, proxy, holidays));
+        REQUIRE_FALSE(isDisplayed(binModel, proxy, beach));
+        REQUIRE(binModel->searchItems(QStringLiteral("mountains"), {}, 0, 0, false).count(binModel->getItemByBinId(mountains)->getId()) == 0);
+        renameUndo();
+    }
+
+    SECTION("Clearing the filters displays everything")
+    {
+        proxy.slotSetSearchString(QStringLiteral("no item has this name"));
+        proxy.slotRefilter();
+        REQUIRE_FALSE(isDisplayed(binModel, proxy, holidays));
+        proxy.slotSetSearchString(QString());
+        proxy.slotClearSearchFilters();
+        REQUIRE(isDisplayed(binModel, proxy, holidays));
+        REQUIRE(isDisplayed(binModel, proxy, beach));
+        REQUIRE(isDisplayed(binModel, proxy, interviews));
+    }
+
+    SECTION("Deleted items are removed from the index")
+    {
+        int beachId = binModel->getItemByBinId(beach)->getId();
+        Fun delUndo = []() { return true; };
+        Fun delRedo = []() { return true; };
+        REQUIRE(binModel->requestBinClipDeletion(binModel->getItemByBinId(beach), delUndo, delRedo));
+        REQUIRE(binModel->m_searchIndex.count(beachId) == 0);
+        REQUIRE(binModel->searchItems(QStringLiteral("beach"), {}, 0, 0, false).count(beachId) == 0);
+        delUndo();
+        REQUIRE(binModel->m_searchIndex.count(beachId) == 1);
+    }
+    undo();
+    REQUIRE(binModel->getItemByBinId(holidays) == nullptr);
+}
+
+/* Run with: runTests "[.benchmark][BinSearch]" */
+TEST_CASE("Bin search benchmark", "[.benchmark][BinSearch]")
+{
+    auto binModel = pCore->projectItemModel();
+    ProjectSortProxyModel proxy;
+    proxy.setSourceModel(binModel.get());
+
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    const int folders = 500;
+    const int perFolder = 100;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < folders; ++i) {
+        QString folderId;
+        REQUIRE(binModel->requestAddFolder(folderId, QStringLiteral("Folder %1").arg(i), binModel->getRootFolder()->clipId(), undo, redo));
+        for (int j = 0; j < perFolder; ++j) {
+            QString id;
+            REQUIRE(binModel->requestAddFolder(id, QStringLiteral("Item %1-%2").arg(i).arg(j), folderId, undo, redo));
+        }
+    }
+    qint64 createTime = timer.elapsed();
+
+    const QStringList searches = {QStringLiteral("item 4"), QStringLiteral("item 49"), QStringLiteral("item 499-99"), QStringLiteral("nothing"), QString()};
+    timer.start();
+    for (const QString &search : searches) {
+        proxy.slotSetSearchString(search);
+        proxy.slotRefilter();
+    }
+    qint64 filterTime = timer.elapsed();
+    proxy.slotSetSearchString(QStringLiteral("item 499-99"));
+    proxy.slotRefilter();
+    REQUIRE(proxy.m_acceptedIds.size() == 2);
+    std::cout << "Creating " << folders * (perFolder + 1) << " bin items: " << createTime << "ms, " << searches.size() << " searches: " << filterTime << "ms"
+              << std::endl;
+    undo();
+}
@@ -2,6 +2,8 @@
 #include "doc/docundostack.hpp"
 #include "test_utils.hpp"
 
+#include <QElapsedTimer>
+#include <QFile>
 #include <QString>
 #include <cmath>
 #include <iostream>
@@ -11,6 +13,9 @@
 #include "definitions.h"
 #define private public
 #define protected public
+#include "assets/keyframes/model/keyframemodellist.hpp"
+#include "assets/model/assetcommand.hpp"
+#include "assets/view/assetparameterview.hpp"
 #include "core.h"
 #include "effects/effectsrepository.hpp"
 #include "effects/effectstack/model/effectitemmodel.hpp"
@@ -113,3 +118,413 @@ TEST_CASE("Effects stack", "[Effects]")
         REQUIRE(splitModel->rowCount() == 1);
     }
 }
+
+TEST_CASE("Asset catalog cache", "[Effects]")
+{
+    auto &repository = EffectsRepository::get();
+    auto assets = repository->m_assets;
+    REQUIRE(!assets.empty());
+    const QString key = QStringLiteral("catalog-test");
+    REQUIRE(repository->saveCatalog(key));
+
+    // A catalog built for other services or files is ignored
+    repository->m_assets.clear();
+    REQUIRE_FALSE(repository->loadCatalog(QStringLiteral("other-key")));
+    REQUIRE(repository->m_assets.empty());
+
+    REQUIRE(repository->loadCatalog(key));
+    REQUIRE(repository->m_assets.size() == assets.size());
+    for (const auto &asset : assets) {
+        REQUIRE(repository->exists(asset.first));
+        const auto &cached = repository->m_assets.at(asset.first);
+        REQUIRE(cached.mltId == asset.second.mltId);
+        REQUIRE(cached.name == asset.second.name);
+        REQUIRE(cached.description == asset.second.description);
+        REQUIRE(cached.version == asset.second.version);
+        REQUIRE(int(cached.type) == int(asset.second.type));
+        REQUIRE(cached.xml.isNull() == asset.second.xml.isNull());
+        if (!cached.xml.isNull()) {
+            REQUIRE(cached.xml.tagName() == asset.second.xml.tagName());
+            REQUIRE(cached.xml.elementsByTagName(QStringLiteral("parameter")).count() ==
+                    asset.second.xml.elementsByTagName(QStringLiteral("parameter")).count());
+        }
+    }
+    REQUIRE(repository->getXml(QStringLiteral("sepia")).attribute(QStringLiteral("tag")) == QStringLiteral("sepia"));
+    repository->m_assets = assets;
+    QFile::remove(repository->catalogPath());
+}
+
+TEST_CASE("Shared and linked effects", "[Effects]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    Mlt::Profile pr;
+    std::shared_ptr<Mlt::Producer> source = std::make_shared<Mlt::Producer>(pr, "color", "red");
+    auto sourceStack = EffectStackModel::construct(source, {ObjectType::TimelineClip, 0}, undoStack);
+    REQUIRE(sourceStack->appendEffect(QStringLiteral("sepia")));
+    auto sourceEffect = std::dynamic_pointer_cast<EffectItemModel>(sourceStack->getEffectStackRow(0));
+    sourceEffect->setParameter(QStringLiteral("u"), QStringLiteral("90"));
+
+    // Load the same effect on several clips, as done when opening a project
+    std::vector<std::shared_ptr<Mlt::Producer>> producers;
+    std::vector<std::shared_ptr<EffectStackModel>> stacks;
+    for (int i = 0; i < 3; ++i) {
+        producers.push_back(std::make_shared<Mlt::Producer>(pr, "color", "blue"));
+        stacks.push_back(EffectStackModel::construct(producers.back(), {ObjectType::TimelineClip, i + 1}, undoStack));
+        stacks.back()->importEffects(source, PlaylistState::VideoOnly);
+        REQUIRE(stacks.back()->rowCount() == 1);
+    }
+    auto effectAt = [&stacks](size_t i) { return std::dynamic_pointer_cast<EffectItemModel>(stacks[i]->getEffectStackRow(0)); };
+    const QString u = QStringLiteral("u");
+
+    SECTION("Identical effects share their description")
+    {
+        REQUIRE(effectAt(0)->m_params.at(u).xml == effectAt(1)->m_params.at(u).xml);
+        REQUIRE(effectAt(0)->m_params.at(u).xml == effectAt(2)->m_params.at(u).xml);
+
+        // Editing one of them does not affect the others
+        effectAt(0)->setParameter(u, QStringLiteral("20"));
+        REQUIRE(effectAt(0)->getParam(u).toDouble() == 20.);
+        REQUIRE(effectAt(1)->getParam(u).toDouble() == 90.);
+        REQUIRE(effectAt(1)->data(effectAt(1)->index(0, 0), AssetParameterModel::ValueRole).toDouble() == 90.);
+    }
+
+    SECTION("Linked effects are edited together")
+    {
+        int undoCount = undoStack->count();
+        REQUIRE(effectAt(0)->linkIdenticalEffects(stacks) == 2);
+        REQUIRE(undoStack->count() == undoCount + 1);
+        REQUIRE(effectAt(0)->isLinked());
+        REQUIRE(effectAt(0)->linkedEffects().contains(effectAt(1).get()));
+        REQUIRE(effectAt(0)->linkedEffects().contains(effectAt(2).get()));
+        REQUIRE(QString(effectAt(1)->filter().get("kdenlive:link")) == QString(effectAt(0)->filter().get("kdenlive:link")));
+        // Only the effects of the given stacks are candidates
+        REQUIRE_FALSE(sourceEffect->isLinked());
+
+        auto edit = [&effectAt, &u](size_t i, const QString &value) {
+            auto effect = effectAt(i);
+            pCore->pushUndo(new AssetCommand(effect, effect->index(effect->m_rows.indexOf(u), 0), value));
+        };
+        auto checkValues = [&effectAt, &u](double first, double second, double third) {
+            REQUIRE(effectAt(0)->getParam(u).toDouble() == first);
+            REQUIRE(effectAt(1)->getParam(u).toDouble() == second);
+            REQUIRE(effectAt(2)->getParam(u).toDouble() == third);
+        };
+
+        // A single command edits all the linked effects
+        edit(1, QStringLiteral("20"));
+        REQUIRE(undoStack->count() == undoCount + 2);
+        checkValues(20., 20., 20.);
+        undoStack->undo();
+        checkValues(90., 90., 90.);
+        undoStack->redo();
+        checkValues(20., 20., 20.);
+
+        effectAt(2)->unlink();
+        REQUIRE(undoStack->count() == undoCount + 3);
+        REQUIRE_FALSE(effectAt(2)->isLinked());
+        REQUIRE_FALSE(effectAt(0)->linkedEffects().contains(effectAt(2).get()));
+        edit(0, QStringLiteral("30"));
+        checkValues(30., 30., 20.);
+
+        undoStack->undo();
+        checkValues(20., 20., 20.);
+        undoStack->undo();
+        REQUIRE(effectAt(2)->isLinked());
+        REQUIRE(effectAt(0)->linkedEffects().contains(effectAt(2).get()));
+        undoStack->undo();
+        checkValues(90., 90., 90.);
+        undoStack->undo();
+        for (size_t i = 0; i < stacks.size(); ++i) {
+            REQUIRE_FALSE(effectAt(i)->isLinked());
+        }
+        undoStack->redo();
+        for (size_t i = 0; i < stacks.size(); ++i) {
+            REQUIRE(effectAt(i)->isLinked());
+        }
+        undoStack->redo();
+        checkValues(20., 20., 20.);
+    }
+
+    SECTION("Linked effects rebuilt on change")
+    {
+        // sox and ladspa effects are replugged instead of updated, their changes are propagated too
+        QString rebuiltId;
+        const QVector<QPair<QString, QString>> names = EffectsRepository::get()->getNames();
+        for (const auto &name : names) {
+            if (name.first.startsWith(QLatin1String("sox_")) || name.first.startsWith(QLatin1String("ladspa"))) {
+                rebuiltId = name.first;
+                break;
+            }
+        }
+        if (rebuiltId.isEmpty()) {
+            WARN("No sox or ladspa effect available, skipping");
+        } else {
+            std::vector<std::shared_ptr<EffectStackModel>> audioStacks;
+            for (int i = 0; i < 2; ++i) {
+                producers.push_back(std::make_shared<Mlt::Producer>(pr, "color", "blue"));
+                audioStacks.push_back(EffectStackModel::construct(producers.back(), {ObjectType::TimelineClip, i + 10}, undoStack));
+                REQUIRE(audioStacks.back()->appendEffect(rebuiltId));
+            }
+            auto first = std::dynamic_pointer_cast<EffectItemModel>(audioStacks[0]->getEffectStackRow(0));
+            auto second = std::dynamic_pointer_cast<EffectItemModel>(audioStacks[1]->getEffectStackRow(0));
+            REQUIRE(first->linkIdenticalEffects(audioStacks) == 1);
+            if (first->rowCount() > 0) {
+                QModelIndex index = first->index(0, 0);
+                const QString name = first->data(index, AssetParameterModel::NameRole).toString();
+                const QString previous = second->getParam(name);
+                const QString value = QString::number(previous.toDouble() + 1);
+                pCore->pushUndo(new AssetCommand(first, index, value));
+                REQUIRE(first->getParam(name) == second->getParam(name));
+                REQUIRE(second->getParam(name) != previous);
+                undoStack->undo();
+                REQUIRE(second->getParam(name) == previous);
+            }
+        }
+    }
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Linked keyframed effects", "[Effects]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    Mlt::Profile pr;
+    std::shared_ptr<Mlt::Producer> source = std::make_shared<Mlt::Producer>(pr, "color", "red");
+    auto sourceStack = EffectStackModel::construct(source, {ObjectType::TimelineClip, 0}, undoStack);
+    REQUIRE(sourceStack->appendEffect(QStringLiteral("audiobalance")));
+
+    std::vector<std::shared_ptr<Mlt::Producer>> producers;
+    std::vector<std::shared_ptr<EffectStackModel>> stacks;
+    for (int i = 0; i < 2; ++i) {
+        producers.push_back(std::make_shared<Mlt::Producer>(pr, "color", "blue"));
+        stacks.push_back(EffectStackModel::construct(producers.back(), {ObjectType::TimelineClip, i + 1}, undoStack));
+        stacks.back()->importEffects(source, PlaylistState::AudioOnly);
+        REQUIRE(stacks.back()->rowCount() == 1);
+    }
+    auto first = std::dynamic_pointer_cast<EffectItemModel>(stacks[0]->getEffectStackRow(0));
+    auto second = std::dynamic_pointer_cast<EffectItemModel>(stacks[1]->getEffectStackRow(0));
+    REQUIRE(first->linkIdenticalEffects(stacks) == 1);
+    const QString split = QStringLiteral("split");
+    std::shared_ptr<KeyframeModelList> keyframes = first->getKeyframeModel();
+    std::shared_ptr<KeyframeModelList> linkedKeyframes = second->getKeyframeModel();
+    REQUIRE(linkedKeyframes->count() == 1);
+    const QString initial = second->getParam(split);
+    int undoCount = undoStack->count();
+
+    // Adding a keyframe adds it to the linked effect, in the same undo entry
+    GenTime pos(10, pCore->getCurrentFps());
+    REQUIRE(keyframes->addKeyframe(pos, KeyframeType::Linear));
+    REQUIRE(undoStack->count() == undoCount + 1);
+    REQUIRE(linkedKeyframes->count() == 2);
+    REQUIRE(linkedKeyframes->hasKeyframe(10));
+    REQUIRE(second->getParam(split) == first->getParam(split));
+
+    // Moving it
+    GenTime newPos(20, pCore->getCurrentFps());
+    REQUIRE(keyframes->moveKeyframe(pos, newPos, true));
+    REQUIRE(linkedKeyframes->hasKeyframe(20));
+    REQUIRE_FALSE(linkedKeyframes->hasKeyframe(10));
+
+    // Changing its value from the keyframe widget
+    QModelIndex index = first->index(first->m_rows.indexOf(split), 0);
+    const QString beforeUpdate = second->getParam(split);
+    REQUIRE(keyframes->updateKeyframe(newPos, QVariant(0.2), index));
+    REQUIRE(second->getParam(split) == first->getParam(split));
+    REQUIRE(second->getParam(split) != beforeUpdate);
+
+    // Removing it
+    REQUIRE(keyframes->removeKeyframe(newPos));
+    REQUIRE(linkedKeyframes->count() == 1);
+    REQUIRE(undoStack->count() == undoCount + 4);
+
+    // Undo restores the linked keyframes step by step
+    undoStack->undo();
+    REQUIRE(linkedKeyframes->count() == 2);
+    undoStack->undo();
+    REQUIRE(second->getParam(split) == beforeUpdate);
+    undoStack->undo();
+    REQUIRE(linkedKeyframes->hasKeyframe(10));
+    undoStack->undo();
+    REQUIRE(linkedKeyframes->count() == 1);
+    REQUIRE(second->getParam(split) == initial);
+    undoStack->redo();
+    REQUIRE(linkedKeyframes->count() == 2);
+    REQUIRE(second->getParam(split) == first->getParam(split));
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Batched parameter changes", "[Effects]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    Mlt::Profile pr;
+    std::shared_ptr<Mlt::Producer> producer = std::make_shared<Mlt::Producer>(pr, "color", "red");
+    auto stack = EffectStackModel::construct(producer, {ObjectType::TimelineClip, 0}, undoStack);
+    REQUIRE(stack->appendEffect(QStringLiteral("sepia")));
+    auto effect = std::dynamic_pointer_cast<EffectItemModel>(stack->getEffectStackRow(0));
+    const QString u = QStringLiteral("u");
+    effect->setParameter(u, QStringLiteral("10"));
+    effect->applyPendingUpdates();
+    QModelIndex index = effect->index(effect->m_rows.indexOf(u), 0);
+
+    AssetParameterView view;
+    view.setModel(effect, QSize(), false);
+    int undoCount = undoStack->count();
+
+    // Avoid the periodic report resetting the counters during the test
+    AssetParameterModel::s_statsTimer.start();
+    AssetParameterModel::s_parameterWrites = 0;
+    AssetParameterModel::s_itemRefreshes = 0;
+
+    // A slider drag sends many values, they are queued until the next frame
+    for (int i = 1; i <= 10; ++i) {
+        view.commitChanges(index, QString::number(10 + i * 5), true);
+    }
+    REQUIRE(AssetParameterModel::s_parameterWrites == 0);
+    REQUIRE(undoStack->count() == undoCount);
+
+    view.applyPendingChanges();
+    REQUIRE(undoStack->count() == undoCount + 1);
+    REQUIRE(effect->getParam(u).toDouble() == 60.);
+    REQUIRE(AssetParameterModel::s_parameterWrites == 1);
+
+    effect->applyPendingUpdates();
+    REQUIRE(AssetParameterModel::s_itemRefreshes == 1);
+
+    undoStack->undo();
+    REQUIRE(effect->getParam(u).toDouble() == 10.);
+    undoStack->redo();
+    REQUIRE(effect->getParam(u).toDouble() == 60.);
+
+    view.unsetModel();
+
+    // A view destroyed with changes still queued applies them, without undo entry
+    undoCount = undoStack->count();
+    {
+        AssetParameterView otherView;
+        otherView.setModel(effect, QSize(), false);
+        otherView.commitChanges(index, QStringLiteral("80"), true);
+        REQUIRE(effect->getParam(u).toDouble() == 60.);
+    }
+    REQUIRE(effect->getParam(u).toDouble() == 80.);
+    REQUIRE(undoStack->count() == undoCount);
+    pCore->m_projectManager = nullptr;
+}
+
+/* Resident memory of the process in kB, or 0 if it is unknown */
+static qint64 residentMemory()
+{
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (!status.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    for (const QByteArray &line : status.readAll().split('\n')) {
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+    return 0;
+}
+
+/* Run with: runTests "[.benchmark][Effects]" */
+TEST_CASE("Shared effects memory benchmark", "[.benchmark][Effects]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    // Use the effect with the largest description
+    auto &repository = EffectsRepository::get();
+    QString effectId;
+    int parameters = 0;
+    for (const auto &asset : repository->m_assets) {
+        int count = asset.second.xml.elementsByTagName(QStringLiteral("parameter")).count();
+        if (count > parameters && !asset.second.xml.hasAttribute(QStringLiteral("LC_NUMERIC"))) {
+            parameters = count;
+            effectId = asset.first;
+        }
+    }
+    REQUIRE(!effectId.isEmpty());
+    std::unique_ptr<Mlt::Filter> filter = repository->getEffect(effectId);
+
+    const int clips = 5000;
+    std::vector<QDomElement> descriptions;
+    descriptions.reserve(clips);
+    qint64 memory = residentMemory();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < clips; ++i) {
+        // Previous behavior: a private copy of the description for each clip
+        QDomElement xml = repository->getXml(effectId);
+        QDomNodeList params = xml.elementsByTagName(QStringLiteral("parameter"));
+        for (int j = 0; j < params.count(); ++j) {
+            QDomElement param = params.item(j).toElement();
+            param.setAttribute(QStringLiteral("value"), QString::fromUtf8(filter->get(param.attribute(QStringLiteral("name")).toUtf8().constData())));
+        }
+        descriptions.push_back(xml);
+    }
+    qint64 privateTime = timer.elapsed();
+    qint64 privateMemory = residentMemory() - memory;
+    descriptions.clear();
+
+    memory = residentMemory();
+    timer.start();
+    for (int i = 0; i < clips; ++i) {
+        descriptions.push_back(repository->getSharedXml(effectId, filter.get()));
+    }
+    qint64 sharedTime = timer.elapsed();
+    qint64 sharedMemory = residentMemory() - memory;
+    REQUIRE(descriptions.front() == descriptions.back());
+    descriptions.clear();
+
+    // Full effect stacks loading a shared effect
+    Mlt::Profile pr;
+    std::shared_ptr<Mlt::Producer> source = std::make_shared<Mlt::Producer>(pr, "color", "red");
+    auto sourceStack = EffectStackModel::construct(source, {ObjectType::TimelineClip, 0}, undoStack);
+    REQUIRE(sourceStack->appendEffect(QStringLiteral("sepia")));
+    std::vector<std::shared_ptr<Mlt::Producer>> producers;
+    std::vector<std::shared_ptr<EffectStackModel>> stacks;
+    producers.reserve(clips);
+    stacks.reserve(clips);
+    memory = residentMemory();
+    timer.start();
+    for (int i = 0; i < clips; ++i) {
+        producers.push_back(std::make_shared<Mlt::Producer>(pr, "color", "blue"));
+        stacks.push_back(EffectStackModel::construct(producers.back(), {ObjectType::TimelineClip, i + 1}, undoStack));
+        stacks.back()->importEffects(source, PlaylistState::VideoOnly);
+    }
+    qint64 stackTime = timer.elapsed();
+    qint64 stackMemory = residentMemory() - memory;
+    std::cout << "Description of " << effectId.toStdString() << " (" << parameters << " parameters) for " << clips << " clips: private copies "
+              << privateTime << "ms, " << privateMemory * 1024 / clips << " bytes/clip, shared " << sharedTime << "ms, " << sharedMemory * 1024 / clips
+              << " bytes/clip" << std::endl;
+    std::cout << "Loading a sepia effect on " << clips << " clips: " << stackTime << "ms, " << stackMemory * 1024 / clips << " bytes/clip" << std::endl;
+    pCore->m_projectManager = nullptr;
+}
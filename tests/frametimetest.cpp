@@ -0,0 +1,75 @@
+#include "test_utils.hpp"
+
+#include "frametime.h"
+#include "profiles/profilerepository.hpp"
+#include <QElapsedTimer>
+
+static_assert(FrameTime(30000, 30000, 1001) == FrameTime(30030, 30, 1), "FrameTime comparison must be exact");
+static_assert(FrameTime(24, 24000, 1001).rescaled(48000, 1001).frames() == 48, "FrameTime rescaling must be exact");
+static_assert((FrameTime(10, 25, 1) + FrameTime(20, 50, 1)).frames() == 20, "FrameTime addition must use the left operand timebase");
+
+TEST_CASE("Frame mapping on NTSC rates", "[FrameTime]")
+{
+    const std::vector<std::pair<int, int>> timebases = {{24000, 1001}, {30000, 1001}, {60000, 1001}, {25, 1}, {50, 1}};
+    for (const auto &timebase : timebases) {
+        double fps = double(timebase.first) / timebase.second;
+        bool identical = true;
+        // Up to 10 hours of frames
+        for (int frame = -100; frame < int(fps * 36000); frame += 13) {
+            GenTime time(frame, fps);
+            FrameTime exact = FrameTime::fromGenTime(time, timebase.first, timebase.second);
+            if (exact.frames() != frame || exact.toGenTime().frames(fps) != frame || !(exact.toGenTime() == time)) {
+                identical = false;
+                break;
+            }
+        }
+        REQUIRE(identical);
+    }
+
+    // Exact comparisons between timebases
+    REQUIRE(FrameTime(1001, 30000, 1001) == FrameTime(1001, 60000, 2002));
+    REQUIRE(FrameTime(30000, 30000, 1001) == FrameTime(60000, 60000, 1001));
+    REQUIRE(FrameTime(30000, 30000, 1001) > FrameTime(30029, 30, 1));
+    REQUIRE(FrameTime(30000, 30000, 1001) < FrameTime(30031, 30, 1));
+    // 4320 frames at 23.976 fps is exactly 4504.5 frames at 25 fps, GenTime rounding depends on the floating point error
+    REQUIRE(FrameTime(4320, 24000, 1001).rescaled(25, 1).frames() == 4505);
+    REQUIRE(FrameTime(-3, 25, 1).rescaled(50, 1).frames() == -6);
+    REQUIRE((FrameTime(100, 30000, 1001) - 10).frames() == 90);
+
+    // The cached project timebase matches the profile
+    std::pair<int, int> timebase = pCore->getCurrentTimebase();
+    REQUIRE(timebase.first == pCore->getCurrentProfile()->frame_rate_num());
+    REQUIRE(timebase.second == pCore->getCurrentProfile()->frame_rate_den());
+    REQUIRE(pCore->getCurrentFps() == pCore->getCurrentProfile()->fps());
+
+    // Reloading the profiles, for example after editing the current one, invalidates the cached timebase
+    pCore->m_currentTimebase = (quint64(12) << 32) | 1;
+    REQUIRE(pCore->getCurrentTimebase().first == 12);
+    ProfileRepository::get()->refresh();
+    REQUIRE(pCore->getCurrentTimebase() == timebase);
+}
+
+/* Run with: runTests "[.benchmark][FrameTime]" */
+TEST_CASE("Frame rate lookup benchmark", "[.benchmark][FrameTime]")
+{
+    const int count = 1000000;
+    QElapsedTimer timer;
+    timer.start();
+    double total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += GenTime(i, pCore->getCurrentProfile()->fps()).frames(pCore->getCurrentProfile()->fps());
+    }
+    qint64 profileTime = timer.elapsed();
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        total += GenTime(i, pCore->getCurrentFps()).frames(pCore->getCurrentFps());
+    }
+    qint64 cachedTime = timer.elapsed();
+    timer.start();
+    std::pair<int, int> timebase = pCore->getCurrentTimebase();
+    for (int i = 0; i < count; ++i) {
+        total += FrameTime(i, timebase.first, timebase.second).rescaled(timebase.first, timebase.second).frames();
+    }
+    std::cout << count << " frame conversions: profile lookup " << profileTime << "ms, cached fps " << cachedTime << "ms, FrameTime " << timer.elapsed()
+              << "ms (" << total << ")" << std::endl;
+}
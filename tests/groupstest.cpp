@@ -3,6 +3,7 @@
 #pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
 #pragma GCC diagnostic push
 #include "fakeit.hpp"
+#include <QElapsedTimer>
 #include <iostream>
 #include <unordered_set>
 #define private public
@@ -1343,3 +1344,86 @@ TEST_CASE("Complex Functions", "[GroupsModel]")
     binModel->clean();
     pCore->m_projectManager = nullptr;
 }
+
+/* Run with: runTests "[.benchmark][GroupsModel]" */
+TEST_CASE("Group drag benchmark", "[.benchmark][GroupsModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_group, guideModel, undoStack);
+    QString binId = createProducer(profile_group, "red", binModel, 20, false);
+    int tid1 = TrackModel::construct(timeline);
+    int tid2 = TrackModel::construct(timeline);
+
+    // 1000 pairs of clips, each pair in its own group, all pairs grouped together
+    const int pairs = 1000;
+    std::vector<int> clips;
+    std::unordered_set<int> pairGroups;
+    for (int i = 0; i < pairs; ++i) {
+        int cid1 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+        int cid2 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+        REQUIRE(timeline->requestClipMove(cid1, tid1, i * 20, true, false, false));
+        REQUIRE(timeline->requestClipMove(cid2, tid2, i * 20, true, false, false));
+        pairGroups.insert(timeline->requestClipsGroup({cid1, cid2}, false));
+        clips.push_back(cid1);
+        clips.push_back(cid2);
+    }
+    int groupId = timeline->requestClipsGroup(pairGroups, false);
+    REQUIRE(groupId > -1);
+
+    // Previous implementation, allocating a set on each call to detect cycles
+    auto groups = timeline->m_groups;
+    // Group moves iterate the cached leaves without copying them
+    REQUIRE(&groups->getLeavesList(groupId) == &groups->getLeavesList(groupId));
+    REQUIRE(groups->getLeavesList(groupId).size() == clips.size());
+    auto uncachedRoot = [&groups](int id) {
+        std::unordered_set<int> seen;
+        int father = -1;
+        do {
+            seen.insert(id);
+            father = groups->m_upLink.at(id);
+            if (father != -1) {
+                id = father;
+            }
+        } while (father != -1);
+        return id;
+    };
+    const int rounds = 100;
+    QElapsedTimer timer;
+    timer.start();
+    long sum = 0;
+    for (int i = 0; i < rounds; ++i) {
+        for (int cid : clips) {
+            sum += uncachedRoot(cid);
+        }
+    }
+    qint64 uncached = timer.elapsed();
+    timer.start();
+    for (int i = 0; i < rounds; ++i) {
+        for (int cid : clips) {
+            sum += groups->getRootId(cid);
+        }
+    }
+    std::cout << "Root resolution, " << clips.size() << " items x " << rounds << ": uncached " << uncached << "ms, cached " << timer.elapsed() << "ms (" << sum
+              << ")" << std::endl;
+
+    // Simulate a drag of the whole group
+    const int moves = 50;
+    timer.start();
+    for (int i = 1; i <= moves; ++i) {
+        REQUIRE(timeline->requestGroupMove(clips.front(), groupId, 0, 1, true, false, false));
+    }
+    std::cout << "Group drag, " << clips.size() << " items: " << moves << " moves in " << timer.elapsed() << "ms" << std::endl;
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
@@ -2,6 +2,9 @@
 
 #include "test_utils.hpp"
 
+#include "timeline2/model/builders/meltBuilder.hpp"
+#include <QElapsedTimer>
+
 using namespace fakeit;
 
 bool test_model_equality(const std::shared_ptr<KeyframeModel> &m1, const std::shared_ptr<KeyframeModel> &m2)
@@ -253,3 +256,214 @@ TEST_CASE("Keyframe model", "[KeyframeModel]")
     }
     pCore->m_projectManager = nullptr;
 }
+
+/* Run with: runTests "[.benchmark][KeyframeModel]" */
+TEST_CASE("Keyframe lookup benchmark", "[.benchmark][KeyframeModel]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    Mlt::Profile pr;
+    std::shared_ptr<Mlt::Producer> producer = std::make_shared<Mlt::Producer>(pr, "color", "red");
+    auto effectstack = EffectStackModel::construct(producer, {ObjectType::TimelineClip, 0}, undoStack);
+    effectstack->appendEffect(QStringLiteral("audiobalance"));
+    auto effect = std::dynamic_pointer_cast<EffectItemModel>(effectstack->getEffectStackRow(0));
+    effect->prepareKeyframes();
+    auto model = std::make_shared<KeyframeModel>(effect, effect->index(0, 0), undoStack);
+
+    const int count = 2000;
+    double fps = pCore->getCurrentFps();
+    for (int i = 1; i <= count; ++i) {
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        REQUIRE(model->addKeyframe(GenTime(i * 3, fps), KeyframeType::Linear, i % 100, false, undo, redo));
+    }
+    const int queries = 200000;
+    QElapsedTimer timer;
+    timer.start();
+    int found = 0;
+    for (int i = 0; i < queries; ++i) {
+        found += model->hasKeyframe(i % (count * 3)) ? 1 : 0;
+    }
+    qint64 hasTime = timer.elapsed();
+    timer.start();
+    bool ok;
+    for (int i = 0; i < queries; ++i) {
+        found += model->getNextKeyframe(GenTime(i % (count * 3), fps), &ok).first.frames(fps) > 0 ? 1 : 0;
+    }
+    std::cout << queries << " keyframe lookups in " << count << " keyframes: hasKeyframe " << hasTime << "ms, getNextKeyframe " << timer.elapsed() << "ms ("
+              << found << ")" << std::endl;
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Deferred keyframes of imported effects", "[KeyframeModel]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    Mlt::Profile pr;
+    std::shared_ptr<Mlt::Producer> source = std::make_shared<Mlt::Producer>(pr, "color", "red");
+    auto sourceStack = EffectStackModel::construct(source, {ObjectType::TimelineClip, 0}, undoStack);
+    sourceStack->appendEffect(QStringLiteral("audiobalance"));
+    auto sourceEffect = std::dynamic_pointer_cast<EffectItemModel>(sourceStack->getEffectStackRow(0));
+    sourceEffect->prepareKeyframes();
+    REQUIRE(sourceEffect->getKeyframeModel()->addKeyframe(GenTime(1.), KeyframeType::Linear));
+    REQUIRE(sourceEffect->getKeyframeModel()->count() == 2);
+
+    // Importing the effects, as done when loading a project, does not build the keyframe models
+    std::shared_ptr<Mlt::Producer> producer = std::make_shared<Mlt::Producer>(pr, "color", "blue");
+    auto effectstack = EffectStackModel::construct(producer, {ObjectType::TimelineClip, 1}, undoStack);
+    effectstack->importEffects(source, PlaylistState::AudioOnly);
+    REQUIRE(effectstack->rowCount() == 1);
+    auto effect = std::dynamic_pointer_cast<EffectItemModel>(effectstack->getEffectStackRow(0));
+    REQUIRE(effect->m_keyframes == nullptr);
+
+    // They are built on first access, from the imported filter
+    REQUIRE(effect->getKeyframeModel() != nullptr);
+    REQUIRE(effect->getKeyframeModel()->count() == 2);
+    REQUIRE(effect->hasMoreThanOneKeyframe());
+    pCore->m_projectManager = nullptr;
+}
+
+/* Run with: runTests "[.benchmark][KeyframeModel]" */
+TEST_CASE("Effect import benchmark", "[.benchmark][KeyframeModel]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    Mlt::Profile pr;
+    std::shared_ptr<Mlt::Producer> source = std::make_shared<Mlt::Producer>(pr, "color", "red");
+    auto sourceStack = EffectStackModel::construct(source, {ObjectType::TimelineClip, 0}, undoStack);
+    sourceStack->appendEffect(QStringLiteral("audiobalance"));
+    auto sourceEffect = std::dynamic_pointer_cast<EffectItemModel>(sourceStack->getEffectStackRow(0));
+    sourceEffect->prepareKeyframes();
+    for (int i = 1; i <= 20; ++i) {
+        REQUIRE(sourceEffect->getKeyframeModel()->addKeyframe(GenTime(i * 10, pCore->getCurrentFps()), KeyframeType::Linear));
+    }
+
+    // Same number of effect stacks as the clips of a 50 tracks, 20000 clips project
+    const int clips = 20000;
+    std::vector<std::shared_ptr<Mlt::Producer>> producers;
+    std::vector<std::shared_ptr<EffectStackModel>> stacks;
+    producers.reserve(clips);
+    stacks.reserve(clips);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < clips; ++i) {
+        producers.push_back(std::make_shared<Mlt::Producer>(pr, "color", "blue"));
+        stacks.push_back(EffectStackModel::construct(producers.back(), {ObjectType::TimelineClip, i + 1}, undoStack));
+        stacks.back()->importEffects(source, PlaylistState::AudioOnly);
+    }
+    qint64 importTime = timer.elapsed();
+    timer.start();
+    int keyframes = 0;
+    for (int i = 0; i < 500; ++i) {
+        auto effect = std::dynamic_pointer_cast<EffectItemModel>(stacks[size_t(i)]->getEffectStackRow(0));
+        keyframes += effect->getKeyframeModel()->count();
+    }
+    qint64 visibleTime = timer.elapsed();
+    REQUIRE(keyframes == 500 * 21);
+    std::cout << "Importing effects of " << clips << " clips: " << importTime << "ms, building keyframes of 500 visible clips: " << visibleTime << "ms"
+              << std::endl;
+    pCore->m_projectManager = nullptr;
+}
+
+/* Run with: runTests "[.benchmark][KeyframeModel]" */
+TEST_CASE("Project load benchmark", "[.benchmark][KeyframeModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    Mlt::Profile pr;
+    std::shared_ptr<Mlt::Producer> source = std::make_shared<Mlt::Producer>(pr, "color", "red");
+    auto sourceStack = EffectStackModel::construct(source, {ObjectType::TimelineClip, 0}, undoStack);
+    sourceStack->appendEffect(QStringLiteral("audiobalance"));
+    auto sourceEffect = std::dynamic_pointer_cast<EffectItemModel>(sourceStack->getEffectStackRow(0));
+    sourceEffect->prepareKeyframes();
+    for (int i = 1; i <= 20; ++i) {
+        REQUIRE(sourceEffect->getKeyframeModel()->addKeyframe(GenTime(i * 10, pCore->getCurrentFps()), KeyframeType::Linear));
+    }
+
+    // A 50 tracks, 20000 clips project, each clip has a keyframed effect
+    const int tracks = 50;
+    const int clipsPerTrack = 400;
+    const int length = 250;
+    QString binId = createProducerWithSound(pr, binModel, length);
+    std::shared_ptr<TimelineItemModel> project = TimelineItemModel::construct(&pr, guideModel, undoStack);
+    for (int i = 0; i < tracks; ++i) {
+        int tid = TrackModel::construct(project, -1, -1, QString(), true);
+        for (int j = 0; j < clipsPerTrack; ++j) {
+            int cid = ClipModel::construct(project, binId, -1, PlaylistState::AudioOnly);
+            REQUIRE(project->requestClipMove(cid, tid, j * length, true, false, false));
+            project->m_allClips[cid]->importEffects(source);
+        }
+    }
+
+    // Load it in another timeline, as done when opening the project once its bin clips are loaded
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&pr, guideModel, undoStack);
+    std::unordered_map<QString, QString> binIdCorresp = {{binId, binId}};
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    QElapsedTimer timer;
+    timer.start();
+    REQUIRE(constructTimelineItemsFromMelt(timeline, *project->tractor(), binIdCorresp, undo, redo));
+    qint64 loadTime = timer.elapsed();
+    REQUIRE(timeline->getTracksCount() == tracks);
+    REQUIRE(timeline->getClipsCount() == tracks * clipsPerTrack);
+
+    auto keyframeCount = [](const std::shared_ptr<ClipModel> &clip) {
+        auto effect = std::dynamic_pointer_cast<EffectItemModel>(clip->m_effectStack->getEffectStackRow(0));
+        return effect->getKeyframeModel()->count();
+    };
+    // The first 10 clips of each track are visible
+    const int visibleEnd = 10 * length;
+    timer.start();
+    int keyframes = 0;
+    for (const auto &clip : timeline->m_allClips) {
+        if (clip.second->getPosition() < visibleEnd) {
+            keyframes += keyframeCount(clip.second);
+        }
+    }
+    qint64 visibleTime = timer.elapsed();
+    REQUIRE(keyframes == tracks * 10 * 21);
+    // Keyframes that were built while loading the project before they became lazy
+    timer.start();
+    for (const auto &clip : timeline->m_allClips) {
+        if (clip.second->getPosition() >= visibleEnd) {
+            keyframes += keyframeCount(clip.second);
+        }
+    }
+    qint64 otherTime = timer.elapsed();
+    REQUIRE(keyframes == tracks * clipsPerTrack * 21);
+    std::cout << "Loading " << tracks << " tracks, " << tracks * clipsPerTrack << " clips: " << loadTime << "ms, keyframes of the " << tracks * 10
+              << " visible clips: " << visibleTime << "ms, keyframes of the other clips: " << otherTime << "ms (loading time before lazy keyframes: "
+              << loadTime + visibleTime + otherTime << "ms)" << std::endl;
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
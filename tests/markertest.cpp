@@ -1,6 +1,7 @@
 #include "test_utils.hpp"
 
 #include "kdenlivesettings.h"
+#include <QElapsedTimer>
 #define private public
 #define protected public
 #include "bin/model/markerlistmodel.hpp"
@@ -227,3 +228,36 @@ TEST_CASE("Marker model", "[MarkerListModel]")
     }
     pCore->m_projectManager = nullptr;
 }
+
+/* Run with: runTests "[.benchmark][MarkerListModel]" */
+TEST_CASE("Marker lookup benchmark", "[.benchmark][MarkerListModel]")
+{
+    fps = pCore->getCurrentFps();
+    GenTime::setFps(fps);
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> model = std::make_shared<MarkerListModel>(undoStack, nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, getGuideModel)).AlwaysReturn(model);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    const int count = 5000;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        REQUIRE(model->addMarker(GenTime(i * 10, fps), QStringLiteral("marker %1").arg(i), i % 5));
+    }
+    qint64 addTime = timer.elapsed();
+    const int queries = 100000;
+    timer.start();
+    int found = 0;
+    for (int i = 0; i < queries; ++i) {
+        found += model->hasMarker(i % (count * 10)) ? 1 : 0;
+    }
+    REQUIRE(found == queries / 10);
+    std::cout << "Adding " << count << " markers: " << addTime << "ms, " << queries << " position lookups: " << timer.elapsed() << "ms" << std::endl;
+    pCore->m_projectManager = nullptr;
+}
@@ -1,4 +1,10 @@
 #include "test_utils.hpp"
+#include "macros.hpp"
+
+#include <QElapsedTimer>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 using namespace fakeit;
 std::default_random_engine g(42);
@@ -2064,3 +2070,903 @@ TEST_CASE("Operations under locked tracks", "[Locked]")
     pCore->m_projectManager = nullptr;
 }
 
+TEST_CASE("Track position queries", "[TrackModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+    QString binId = createProducer(profile_model, "red", binModel, 20, false);
+    int tid1 = TrackModel::construct(timeline);
+
+    // Clips of length 20 separated by a blank of 5 frames
+    std::vector<int> clips;
+    for (int i = 0; i < 50; ++i) {
+        int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+        REQUIRE(timeline->requestClipMove(cid, tid1, i * 25));
+        clips.push_back(cid);
+    }
+    REQUIRE(timeline->checkConsistency());
+    auto track = timeline->getTrackById(tid1);
+
+    // Reference implementation, walking all clips
+    auto clipsInRange = [&](int position, int end) {
+        std::unordered_set<int> ids;
+        for (const auto &clp : track->m_allClips) {
+            int pos = clp.second->getPosition();
+            if (end > -1 && pos >= end) {
+                continue;
+            }
+            if (pos + clp.second->getPlaytime() - 1 >= position) {
+                ids.insert(clp.first);
+            }
+        }
+        return ids;
+    };
+    auto checkQueries = [&]() {
+        int length = track->trackDuration() + 10;
+        for (int pos = 0; pos < length; ++pos) {
+            REQUIRE(track->getClipsInRange(pos, pos + 7) == clipsInRange(pos, pos + 7));
+            int expected = -1;
+            for (const auto &clp : track->m_allClips) {
+                if (clp.second->getPosition() <= pos && pos < clp.second->getPosition() + clp.second->getPlaytime()) {
+                    expected = clp.first;
+                }
+            }
+            REQUIRE(track->getClipByPosition(pos) == expected);
+        }
+        REQUIRE(track->getClipsInRange(0, -1) == clipsInRange(0, -1));
+    };
+    checkQueries();
+
+    SECTION("After resize and deletion")
+    {
+        REQUIRE(timeline->requestItemResize(clips[3], 10, false) == 10);
+        REQUIRE(timeline->requestItemResize(clips[7], 12, true) == 12);
+        REQUIRE(timeline->requestItemDeletion(clips[10]));
+        REQUIRE(timeline->requestClipMove(clips[20], tid1, 10 * 25 + 2));
+        REQUIRE(timeline->checkConsistency());
+        checkQueries();
+        undoStack->undo();
+        undoStack->undo();
+        undoStack->undo();
+        undoStack->undo();
+        REQUIRE(timeline->checkConsistency());
+        checkQueries();
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+/* Run with: runTests "[.benchmark][TrackModel]" */
+TEST_CASE("Track range queries benchmark", "[.benchmark][TrackModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+    QString binId = createProducer(profile_model, "red", binModel, 20, false);
+    int tid1 = TrackModel::construct(timeline);
+    const int count = 10000;
+    for (int i = 0; i < count; ++i) {
+        int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+        REQUIRE(timeline->requestClipMove(cid, tid1, i * 20, true, false, false));
+    }
+    auto track = timeline->getTrackById(tid1);
+    const int queries = 100000;
+    size_t found = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < queries; ++i) {
+        int pos = int((i * 7919L) % (count * 20));
+        found += track->getClipsInRange(pos, pos + 100).size();
+    }
+    std::cout << "Range queries, " << count << " clips: " << queries << " queries in " << timer.elapsed() << "ms (" << found << " results)" << std::endl;
+    timer.start();
+    for (int i = 0; i < queries; ++i) {
+        int pos = int((i * 7919L) % (count * 20));
+        found += size_t(track->getClipByPosition(pos));
+    }
+    std::cout << "Point queries, " << count << " clips: " << queries << " queries in " << timer.elapsed() << "ms" << std::endl;
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+/* Run with: runTests "[.benchmark][TimelineItemModel]" */
+TEST_CASE("Model index resolution benchmark", "[.benchmark][TimelineItemModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    QString binId = createProducer(profile_model, "red", binModel, 20, false);
+    for (int count : {1000, 5000, 20000}) {
+        std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+        const int tracks = 20;
+        std::vector<int> trackIds;
+        for (int i = 0; i < tracks; ++i) {
+            trackIds.push_back(TrackModel::construct(timeline));
+        }
+        std::vector<int> clips;
+        for (int i = 0; i < count; ++i) {
+            int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+            REQUIRE(timeline->requestClipMove(cid, trackIds[size_t(i % tracks)], (i / tracks) * 20, true, false, false));
+            clips.push_back(cid);
+        }
+        QElapsedTimer timer;
+        timer.start();
+        long rows = 0;
+        for (int cid : clips) {
+            QModelIndex ix = timeline->makeClipIndexFromID(cid);
+            rows += ix.row() + timeline->data(ix, TimelineModel::StartRole).toInt();
+        }
+        qint64 clipTime = timer.elapsed();
+        timer.start();
+        for (int i = 0; i < count; ++i) {
+            rows += timeline->getTrackMltIndex(trackIds[size_t(i % tracks)]);
+            rows += timeline->getTrackIndexFromPosition(i % tracks);
+        }
+        std::cout << count << " clips: clip index resolution " << clipTime << "ms, track lookups " << timer.elapsed() << "ms (" << rows << ")" << std::endl;
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Batched notifications", "[TimelineItemModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+    QString binId = createProducer(profile_model, "red", binModel, 20, false);
+    int tid1 = TrackModel::construct(timeline);
+
+    std::vector<int> clips;
+    for (int i = 0; i < 10; ++i) {
+        int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+        REQUIRE(timeline->requestClipMove(cid, tid1, i * 20));
+        clips.push_back(cid);
+    }
+    QVector<QPair<QModelIndex, QModelIndex>> changes;
+    QVector<QVector<int>> changedRoles;
+    QObject::connect(timeline.get(), &QAbstractItemModel::dataChanged,
+                     [&](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles) {
+                         changes.push_back({topLeft, bottomRight});
+                         changedRoles.push_back(roles);
+                     });
+
+    SECTION("Changes outside a batch are sent immediately")
+    {
+        for (int cid : clips) {
+            QModelIndex ix = timeline->makeClipIndexFromID(cid);
+            timeline->notifyChange(ix, ix, TimelineModel::StartRole);
+        }
+        REQUIRE(changes.size() == 10);
+    }
+
+    SECTION("Changes on adjacent clips are merged")
+    {
+        {
+            TimelineModel::NotificationsBatch batch(timeline.get());
+            for (int cid : clips) {
+                QModelIndex ix = timeline->makeClipIndexFromID(cid);
+                timeline->notifyChange(ix, ix, TimelineModel::StartRole);
+                timeline->notifyChange(ix, ix, TimelineModel::StartRole);
+            }
+            REQUIRE(changes.isEmpty());
+        }
+        REQUIRE(changes.size() == 1);
+        REQUIRE(changes.first().first == timeline->makeClipIndexFromID(clips.front()));
+        REQUIRE(changes.first().second == timeline->makeClipIndexFromID(clips.back()));
+        REQUIRE(changedRoles.first() == QVector<int>{TimelineModel::StartRole});
+    }
+
+    SECTION("Nested batches and deleted clips")
+    {
+        {
+            TimelineModel::NotificationsBatch batch(timeline.get());
+            {
+                TimelineModel::NotificationsBatch inner(timeline.get());
+                for (int cid : clips) {
+                    QModelIndex ix = timeline->makeClipIndexFromID(cid);
+                    timeline->notifyChange(ix, ix, TimelineModel::DurationRole);
+                }
+            }
+            REQUIRE(changes.isEmpty());
+            REQUIRE(timeline->requestItemDeletion(clips[4]));
+            changes.clear();
+            changedRoles.clear();
+        }
+        // The deleted clip is skipped, the remaining rows are still sent as one range
+        REQUIRE(changes.size() == 1);
+        REQUIRE(changes.first().first == timeline->makeClipIndexFromID(clips.front()));
+        REQUIRE(changes.first().second == timeline->makeClipIndexFromID(clips.back()));
+        REQUIRE(changes.first().second.row() == 8);
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+/* Run with: runTests "[.benchmark][Notifications]" */
+TEST_CASE("Zone extraction notifications benchmark", "[.benchmark][Notifications]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    QString binId = createProducer(profile_model, "red", binModel, 20, false);
+    for (bool batched : {false, true}) {
+        std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+        const int tracks = 10;
+        const int count = 2000;
+        QVector<int> trackIds;
+        for (int i = 0; i < tracks; ++i) {
+            trackIds << TrackModel::construct(timeline);
+        }
+        for (int i = 0; i < count; ++i) {
+            int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+            REQUIRE(timeline->requestClipMove(cid, trackIds[i % tracks], (i / tracks) * 20, true, false, false));
+        }
+        int emitted = 0;
+        QObject::connect(timeline.get(), &QAbstractItemModel::dataChanged, [&emitted]() { emitted++; });
+        QElapsedTimer timer;
+        timer.start();
+        {
+            std::unique_ptr<TimelineModel::NotificationsBatch> batch;
+            if (batched) {
+                batch.reset(new TimelineModel::NotificationsBatch(timeline.get()));
+            }
+            // Remove a zone in the middle of the timeline, which moves all following clips
+            std::function<bool(void)> undo = []() { return true; };
+            std::function<bool(void)> redo = []() { return true; };
+            for (int tid : qAsConst(trackIds)) {
+                REQUIRE(TimelineFunctions::liftZone(timeline, tid, QPoint(1010, 1030), undo, redo));
+            }
+            REQUIRE(TimelineFunctions::removeSpace(timeline, QPoint(1010, 1030), undo, redo, trackIds, false));
+        }
+        std::cout << (batched ? "Batched" : "Unbatched") << " zone extraction, " << count << " clips: " << emitted << " dataChanged signals in "
+                  << timer.elapsed() << "ms" << std::endl;
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+namespace {
+// Number of closures being executed and the deepest nesting reached, to measure the call depth of undo operations
+int s_callDepth = 0;
+int s_maxCallDepth = 0;
+struct CallDepthProbe
+{
+    CallDepthProbe() { s_maxCallDepth = std::max(s_maxCallDepth, ++s_callDepth); }
+    ~CallDepthProbe() { --s_callDepth; }
+};
+
+// Bytes currently allocated on the heap, 0 if it is unknown
+qint64 heapUsage()
+{
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 info = mallinfo2();
+    return qint64(info.uordblks + info.hblkhd);
+#else
+    struct mallinfo info = mallinfo();
+    return qint64(info.uordblks) + qint64(info.hblkhd);
+#endif
+#else
+    return 0;
+#endif
+}
+
+// Reference implementation of the undo macros, nesting a new lambda at each step
+void nestedPush(Fun &lambda, const Fun &operation, int kind)
+{
+    switch (kind) {
+    case 0: // PUSH_LAMBDA
+        lambda = [lambda, operation]() {
+            CallDepthProbe probe;
+            bool v = lambda();
+            return v && operation();
+        };
+        break;
+    case 1: // PUSH_FRONT_LAMBDA
+        lambda = [lambda, operation]() {
+            CallDepthProbe probe;
+            bool v = operation();
+            return v && lambda();
+        };
+        break;
+    case 2: // UPDATE_UNDO_REDO, undo part
+        lambda = [lambda, operation]() {
+            CallDepthProbe probe;
+            bool v = operation();
+            return lambda() && v;
+        };
+        break;
+    default: // UPDATE_UNDO_REDO, redo part
+        lambda = [lambda, operation]() {
+            CallDepthProbe probe;
+            bool v = lambda();
+            return operation() && v;
+        };
+        break;
+    }
+}
+
+void flatPush(Fun &lambda, const Fun &operation, int kind)
+{
+    switch (kind) {
+    case 0:
+        PUSH_LAMBDA(operation, lambda);
+        break;
+    case 1:
+        PUSH_FRONT_LAMBDA(operation, lambda);
+        break;
+    case 2:
+        UndoSequence::prepend(lambda, operation, UndoSequence::Mode::Always);
+        break;
+    default:
+        UndoSequence::append(lambda, operation, UndoSequence::Mode::Always);
+        break;
+    }
+}
+} // namespace
+
+TEST_CASE("Flat undo sequences", "[Undo]")
+{
+    SECTION("Same execution order and result as nested lambdas")
+    {
+        std::uniform_int_distribution<int> kinds(0, 3);
+        std::bernoulli_distribution failures(0.15);
+        for (int iteration = 0; iteration < 300; ++iteration) {
+            std::vector<int> nestedLog, flatLog;
+            Fun nested = []() { return true; };
+            Fun flat = []() { return true; };
+            Fun snapshot;
+            std::vector<int> snapshotLog;
+            for (int i = 0; i < 25; ++i) {
+                int kind = kinds(g);
+                bool result = !failures(g);
+                nestedPush(nested, [&nestedLog, i, result]() {
+                    nestedLog.push_back(i);
+                    return result;
+                }, kind);
+                flatPush(flat, [&flatLog, i, result]() {
+                    flatLog.push_back(i);
+                    return result;
+                }, kind);
+                if (i == 10) {
+                    // A copy must not be affected by the following operations
+                    snapshot = flat;
+                }
+            }
+            REQUIRE(UndoSequence::size(flat) == 26);
+            bool nestedResult = nested();
+            bool flatResult = flat();
+            REQUIRE(nestedLog == flatLog);
+            REQUIRE(nestedResult == flatResult);
+            flatLog.clear();
+            REQUIRE(UndoSequence::size(snapshot) == 12);
+            snapshot();
+            REQUIRE(std::all_of(flatLog.begin(), flatLog.end(), [](int i) { return i <= 10; }));
+        }
+    }
+
+    SECTION("Memory budget of the undo stack")
+    {
+        std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+        undoStack->setMemoryBudget(0);
+        int state = 0;
+        auto makeCommand = [&state]() {
+            Fun undo = []() { return true; };
+            Fun redo = []() { return true; };
+            for (int j = 0; j < 100; ++j) {
+                Fun operation = [&state]() {
+                    state++;
+                    return true;
+                };
+                Fun reverse = [&state]() {
+                    state--;
+                    return true;
+                };
+                operation();
+                UPDATE_UNDO_REDO_NOLOCK(operation, reverse, undo, redo);
+            }
+            return new FunctionalUndoCommand(undo, redo, QStringLiteral("Step"));
+        };
+        for (int i = 0; i < 20; ++i) {
+            undoStack->push(makeCommand());
+        }
+        REQUIRE(state == 2000);
+        REQUIRE(undoStack->firstAvailableIndex() == 0);
+        qint64 usage = undoStack->memoryUsage();
+        REQUIRE(usage >= 20 * DocUndoStack::commandCost(undoStack->command(0)));
+        // Keep roughly half of the history
+        undoStack->setMemoryBudget(usage / 2);
+        int first = undoStack->firstAvailableIndex();
+        REQUIRE(first > 0);
+        REQUIRE(first < 20);
+        REQUIRE(undoStack->memoryUsage() <= usage / 2);
+        REQUIRE(undoStack->count() == 20);
+        REQUIRE(static_cast<const FunctionalUndoCommand *>(undoStack->command(first - 1))->isReleased());
+        while (undoStack->canUndoCommand()) {
+            undoStack->undo();
+        }
+        REQUIRE(undoStack->index() == first);
+        REQUIRE(state == first * 100);
+        REQUIRE(undoStack->canUndo());
+        // A dropped command does nothing if it is undone anyway, and Qt deletes it
+        undoStack->undo();
+        REQUIRE(undoStack->index() == first - 1);
+        REQUIRE(undoStack->count() == 19);
+        REQUIRE(state == first * 100);
+        REQUIRE_FALSE(undoStack->canUndoCommand());
+        undoStack->setIndex(undoStack->count());
+        REQUIRE(state == 2000);
+        undoStack->clear();
+        REQUIRE(undoStack->firstAvailableIndex() == 0);
+
+        // The commands of a macro are accounted and released with it
+        undoStack->setMemoryBudget(0);
+        undoStack->beginMacro(QStringLiteral("Macro"));
+        for (int i = 0; i < 5; ++i) {
+            undoStack->push(makeCommand());
+        }
+        undoStack->endMacro();
+        undoStack->push(makeCommand());
+        REQUIRE(undoStack->count() == 2);
+        const QUndoCommand *macro = undoStack->command(0);
+        REQUIRE(macro->childCount() == 5);
+        qint64 single = DocUndoStack::commandCost(undoStack->command(1));
+        REQUIRE(DocUndoStack::commandCost(macro) >= 5 * single);
+        undoStack->setMemoryBudget(single);
+        REQUIRE(undoStack->firstAvailableIndex() == 1);
+        for (int i = 0; i < macro->childCount(); ++i) {
+            REQUIRE(static_cast<const FunctionalUndoCommand *>(macro->child(i))->isReleased());
+        }
+        REQUIRE(undoStack->memoryUsage() == single);
+        undoStack->clear();
+    }
+}
+
+/* Run with: runTests "[.benchmark][Undo]" */
+TEST_CASE("Undo sequences benchmark", "[.benchmark][Undo]")
+{
+    const int steps = 10000;
+    for (bool flat : {false, true}) {
+        int state = 0;
+        QElapsedTimer timer;
+        qint64 heapBefore = heapUsage();
+        timer.start();
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        for (int i = 0; i < steps; ++i) {
+            Fun operation = [&state, i]() {
+                CallDepthProbe probe;
+                state += i;
+                return true;
+            };
+            Fun reverse = [&state, i]() {
+                CallDepthProbe probe;
+                state -= i;
+                return true;
+            };
+            if (flat) {
+                flatPush(undo, reverse, 2);
+                flatPush(redo, operation, 3);
+            } else {
+                nestedPush(undo, reverse, 2);
+                nestedPush(redo, operation, 3);
+            }
+        }
+        qint64 buildTime = timer.elapsed();
+        qint64 heldMemory = heapUsage() - heapBefore;
+        s_maxCallDepth = 0;
+        timer.start();
+        REQUIRE(undo());
+        REQUIRE(redo());
+        qint64 runTime = timer.elapsed();
+        std::cout << (flat ? "Flat" : "Nested") << " undo, " << steps << " steps: built in " << buildTime << "ms, executed in " << runTime
+                  << "ms, call depth " << s_maxCallDepth << ", " << heldMemory / 1024 << "kB held";
+        if (flat) {
+            std::cout << " (estimated " << (UndoSequence::memoryCost(undo) + UndoSequence::memoryCost(redo)) / 1024 << "kB)";
+        }
+        std::cout << std::endl;
+    }
+
+    // Undo history of an operation on 10k clips
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+    QString binId = createProducer(profile_model, "red", binModel, 20, false);
+    const int tracks = 10;
+    QVector<int> trackIds;
+    for (int i = 0; i < tracks; ++i) {
+        trackIds << TrackModel::construct(timeline);
+    }
+    for (int i = 0; i < steps; ++i) {
+        int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+        REQUIRE(timeline->requestClipMove(cid, trackIds[i % tracks], (i / tracks) * 20, true, false, false));
+    }
+    QElapsedTimer timer;
+    timer.start();
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    REQUIRE(TimelineFunctions::requestInsertSpace(timeline, QPoint(10, 30), undo, redo, trackIds));
+    qint64 operationTime = timer.elapsed();
+    timer.start();
+    REQUIRE(undo());
+    qint64 undoTime = timer.elapsed();
+    auto *command = new FunctionalUndoCommand(undo, redo, QStringLiteral("Insert space"));
+    qint64 estimated = DocUndoStack::commandCost(command);
+    int operations = UndoSequence::size(undo) + UndoSequence::size(redo);
+    // The command holds the only other copies of the operations, measure what is freed when they are dropped
+    undo = nullptr;
+    redo = nullptr;
+    qint64 heapBefore = heapUsage();
+    command->release();
+    qint64 held = heapBefore - heapUsage();
+    std::cout << "Insert space, " << steps << " clips: " << operationTime << "ms, undo in " << undoTime << "ms, " << operations << " operations, command holds "
+              << held / 1024 << "kB (estimated " << estimated / 1024 << "kB)" << std::endl;
+    delete command;
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Bulk clip insertion", "[ClipModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+    QString binId = createProducer(profile_model, "red", binModel, 20, false);
+    QString binId2 = createProducer(profile_model, "blue", binModel, 30, false);
+    int tid1 = TrackModel::construct(timeline);
+
+    QStringList binIds = {binId, binId2, binId, binId2 + QStringLiteral("/5/14")};
+    QList<int> clipIds;
+    REQUIRE(timeline->requestClipsInsertion(binIds, tid1, 100, clipIds));
+    REQUIRE(clipIds.size() == 4);
+    REQUIRE(timeline->checkConsistency());
+    int position = 100;
+    for (int cid : qAsConst(clipIds)) {
+        REQUIRE(timeline->getClipTrackId(cid) == tid1);
+        REQUIRE(timeline->getClipPosition(cid) == position);
+        position += timeline->getClipPlaytime(cid);
+    }
+    REQUIRE(timeline->getClipPlaytime(clipIds.last()) == 10);
+    REQUIRE(timeline->getClipsCount() == 4);
+
+    // A single undo entry removes all clips
+    undoStack->undo();
+    REQUIRE(timeline->getClipsCount() == 0);
+    REQUIRE(timeline->checkConsistency());
+    undoStack->redo();
+    REQUIRE(timeline->getClipsCount() == 4);
+    REQUIRE(timeline->checkConsistency());
+
+    // Range is occupied, nothing is inserted
+    QList<int> otherIds;
+    REQUIRE_FALSE(timeline->requestClipsInsertion(binIds, tid1, 50, otherIds));
+    REQUIRE(otherIds.isEmpty());
+    REQUIRE(timeline->getClipsCount() == 4);
+
+    // Unknown bin clip, nothing is inserted
+    REQUIRE_FALSE(timeline->requestClipsInsertion({binId, QStringLiteral("9999")}, tid1, 500, otherIds));
+    REQUIRE(timeline->getClipsCount() == 4);
+    REQUIRE(timeline->checkConsistency());
+
+    // Audio/video clips also need space on the mirror track
+    QString binIdAV = createProducerWithSound(profile_model, binModel, 20);
+    int tidAudio = TrackModel::construct(timeline, -1, -1, QString(), true);
+    int tidVideo = TrackModel::construct(timeline);
+    REQUIRE(timeline->getMirrorTrackId(tidVideo) == tidAudio);
+    QMap<int, QString> audioInfo;
+    audioInfo.insert(1, QStringLiteral("stream1"));
+    timeline->m_binAudioTargets = audioInfo;
+    int audioClip = ClipModel::construct(timeline, binIdAV, -1, PlaylistState::AudioOnly);
+    REQUIRE(timeline->requestClipMove(audioClip, tidAudio, 230));
+    REQUIRE(timeline->getClipsCount() == 5);
+    REQUIRE_FALSE(timeline->requestClipsInsertion({binId, binIdAV}, tidVideo, 200, otherIds));
+    REQUIRE(otherIds.isEmpty());
+    REQUIRE(timeline->getClipsCount() == 5);
+    REQUIRE(timeline->checkConsistency());
+    REQUIRE(timeline->requestClipsInsertion({binId, binIdAV}, tidVideo, 300, otherIds));
+    REQUIRE(otherIds.size() == 2);
+    REQUIRE(timeline->getClipsCount() == 8);
+    REQUIRE(timeline->getTrackClipsCount(tidAudio) == 2);
+    REQUIRE(timeline->checkConsistency());
+    // The audio/video clip is grouped with its audio part
+    REQUIRE(timeline->m_groups->getDirectChildren(timeline->m_groups->getRootId(otherIds.last())).size() == 2);
+    REQUIRE(timeline->m_groups->getType(timeline->m_groups->getRootId(otherIds.last())) == GroupType::AVSplit);
+    REQUIRE_FALSE(timeline->m_groups->isInGroup(otherIds.first()));
+    undoStack->undo();
+    REQUIRE(timeline->getClipsCount() == 5);
+    REQUIRE(timeline->getTrackClipsCount(tidAudio) == 1);
+    REQUIRE(timeline->checkConsistency());
+    undoStack->redo();
+    REQUIRE(timeline->getClipsCount() == 8);
+    REQUIRE(timeline->m_groups->isInGroup(otherIds.last()));
+    REQUIRE(timeline->checkConsistency());
+
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+/* Run with: runTests "[.benchmark][ClipModel]" */
+TEST_CASE("Bulk clip insertion benchmark", "[.benchmark][ClipModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    QStringList binIds;
+    for (int i = 0; i < 1000; ++i) {
+        binIds << createProducer(profile_model, "red", binModel, 20 + i % 10, false);
+    }
+    QElapsedTimer timer;
+    // Reference: insert the clips one by one, as the timeline drop did before
+    qint64 singleTime;
+    {
+        std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+        int tid1 = TrackModel::construct(timeline);
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        int position = 0;
+        timer.start();
+        for (const QString &binId : qAsConst(binIds)) {
+            int cid = -1;
+            REQUIRE(timeline->requestClipInsertion(binId, tid1, position, cid, true, true, false, undo, redo));
+            position += timeline->getClipPlaytime(cid);
+        }
+        pCore->pushUndo(undo, redo, QStringLiteral("Insert Clips"));
+        singleTime = timer.elapsed();
+        REQUIRE(timeline->getClipsCount() == 1000);
+        undoStack->clear();
+    }
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+    int tid1 = TrackModel::construct(timeline);
+    QList<int> clipIds;
+    timer.start();
+    REQUIRE(TimelineFunctions::requestMultipleClipsInsertion(timeline, binIds, tid1, 0, clipIds, true, true));
+    qint64 insertTime = timer.elapsed();
+    timer.start();
+    undoStack->undo();
+    qint64 undoTime = timer.elapsed();
+    timer.start();
+    undoStack->redo();
+    std::cout << "Inserting " << binIds.size() << " clips: " << insertTime << "ms (one by one: " << singleTime << "ms), undo " << undoTime << "ms, redo "
+              << timer.elapsed() << "ms" << std::endl;
+    REQUIRE(timeline->getClipsCount() == 1000);
+    REQUIRE(timeline->checkConsistency());
+    // The bulk insertion must stay well under a second for 1000 clips, and not be slower than the clip by clip path
+    CHECK(insertTime < 1000);
+    CHECK(insertTime <= singleTime);
+    undoStack->clear();
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Range hash", "[TimelineModel]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+    QString binId = createProducer(profile_model, "red", binModel, 20, false);
+    QString binId2 = createProducer(profile_model, "blue", binModel, 20, false);
+    int tid1 = TrackModel::construct(timeline);
+    int tid2 = TrackModel::construct(timeline);
+
+    int cid1 = -1;
+    int cid2 = -1;
+    REQUIRE(timeline->requestClipInsertion(binId, tid1, 10, cid1));
+    REQUIRE(timeline->requestClipInsertion(binId, tid1, 110, cid2));
+    QByteArray reference = timeline->getRangeHash(0, 25);
+    QByteArray empty = timeline->getRangeHash(50, 75);
+
+    // The same content at another position gives the same hash
+    REQUIRE(timeline->getRangeHash(100, 125) == reference);
+    REQUIRE(empty != reference);
+    REQUIRE(timeline->getRangeHash(25, 50) == empty);
+
+    SECTION("Moves and undo")
+    {
+        REQUIRE(timeline->requestClipMove(cid2, tid1, 112));
+        REQUIRE(timeline->getRangeHash(100, 125) != reference);
+        REQUIRE(timeline->getRangeHash(102, 127) == reference);
+        undoStack->undo();
+        REQUIRE(timeline->getRangeHash(100, 125) == reference);
+    }
+
+    SECTION("Clip changes")
+    {
+        REQUIRE(timeline->requestItemResize(cid2, 15, true) == 15);
+        REQUIRE(timeline->getRangeHash(100, 125) != reference);
+        undoStack->undo();
+        REQUIRE(timeline->getRangeHash(100, 125) == reference);
+
+        // Same position and length but another source
+        int cid3 = -1;
+        REQUIRE(timeline->requestItemDeletion(cid2));
+        REQUIRE(timeline->requestClipInsertion(binId2, tid1, 110, cid3));
+        REQUIRE(timeline->getRangeHash(100, 125) != reference);
+    }
+
+    SECTION("Other tracks")
+    {
+        int cid3 = -1;
+        REQUIRE(timeline->requestClipInsertion(binId2, tid2, 115, cid3));
+        REQUIRE(timeline->getRangeHash(100, 125) != reference);
+        REQUIRE(timeline->getRangeHash(0, 25) == reference);
+        timeline->getTrackById(tid1)->setProperty(QStringLiteral("hide"), QStringLiteral("3"));
+        REQUIRE(timeline->getRangeHash(0, 25) != reference);
+    }
+
+    SECTION("Timeline hash computed once")
+    {
+        bool keyframed = true;
+        QByteArray timelineHash = timeline->getTimelineHash(keyframed);
+        REQUIRE_FALSE(keyframed);
+        REQUIRE(timeline->getRangeHash(0, 25, timelineHash, keyframed) == reference);
+        REQUIRE(timeline->getRangeHash(100, 125, timelineHash, keyframed) == reference);
+        // With keyframed master or track effects, the same content at another position is another range
+        REQUIRE(timeline->getRangeHash(100, 125, timelineHash, true) != timeline->getRangeHash(0, 25, timelineHash, true));
+        // Track changes are part of the timeline hash
+        timeline->getTrackById(tid2)->setProperty(QStringLiteral("hide"), QStringLiteral("3"));
+        bool unused;
+        REQUIRE(timeline->getTimelineHash(unused) != timelineHash);
+    }
+
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+/* Run with: runTests "[.benchmark][Notifications]" */
+TEST_CASE("Trimming and groups notifications benchmark", "[.benchmark][Notifications]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    QString binId = createProducer(profile_model, "red", binModel, 20, false);
+    const int tracks = 10;
+    const int count = 1000;
+    for (const QString &scenario : {QStringLiteral("Trimming"), QStringLiteral("Groups")}) {
+        for (bool batched : {false, true}) {
+            std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+            QVector<int> trackIds;
+            for (int i = 0; i < tracks; ++i) {
+                trackIds << TrackModel::construct(timeline);
+            }
+            std::vector<int> clips;
+            for (int i = 0; i < count; ++i) {
+                int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+                REQUIRE(timeline->requestClipMove(cid, trackIds[i % tracks], (i / tracks) * 30, true, false, false));
+                clips.push_back(cid);
+            }
+            int emitted = 0;
+            QObject::connect(timeline.get(), &QAbstractItemModel::dataChanged, [&emitted]() { emitted++; });
+            QElapsedTimer timer;
+            timer.start();
+            {
+                std::unique_ptr<TimelineModel::NotificationsBatch> batch;
+                if (batched) {
+                    batch.reset(new TimelineModel::NotificationsBatch(timeline.get()));
+                }
+                if (scenario == QLatin1String("Trimming")) {
+                    // Same operations as the trimming tests: cut each clip, then trim both sides of the first part
+                    for (int cid : clips) {
+                        REQUIRE(TimelineFunctions::requestClipCut(timeline, cid, timeline->getClipPosition(cid) + 10));
+                        REQUIRE(timeline->requestItemResize(cid, 7, true) == 7);
+                        REQUIRE(timeline->requestItemResize(cid, 5, false) == 5);
+                    }
+                } else {
+                    // Same operations as the groups tests: group each column of clips, move the groups and ungroup them
+                    std::vector<int> groups;
+                    for (size_t i = 0; i < clips.size(); i += tracks) {
+                        std::unordered_set<int> ids(clips.begin() + int(i), clips.begin() + int(i) + tracks);
+                        groups.push_back(timeline->requestClipsGroup(ids));
+                        REQUIRE(groups.back() > 0);
+                    }
+                    for (size_t i = groups.size(); i-- > 0;) {
+                        REQUIRE(timeline->requestGroupMove(clips[i * tracks], groups[i], 0, 5));
+                    }
+                    for (size_t i = 0; i < clips.size(); i += tracks) {
+                        REQUIRE(timeline->requestClipsUngroup({clips[i]}));
+                    }
+                }
+            }
+            std::cout << (batched ? "Batched " : "Unbatched ") << scenario.toStdString() << ", " << count << " clips: " << emitted << " dataChanged signals in "
+                      << timer.elapsed() << "ms" << std::endl;
+        }
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
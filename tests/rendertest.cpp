@@ -0,0 +1,54 @@
+#include "test_utils.hpp"
+
+#include "dialogs/renderwidget.h"
+
+TEST_CASE("Segment boundaries", "[Render]")
+{
+    const int fps = 25;
+
+    SECTION("Even split")
+    {
+        REQUIRE(RenderWidget::segmentBoundaries(0, 999, 4, 0, {}, fps) == QList<int>({250, 500, 750}));
+        // Positions are relative to the zone start
+        REQUIRE(RenderWidget::segmentBoundaries(100, 1099, 4, 0, {}, fps) == QList<int>({350, 600, 850}));
+        // Split positions that are not a whole frame are rounded down
+        REQUIRE(RenderWidget::segmentBoundaries(0, 1000, 3, 0, {}, fps) == QList<int>({333, 667}));
+    }
+
+    SECTION("Rounding to the keyframe interval")
+    {
+        // 250 / 12 = 20.8, 500 / 12 = 41.7 and 750 / 12 = 62.5 are rounded to the nearest keyframe
+        REQUIRE(RenderWidget::segmentBoundaries(0, 999, 4, 12, {}, fps) == QList<int>({252, 504, 756}));
+        REQUIRE(RenderWidget::segmentBoundaries(100, 1099, 4, 12, {}, fps) == QList<int>({352, 604, 856}));
+        // A keyframe interval of 1 does not move the boundaries
+        REQUIRE(RenderWidget::segmentBoundaries(0, 999, 4, 1, {}, fps) == QList<int>({250, 500, 750}));
+    }
+
+    SECTION("Guides")
+    {
+        // A guide close to the ideal position is preferred, even if not on a keyframe
+        REQUIRE(RenderWidget::segmentBoundaries(0, 999, 4, 12, {240, 900}, fps) == QList<int>({240, 504, 756}));
+        // The closest guide wins
+        REQUIRE(RenderWidget::segmentBoundaries(0, 999, 2, 0, {450, 520, 560}, fps) == QList<int>({520}));
+        // Guides too far from the ideal position are ignored
+        REQUIRE(RenderWidget::segmentBoundaries(0, 999, 2, 0, {100, 900}, fps) == QList<int>({500}));
+    }
+
+    SECTION("Zero length")
+    {
+        REQUIRE(RenderWidget::segmentBoundaries(50, 49, 4, 12, {}, fps).isEmpty());
+        REQUIRE(RenderWidget::segmentBoundaries(50, 10, 4, 12, {}, fps).isEmpty());
+        // Without frame rate, there is no minimum segment length
+        REQUIRE(RenderWidget::segmentBoundaries(0, 999, 4, 12, {}, 0).size() == 3);
+    }
+
+    SECTION("Single segment")
+    {
+        REQUIRE(RenderWidget::segmentBoundaries(0, 999, 1, 0, {}, fps).isEmpty());
+        REQUIRE(RenderWidget::segmentBoundaries(0, 999, 0, 0, {}, fps).isEmpty());
+        // Segments would last less than 10 seconds
+        REQUIRE(RenderWidget::segmentBoundaries(0, 300, 4, 0, {}, fps).isEmpty());
+        // The number of segments is reduced to keep them longer than 10 seconds
+        REQUIRE(RenderWidget::segmentBoundaries(0, 599, 8, 0, {}, fps) == QList<int>({300}));
+    }
+}
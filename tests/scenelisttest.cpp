@@ -0,0 +1,184 @@
+#include "catch.hpp"
+#include "doc/scenelistwriter.h"
+
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <iostream>
+#include <sys/resource.h>
+
+/* Reference implementation: the DOM based save path used before SceneListWriter */
+QByteArray domSceneList(const QString &scene)
+{
+    QDomDocument sceneList;
+    sceneList.setContent(scene, true);
+    QDomElement mlt = sceneList.firstChildElement(QStringLiteral("mlt"));
+    if (mlt.isNull() || !mlt.hasChildNodes() || mlt.elementsByTagName(QStringLiteral("track")).isEmpty()) {
+        return QByteArray();
+    }
+    QDomNodeList tractors = mlt.elementsByTagName(QStringLiteral("tractor"));
+    for (int i = 0; i < tractors.count(); ++i) {
+        if (tractors.at(i).toElement().hasAttribute(QStringLiteral("global_feed"))) {
+            // Only the tractor's own property, not the ones of its filters
+            for (QDomElement prop = tractors.at(i).firstChildElement(QStringLiteral("property")); !prop.isNull();
+                 prop = prop.nextSiblingElement(QStringLiteral("property"))) {
+                if (prop.attribute(QStringLiteral("name")) == QLatin1String("meta.volume")) {
+                    prop.firstChild().setNodeValue(QStringLiteral("1"));
+                    break;
+                }
+            }
+            break;
+        }
+    }
+    return sceneList.toString().toUtf8();
+}
+
+/* Serialize data again with QDom, so that documents only differing by their attribute order compare equal */
+QString canonical(const QByteArray &data)
+{
+    QDomDocument doc;
+    doc.setContent(data, true);
+    return doc.toString();
+}
+
+/* Build a scene list similar to what the MLT xml consumer produces for a project with clipCount clips */
+QString generateScene(int clipCount)
+{
+    QString scene;
+    QTextStream out(&scene);
+    out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+    out << "<mlt LC_NUMERIC=\"C\" version=\"7.0.0\" title=\"Anonymous Submission\" root=\"/tmp/project\" producer=\"main_bin\">\n";
+    out << "  <profile description=\"HD 1080p 25 fps\" width=\"1920\" height=\"1080\" progressive=\"1\" sample_aspect_num=\"1\" sample_aspect_den=\"1\" "
+           "display_aspect_num=\"16\" display_aspect_den=\"9\" frame_rate_num=\"25\" frame_rate_den=\"1\" colorspace=\"709\"/>\n";
+    for (int i = 0; i < clipCount; ++i) {
+        out << "  <producer id=\"producer" << i << "\" in=\"00:00:00.000\" out=\"00:00:09.960\">\n";
+        out << "    <property name=\"length\">250</property>\n";
+        out << "    <property name=\"resource\">clip &amp; &lt;" << i << "&gt; \"quoted\".mp4</property>\n";
+        out << "    <property name=\"mlt_service\">avformat-novalidate</property>\n";
+        out << "    <property name=\"kdenlive:id\">" << i + 2 << "</property>\n";
+        out << "    <property name=\"kdenlive:clipname\"/>\n";
+        out << "    <filter id=\"filter" << i << "\">\n";
+        out << "      <property name=\"mlt_service\">volume</property>\n";
+        out << "      <property name=\"kdenlive:collapsed\">0</property>\n";
+        out << "      <property name=\"kdenlive:keyframes\">0=1;\n100=0.5</property>\n";
+        out << "    </filter>\n";
+        out << "  </producer>\n";
+    }
+    out << "  <playlist id=\"main_bin\">\n";
+    out << "    <property name=\"kdenlive:docproperties.guides\">[{\"comment\": \"a &amp; b\", \"pos\": 12, \"type\": 0}]</property>\n";
+    for (int i = 0; i < clipCount; ++i) {
+        out << "    <entry producer=\"producer" << i << "\" in=\"00:00:00.000\" out=\"00:00:09.960\"/>\n";
+    }
+    out << "  </playlist>\n";
+    out << "  <playlist id=\"playlist0\">\n";
+    for (int i = 0; i < clipCount; ++i) {
+        out << "    <entry producer=\"producer" << i << "\" in=\"00:00:00.000\" out=\"00:00:04.960\">\n";
+        out << "      <property name=\"kdenlive:id\">" << i + 2 << "</property>\n";
+        out << "    </entry>\n";
+    }
+    out << "  </playlist>\n";
+    out << "  <tractor id=\"tractor0\" in=\"00:00:00.000\">\n";
+    out << "    <property name=\"kdenlive:trackheight\">67</property>\n";
+    out << "    <track producer=\"playlist0\"/>\n";
+    out << "  </tractor>\n";
+    out << "  <tractor id=\"tractor1\" title=\"Anonymous Submission\" global_feed=\"1\" in=\"00:00:00.000\">\n";
+    out << "    <property name=\"meta.volume\">0.5</property>\n";
+    out << "    <track producer=\"tractor0\"/>\n";
+    out << "    <transition id=\"transition0\">\n";
+    out << "      <property name=\"a_track\">0</property>\n";
+    out << "      <property name=\"geometry\">0=0 0 1920 1080 1;\t50=10 10 1920 1080 0.5</property>\n";
+    out << "    </transition>\n";
+    out << "  </tractor>\n";
+    out << "</mlt>\n";
+    out.flush();
+    return scene;
+}
+
+TEST_CASE("Streaming scene list writer", "[SceneListWriter]")
+{
+    SECTION("Output matches the DOM serialization")
+    {
+        for (int count : {0, 1, 17}) {
+            const QString scene = generateScene(count);
+            QByteArray streamed;
+            REQUIRE(SceneListWriter::write(scene, streamed));
+            REQUIRE(canonical(streamed) == canonical(domSceneList(scene)));
+        }
+    }
+
+    SECTION("Attributes keep the order of the scene")
+    {
+        QByteArray streamed;
+        REQUIRE(SceneListWriter::write(generateScene(1), streamed));
+        REQUIRE(streamed.contains("<mlt LC_NUMERIC=\"C\" version=\"7.0.0\" title=\"Anonymous Submission\" root=\"/tmp/project\" producer=\"main_bin\">"));
+        REQUIRE(streamed.contains("<tractor id=\"tractor1\" title=\"Anonymous Submission\" global_feed=\"1\" in=\"00:00:00.000\">"));
+    }
+
+    SECTION("Main tractor volume is reset")
+    {
+        QByteArray streamed;
+        REQUIRE(SceneListWriter::write(generateScene(2), streamed));
+        REQUIRE(streamed.contains("<property name=\"meta.volume\">1</property>"));
+
+        // A filter of the main tractor keeps its own meta.volume
+        const QString scene = QStringLiteral("<mlt><producer id=\"p\"/><tractor global_feed=\"1\"><track producer=\"p\"/><filter id=\"f\">"
+                                             "<property name=\"meta.volume\">0.3</property></filter><property name=\"meta.volume\">0.5</property>"
+                                             "</tractor></mlt>");
+        REQUIRE(SceneListWriter::write(scene, streamed));
+        REQUIRE(streamed.contains("<property name=\"meta.volume\">0.3</property>"));
+        REQUIRE(streamed.contains("<property name=\"meta.volume\">1</property>"));
+        REQUIRE(canonical(streamed) == canonical(domSceneList(scene)));
+    }
+
+    SECTION("Special characters and mixed layouts")
+    {
+        const QString scene = QStringLiteral("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<mlt a=\"x&quot;&#10;y\" b=\"]]&gt;\"><!-- comment -->"
+                                             "<producer id=\"p\"><property name=\"t\">a ]]&gt; b &lt; \"c\"</property><property name=\"empty\">  </property>"
+                                             "</producer><tractor global_feed=\"1\"><track producer=\"p\"/><property name=\"meta.volume\"/>"
+                                             "</tractor></mlt>");
+        QByteArray streamed;
+        REQUIRE(SceneListWriter::write(scene, streamed));
+        REQUIRE(canonical(streamed) == canonical(domSceneList(scene)));
+        REQUIRE(streamed.contains("<mlt a=\"x&quot;&#xa;y\" b=\"]]&gt;\">"));
+    }
+
+    SECTION("Corrupted scene lists are rejected")
+    {
+        QByteArray streamed;
+        REQUIRE_FALSE(SceneListWriter::write(QString(), streamed));
+        REQUIRE_FALSE(SceneListWriter::write(QStringLiteral("<mlt></mlt>"), streamed));
+        REQUIRE_FALSE(SceneListWriter::write(QStringLiteral("<mlt><producer id=\"p\"/></mlt>"), streamed));
+        REQUIRE_FALSE(SceneListWriter::write(QStringLiteral("<mlt><tractor><track producer=\"p\"/></tractor>"), streamed));
+        REQUIRE(streamed.isEmpty());
+    }
+}
+
+/* Run with: runTests "[.benchmark][SceneListWriter]" -c "<section>"
+   Peak memory is process wide, so run each section in its own process for meaningful RSS values.
+*/
+TEST_CASE("Scene list save benchmark", "[.benchmark][SceneListWriter]")
+{
+    auto peakRss = []() {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    };
+    for (int count : {1000, 10000, 50000}) {
+        const QString scene = generateScene(count);
+        const long baseRss = peakRss();
+        QElapsedTimer timer;
+        SECTION(QStringLiteral("Streaming %1 clips").arg(count).toStdString())
+        {
+            timer.start();
+            QByteArray streamed;
+            REQUIRE(SceneListWriter::write(scene, streamed));
+            std::cout << "Streaming save, " << count << " clips: " << timer.elapsed() << "ms, peak RSS +" << (peakRss() - baseRss) << "kB" << std::endl;
+        }
+        SECTION(QStringLiteral("DOM %1 clips").arg(count).toStdString())
+        {
+            timer.start();
+            const QByteArray data = domSceneList(scene);
+            REQUIRE_FALSE(data.isEmpty());
+            std::cout << "DOM save, " << count << " clips: " << timer.elapsed() << "ms, peak RSS +" << (peakRss() - baseRss) << "kB" << std::endl;
+        }
+    }
+}
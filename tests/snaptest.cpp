@@ -1,5 +1,6 @@
 #include "catch.hpp"
 #include "timeline2/model/snapmodel.hpp"
+#include <QElapsedTimer>
 #include <iostream>
 #include <unordered_set>
 
@@ -123,4 +124,90 @@ TEST_CASE("Snap points model test", "[SnapModel]")
         REQUIRE(snap.getClosestPoint(9) == 15);
         REQUIRE(snap.getClosestPoint(999) == 15);
     }
+
+    SECTION("Ignored points overlay")
+    {
+        snap.addPoint(10);
+        snap.addPoint(20);
+        snap.addPoint(30);
+        snap.ignore({20});
+        // The snap points are kept, only hidden
+        REQUIRE(snap._snaps().size() == 3);
+        REQUIRE(snap.getClosestPoint(19) == 10);
+        REQUIRE(snap.getClosestPoint(21) == 30);
+        REQUIRE(snap.getNextPoint(10) == 30);
+        REQUIRE(snap.getPreviousPoint(30) == 10);
+
+        // Ignored points can be removed
+        snap.removePoint(20);
+        REQUIRE(snap.getClosestPoint(21) == 30);
+        snap.addPoint(20);
+        snap.unIgnore();
+        REQUIRE(snap.getClosestPoint(19) == 20);
+        REQUIRE(snap.getNextPoint(10) == 20);
+        REQUIRE(snap.getPreviousPoint(30) == 20);
+        REQUIRE(snap._snaps().size() == 3);
+        // The item's own boundaries are ignored while resizing
+        REQUIRE(snap.proposeSize(10, 30, 12, true, 5) == 10);
+        REQUIRE(snap.proposeSize(10, 30, 12, true, 0) == -1);
+    }
+
+    SECTION("Batched closest point")
+    {
+        REQUIRE(snap.getClosestPoint(std::vector<int>{0, 10}, 5) == std::make_pair(-1, -1));
+        snap.addPoint(10);
+        snap.addPoint(50);
+        snap.addPoint(100);
+        // Out of snap distance
+        REQUIRE(snap.getClosestPoint(std::vector<int>{20, 70}, 5) == std::make_pair(-1, -1));
+        REQUIRE(snap.getClosestPoint(std::vector<int>{20, 70}, 10) == std::make_pair(20, 10));
+        // The closest match wins, whatever its position in the list
+        REQUIRE(snap.getClosestPoint(std::vector<int>{14, 52, 97}, 10) == std::make_pair(52, 50));
+        // On equal distance, the first position of the list wins
+        REQUIRE(snap.getClosestPoint(std::vector<int>{103, 47}, 10) == std::make_pair(103, 100));
+        REQUIRE(snap.getClosestPoint(std::vector<int>{47, 103}, 10) == std::make_pair(47, 50));
+        REQUIRE(snap.getClosestPoint(std::vector<int>{}, 10) == std::make_pair(-1, -1));
+        REQUIRE(snap.getClosestPoint(std::vector<int>{10}, -1) == std::make_pair(-1, -1));
+
+        snap.ignore({50});
+        REQUIRE(snap.getClosestPoint(std::vector<int>{14, 52, 97}, 10) == std::make_pair(97, 100));
+        snap.unIgnore();
+        REQUIRE(snap.getClosestPoint(std::vector<int>{14, 52, 97}, 10) == std::make_pair(52, 50));
+    }
+}
+
+/* Run with: runTests "[.benchmark][SnapModel]" */
+TEST_CASE("Group drag snapping benchmark", "[.benchmark][SnapModel]")
+{
+    SnapModel snap;
+    // A group of 500 items, in the middle of 5000 other items
+    const int groupSize = 500;
+    std::vector<int> groupPoints;
+    for (int i = 0; i < 5000; ++i) {
+        snap.addPoint(i * 100);
+        snap.addPoint(i * 100 + 80);
+        if (i >= 2000 && i < 2000 + groupSize) {
+            groupPoints.push_back(i * 100);
+            groupPoints.push_back(i * 100 + 80);
+        }
+    }
+    const int moves = 1000;
+    const int snapDistance = 10;
+    QElapsedTimer timer;
+    timer.start();
+    int snapped = 0;
+    std::vector<int> moved(groupPoints.size());
+    for (int diff = 0; diff < moves; ++diff) {
+        snap.ignore(groupPoints);
+        for (size_t i = 0; i < groupPoints.size(); ++i) {
+            moved[i] = groupPoints[i] + diff;
+        }
+        if (snap.getClosestPoint(moved, snapDistance).second != -1) {
+            snapped++;
+        }
+        snap.unIgnore();
+    }
+    REQUIRE(snapped > 0);
+    REQUIRE(snap._snaps().size() == 10000);
+    std::cout << "Dragging a group of " << groupSize << " items over " << moves << " positions: " << timer.elapsed() << "ms" << std::endl;
 }
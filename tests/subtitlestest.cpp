@@ -0,0 +1,186 @@
+#include "test_utils.hpp"
+
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+static QString srtTime(int millisecs)
+{
+    return QStringLiteral("%1:%2:%3,%4")
+        .arg(millisecs / 3600000, 2, 10, QLatin1Char('0'))
+        .arg((millisecs / 60000) % 60, 2, 10, QLatin1Char('0'))
+        .arg((millisecs / 1000) % 60, 2, 10, QLatin1Char('0'))
+        .arg(millisecs % 1000, 3, 10, QLatin1Char('0'));
+}
+
+/* Write a srt file where entry i is displayed between entries[i].first and entries[i].second (in ms) */
+static void writeSrt(QTemporaryFile &file, const std::vector<std::pair<int, int>> &entries, bool finalBlankLine = true)
+{
+    REQUIRE(file.open());
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    for (size_t i = 0; i < entries.size(); ++i) {
+        out << i + 1 << "\n" << srtTime(entries[i].first) << " --> " << srtTime(entries[i].second) << "\n" << "Line " << i + 1 << "\n";
+        if (finalBlankLine || i + 1 < entries.size()) {
+            out << "\n";
+        }
+    }
+    out.flush();
+    file.close();
+}
+
+static std::shared_ptr<SubtitleModel> createSubtitleModel(const std::shared_ptr<TimelineItemModel> &timeline)
+{
+    std::shared_ptr<SubtitleModel> subtitleModel = std::make_shared<SubtitleModel>(nullptr, timeline);
+    // There is no document to write the subtitle file to
+    QObject::disconnect(subtitleModel.get(), &SubtitleModel::modelChanged, nullptr, nullptr);
+    timeline->setSubModel(subtitleModel);
+    return subtitleModel;
+}
+
+TEST_CASE("Subtitle import and lookups", "[SubtitleModel]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+    std::shared_ptr<SubtitleModel> subtitleModel = createSubtitleModel(timeline);
+    double fps = pCore->getCurrentFps();
+
+    // The third entry overlaps the second one, the fourth uses an already used start and the last one has no trailing blank line
+    QTemporaryFile srtFile(QDir::temp().absoluteFilePath(QStringLiteral("XXXXXX.srt")));
+    writeSrt(srtFile, {{1000, 2000}, {3000, 8000}, {4000, 5000}, {3000, 3500}, {10000, 11000}}, false);
+    subtitleModel->importSubtitle(srtFile.fileName(), 0, true);
+
+    REQUIRE(subtitleModel->rowCount() == 4);
+    REQUIRE(timeline->m_allSubtitles.size() == 4);
+    REQUIRE(timeline->m_subtitlesByStart.size() == 4);
+    REQUIRE(subtitleModel->m_durations.size() == 4);
+    REQUIRE(timeline->checkConsistency());
+
+    SECTION("Id and start lookups")
+    {
+        for (const auto &sub : timeline->m_allSubtitles) {
+            REQUIRE(subtitleModel->getIdForStartPos(sub.second) == sub.first);
+            REQUIRE(subtitleModel->getStartPosForId(sub.first) == sub.second);
+            REQUIRE(timeline->getSubtitleByStartPosition(sub.second.frames(fps)) == sub.first);
+        }
+        REQUIRE(subtitleModel->getIdForStartPos(GenTime(6.)) == -1);
+        REQUIRE(subtitleModel->getText(subtitleModel->getIdForStartPos(GenTime(10.))) == QStringLiteral("Line 5"));
+    }
+
+    SECTION("Range queries")
+    {
+        int first = subtitleModel->getIdForStartPos(GenTime(1.));
+        int second = subtitleModel->getIdForStartPos(GenTime(3.));
+        int third = subtitleModel->getIdForStartPos(GenTime(4.));
+        int last = subtitleModel->getIdForStartPos(GenTime(10.));
+        REQUIRE(subtitleModel->getItemsInRange(GenTime(1.5).frames(fps), GenTime(1.6).frames(fps)) == std::unordered_set<int>({first}));
+        // The long second subtitle overlaps this range although it starts before it
+        REQUIRE(subtitleModel->getItemsInRange(GenTime(6.).frames(fps), GenTime(7.).frames(fps)) == std::unordered_set<int>({second}));
+        REQUIRE(subtitleModel->getItemsInRange(GenTime(4.5).frames(fps), GenTime(4.5).frames(fps)) == std::unordered_set<int>({second, third}));
+        REQUIRE(subtitleModel->getItemsInRange(GenTime(8.5).frames(fps), GenTime(9.).frames(fps)).empty());
+        REQUIRE(subtitleModel->getItemsInRange(GenTime(5.5).frames(fps), -1) == std::unordered_set<int>({second, last}));
+        REQUIRE(timeline->getSubtitleByPosition(GenTime(10.5).frames(fps)) == last);
+    }
+
+    SECTION("Edits keep the indexes in sync")
+    {
+        int second = subtitleModel->getIdForStartPos(GenTime(3.));
+        // Shrinking the longest subtitle reduces the range query window
+        REQUIRE(subtitleModel->requestResize(second, GenTime(1.).frames(fps), true));
+        REQUIRE(*subtitleModel->m_durations.rbegin() == GenTime(1.));
+        REQUIRE(subtitleModel->getItemsInRange(GenTime(6.).frames(fps), GenTime(7.).frames(fps)).empty());
+        undoStack->undo();
+        REQUIRE(*subtitleModel->m_durations.rbegin() == GenTime(5.));
+
+        subtitleModel->requestSubtitleMove(second, GenTime(20.));
+        REQUIRE(subtitleModel->getIdForStartPos(GenTime(3.)) == -1);
+        REQUIRE(subtitleModel->getIdForStartPos(GenTime(20.)) == second);
+        REQUIRE(subtitleModel->getItemsInRange(GenTime(24.).frames(fps), GenTime(24.).frames(fps)) == std::unordered_set<int>({second}));
+        undoStack->undo();
+        REQUIRE(subtitleModel->getIdForStartPos(GenTime(3.)) == second);
+        REQUIRE(subtitleModel->getIdForStartPos(GenTime(20.)) == -1);
+
+        REQUIRE(subtitleModel->removeSubtitle(second));
+        REQUIRE(subtitleModel->getIdForStartPos(GenTime(3.)) == -1);
+        REQUIRE(timeline->m_subtitlesByStart.size() == 3);
+        REQUIRE(*subtitleModel->m_durations.rbegin() == GenTime(1.));
+    }
+
+    SECTION("Import is undone in one step")
+    {
+        undoStack->undo();
+        REQUIRE(subtitleModel->rowCount() == 0);
+        REQUIRE(timeline->m_allSubtitles.empty());
+        REQUIRE(timeline->m_subtitlesByStart.empty());
+        REQUIRE(subtitleModel->m_durations.empty());
+        REQUIRE(subtitleModel->getItemsInRange(0, -1).empty());
+        undoStack->redo();
+        REQUIRE(subtitleModel->rowCount() == 4);
+        REQUIRE(timeline->m_subtitlesByStart.size() == 4);
+        REQUIRE(timeline->checkConsistency());
+    }
+    subtitleModel->unsetModel();
+    pCore->m_projectManager = nullptr;
+}
+
+/* Run with: runTests "[.benchmark][SubtitleModel]" */
+TEST_CASE("Subtitle import benchmark", "[.benchmark][SubtitleModel]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    When(Method(pmMock, cacheDir)).AlwaysReturn(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+    std::shared_ptr<SubtitleModel> subtitleModel = createSubtitleModel(timeline);
+    double fps = pCore->getCurrentFps();
+
+    const int count = 10000;
+    std::vector<std::pair<int, int>> entries;
+    entries.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        entries.emplace_back(i * 3000, i * 3000 + 2500);
+    }
+    QTemporaryFile srtFile(QDir::temp().absoluteFilePath(QStringLiteral("XXXXXX.srt")));
+    writeSrt(srtFile, entries);
+
+    QElapsedTimer timer;
+    timer.start();
+    subtitleModel->importSubtitle(srtFile.fileName(), 0, true);
+    qint64 importTime = timer.elapsed();
+    REQUIRE(subtitleModel->rowCount() == count);
+
+    const int queries = 10000;
+    int lastFrame = GenTime(count * 3.).frames(fps);
+    size_t found = 0;
+    timer.start();
+    for (int i = 0; i < queries; ++i) {
+        int frame = int(qint64(i) * lastFrame / queries);
+        found += subtitleModel->getItemsInRange(frame, frame + 10).size();
+        found += timeline->getSubtitleByStartPosition(frame) > -1 ? 1 : 0;
+    }
+    qint64 queryTime = timer.elapsed();
+    REQUIRE(found > 0);
+    timer.start();
+    undoStack->undo();
+    qint64 undoTime = timer.elapsed();
+    REQUIRE(subtitleModel->rowCount() == 0);
+    std::cout << "Importing " << count << " subtitles: " << importTime << "ms, " << queries << " range and start lookups: " << queryTime << "ms, undo: " << undoTime
+              << "ms" << std::endl;
+    subtitleModel->unsetModel();
+    pCore->m_projectManager = nullptr;
+}